@@ -305,6 +305,365 @@ const Haptics = {
   warning: () => navigator.vibrate?.([30, 30, 30]),
 };
 
+// ============================================
+// Frame Wire Protocol
+// Mirrors pc_app_cpp/include/network/frame_protocol.hpp
+// ============================================
+const FRAME_HEADER_SIZE = 16;
+const TILE_RECT_SIZE = 8;
+const VIEW_INFO_SIZE = 4;
+const FRAME_FLAG_KEYFRAME = 1 << 0;
+
+const FrameType = Object.freeze({
+  JPEG: 0, // Plain JPEG message (unframed)
+  DUAL_JPEG: 1, // Left and right eye JPEGs
+  TILES: 2, // Changed tiles, composited onto a persistent canvas
+  RAW: 3, // Lossless frame, decoded by RawDecoder
+  H264: 4, // H.264 access unit (Annex-B), decoded by H264Decoder
+  SINGLE_VIEW: 5, // One JPEG view, both eyes cut from it with an offset
+});
+
+const FrameCodec = {
+  /**
+   * Split a binary message into its image parts.
+   * Plain JPEG messages (FF D8 ...) are returned as a single part.
+   * RAW and H264 parts stay as byte views for their decoders, everything
+   * else is a JPEG Blob.
+   */
+  parse(buffer) {
+    const bytes = new Uint8Array(buffer);
+
+    if (
+      bytes.length < FRAME_HEADER_SIZE ||
+      bytes[0] !== 0x56 || // 'V'
+      bytes[1] !== 0x52 // 'R'
+    ) {
+      return {
+        type: FrameType.JPEG,
+        width: 0,
+        height: 0,
+        size: bytes.length,
+        parts: [new Blob([bytes], { type: "image/jpeg" })],
+      };
+    }
+
+    const view = new DataView(buffer);
+    const type = bytes[3];
+    const partCount = view.getUint16(12, true);
+    const parts = [];
+    const rects = [];
+    let viewInfo = null;
+    let offset = FRAME_HEADER_SIZE + partCount * 4;
+
+    if (type === FrameType.TILES) {
+      for (let i = 0; i < partCount; i++) {
+        rects.push({
+          x: view.getUint16(offset, true),
+          y: view.getUint16(offset + 2, true),
+          w: view.getUint16(offset + 4, true),
+          h: view.getUint16(offset + 6, true),
+        });
+        offset += TILE_RECT_SIZE;
+      }
+    } else if (type === FrameType.SINGLE_VIEW) {
+      viewInfo = {
+        disparity: view.getUint16(offset, true),
+        eyeWidth: view.getUint16(offset + 2, true),
+      };
+      offset += VIEW_INFO_SIZE;
+    }
+
+    for (let i = 0; i < partCount; i++) {
+      const length = view.getUint32(FRAME_HEADER_SIZE + i * 4, true);
+      const payload = bytes.subarray(offset, offset + length);
+      parts.push(
+        type === FrameType.RAW || type === FrameType.H264
+          ? payload
+          : new Blob([payload], { type: "image/jpeg" })
+      );
+      offset += length;
+    }
+
+    return {
+      type,
+      width: view.getUint16(4, true),
+      height: view.getUint16(6, true),
+      frameId: view.getUint32(8, true),
+      keyframe: (view.getUint16(14, true) & FRAME_FLAG_KEYFRAME) !== 0,
+      size: bytes.length,
+      parts,
+      rects,
+      viewInfo,
+    };
+  },
+};
+
+// ============================================
+// Lossless RAW Decoder
+// Mirrors pc_app_cpp/include/encoder/raw_encoder.hpp
+// ============================================
+
+/**
+ * Decode a RAW payload (per-row prediction + QOI-style ops) into RGBA.
+ * Runs inside the decoder worker; kept standalone so it can be serialised.
+ */
+function decodeRaw(bytes, width, height) {
+  const rgba = new Uint8ClampedArray(width * height * 4);
+  const index = new Uint32Array(64); // Packed 0xRRGGBB
+  const rowBytes = width * 4;
+  let r = 0;
+  let g = 0;
+  let b = 0;
+  let run = 0;
+  let pos = 0;
+
+  for (let y = 0; y < height; y++) {
+    const up = bytes[pos++] === 1; // Predictor: values are deltas from the row above
+    const end = (y + 1) * rowBytes;
+
+    for (let o = y * rowBytes; o < end; o += 4) {
+      if (run > 0) {
+        run--;
+      } else {
+        const op = bytes[pos++];
+        if (op === 0xfe) {
+          r = bytes[pos];
+          g = bytes[pos + 1];
+          b = bytes[pos + 2];
+          pos += 3;
+        } else if (op < 0x40) {
+          const v = index[op];
+          r = v >>> 16;
+          g = (v >>> 8) & 0xff;
+          b = v & 0xff;
+        } else if (op < 0x80) {
+          r = (r + ((op >> 4) & 3) - 2) & 0xff;
+          g = (g + ((op >> 2) & 3) - 2) & 0xff;
+          b = (b + (op & 3) - 2) & 0xff;
+        } else if (op < 0xc0) {
+          const next = bytes[pos++];
+          const dg = (op & 0x3f) - 32;
+          r = (r + dg + (next >> 4) - 8) & 0xff;
+          g = (g + dg) & 0xff;
+          b = (b + dg + (next & 0x0f) - 8) & 0xff;
+        } else {
+          run = op & 0x3f; // This value plus `run` more repeats
+        }
+        index[(r * 3 + g * 5 + b * 7) & 63] = (r << 16) | (g << 8) | b;
+      }
+
+      if (up) {
+        rgba[o] = (r + rgba[o - rowBytes]) & 0xff;
+        rgba[o + 1] = (g + rgba[o - rowBytes + 1]) & 0xff;
+        rgba[o + 2] = (b + rgba[o - rowBytes + 2]) & 0xff;
+      } else {
+        rgba[o] = r;
+        rgba[o + 1] = g;
+        rgba[o + 2] = b;
+      }
+      rgba[o + 3] = 255;
+    }
+  }
+
+  return rgba;
+}
+
+/**
+ * Worker entry point: decode, then hand back an ImageBitmap (or raw RGBA).
+ */
+function rawDecoderWorker() {
+  self.onmessage = async (event) => {
+    const { id, buffer, width, height } = event.data;
+    try {
+      const rgba = decodeRaw(new Uint8Array(buffer), width, height);
+      if (typeof createImageBitmap === "function") {
+        const bitmap = await createImageBitmap(new ImageData(rgba, width, height));
+        self.postMessage({ id, bitmap }, [bitmap]);
+      } else {
+        self.postMessage({ id, rgba }, [rgba.buffer]);
+      }
+    } catch (e) {
+      self.postMessage({ id, error: String(e) });
+    }
+  };
+}
+
+/**
+ * Decodes RAW parts off the main thread.
+ * Falls back to decoding inline when workers are unavailable.
+ */
+class RawDecoder {
+  constructor() {
+    this.nextId = 0;
+    this.pending = new Map(); // id -> { resolve, reject, width, height }
+    this.worker = null;
+
+    if (typeof Worker === "function") {
+      try {
+        const source = `${decodeRaw.toString()}\n(${rawDecoderWorker.toString()})();`;
+        const url = URL.createObjectURL(
+          new Blob([source], { type: "text/javascript" })
+        );
+        this.worker = new Worker(url);
+        URL.revokeObjectURL(url);
+        this.worker.onmessage = (event) => this.onResult(event.data);
+      } catch (e) {
+        console.warn("RAW decoder worker unavailable, decoding inline:", e);
+        this.worker = null;
+      }
+    }
+  }
+
+  /**
+   * Decode one RAW part.
+   * @returns {Promise<ImageBitmap|HTMLCanvasElement>}
+   */
+  decode(bytes, width, height) {
+    if (!this.worker) {
+      return Promise.resolve(
+        RawDecoder.toImage(decodeRaw(bytes, width, height), width, height)
+      );
+    }
+
+    return new Promise((resolve, reject) => {
+      const id = this.nextId++;
+      this.pending.set(id, { resolve, reject, width, height });
+      // The part is a view into the message; copy it so the copy can be transferred
+      const buffer = bytes.slice().buffer;
+      this.worker.postMessage({ id, buffer, width, height }, [buffer]);
+    });
+  }
+
+  onResult({ id, bitmap, rgba, error }) {
+    const request = this.pending.get(id);
+    if (!request) return;
+    this.pending.delete(id);
+
+    if (error) {
+      request.reject(new Error(error));
+    } else if (bitmap) {
+      request.resolve(bitmap);
+    } else {
+      request.resolve(RawDecoder.toImage(rgba, request.width, request.height));
+    }
+  }
+
+  static toImage(rgba, width, height) {
+    if (typeof createImageBitmap === "function") {
+      return createImageBitmap(new ImageData(rgba, width, height));
+    }
+    const canvas = document.createElement("canvas");
+    canvas.width = width;
+    canvas.height = height;
+    canvas.getContext("2d").putImageData(new ImageData(rgba, width, height), 0, 0);
+    return canvas;
+  }
+}
+
+// ============================================
+// H.264 Decoder (WebCodecs)
+// Mirrors pc_app_cpp/include/encoder/h264_encoder.hpp
+// ============================================
+
+/**
+ * Read "avc1.PPCCLL" (profile, constraints, level) from the SPS of an
+ * Annex-B access unit, or null if it carries none.
+ */
+function avcCodecString(bytes) {
+  const hex = (b) => b.toString(16).padStart(2, "0");
+  for (let i = 0; i + 6 < bytes.length; i++) {
+    if (
+      bytes[i] === 0 &&
+      bytes[i + 1] === 0 &&
+      bytes[i + 2] === 1 &&
+      (bytes[i + 3] & 0x1f) === 7 // SPS
+    ) {
+      return `avc1.${hex(bytes[i + 4])}${hex(bytes[i + 5])}${hex(bytes[i + 6])}`;
+    }
+  }
+  return null;
+}
+
+/**
+ * Feeds H264 access units to a WebCodecs VideoDecoder.
+ * Decoding starts (and restarts after an error) on an IDR, since every
+ * other frame depends on the ones before it.
+ */
+class H264Decoder {
+  static isSupported() {
+    return (
+      typeof VideoDecoder === "function" &&
+      typeof EncodedVideoChunk === "function"
+    );
+  }
+
+  /**
+   * @param {function(VideoFrame)} onFrame Receives each decoded frame (owns it)
+   * @param {function()} onKeyframeNeeded Called when decoding has to restart
+   */
+  constructor(onFrame, onKeyframeNeeded) {
+    this.onFrame = onFrame;
+    this.onKeyframeNeeded = onKeyframeNeeded;
+    this.decoder = null;
+    this.codec = null;
+    this.maxQueue = 4; // Past this we are behind; restart at the next IDR
+  }
+
+  decode(frame) {
+    const data = frame.parts[0];
+
+    if (frame.keyframe) {
+      const codec = avcCodecString(data);
+      if (codec && codec !== this.codec) {
+        this.configure(codec);
+      }
+    }
+
+    // Deltas before the first IDR have no references
+    if (!this.decoder) return;
+
+    if (this.decoder.decodeQueueSize > this.maxQueue) {
+      console.warn("H.264 decoder fell behind, waiting for a keyframe");
+      this.reset();
+      this.onKeyframeNeeded();
+      return;
+    }
+
+    this.decoder.decode(
+      new EncodedVideoChunk({
+        type: frame.keyframe ? "key" : "delta",
+        timestamp: frame.frameId,
+        data,
+      })
+    );
+  }
+
+  configure(codec) {
+    if (!this.decoder) {
+      this.decoder = new VideoDecoder({
+        output: (videoFrame) => this.onFrame(videoFrame),
+        error: (e) => {
+          console.warn("H.264 decode failed:", e);
+          this.reset();
+          this.onKeyframeNeeded();
+        },
+      });
+    }
+
+    // No description: chunks are Annex-B with in-band SPS/PPS
+    this.decoder.configure({ codec, optimizeForLatency: true });
+    this.codec = codec;
+  }
+
+  reset() {
+    if (this.decoder && this.decoder.state !== "closed") {
+      this.decoder.close();
+    }
+    this.decoder = null;
+    this.codec = null;
+  }
+}
+
 // ============================================
 // Main VR Stream Viewer Class
 // ============================================
@@ -372,6 +731,19 @@ class VRStreamViewer {
       willReadFrequently: false,
     });
 
+    // Persistent canvas that tile patches are composited onto
+    this.tileCanvas = document.createElement("canvas");
+    this.tileCtx = this.tileCanvas.getContext("2d", { alpha: false });
+    this.tileCanvasReady = false; // Set by the first keyframe
+    this.tileQueue = Promise.resolve(); // Applies patches in arrival order
+
+    // Lossless frames, created on the first RAW message
+    this.rawDecoder = null;
+
+    // Video frames, created on the first H264 message
+    this.h264Decoder = null;
+    this.h264Unsupported = false;
+
     // WebSocket
     this.ws = null;
     this.reconnectAttempts = 0;
@@ -408,13 +780,6 @@ class VRStreamViewer {
     this.frameReady = false;
     this.renderScheduled = false;
 
-    // Reusable Image for decoding (legacy fallback)
-    this.frameImage = new Image();
-    this.frameImage.onload = () => this.onFrameImageLoaded();
-
-    // Track current blob URL for cleanup
-    this.currentFrameUrl = null;
-
     // Initialize
     this.init();
   }
@@ -634,7 +999,9 @@ class VRStreamViewer {
 
     try {
       this.ws = new WebSocket(url);
-      this.ws.binaryType = "blob"; // Receive as blob for faster handling
+      this.ws.binaryType = "arraybuffer"; // Framed messages are parsed in place
+      this.tileCanvasReady = false; // Server sends a keyframe to every new client
+      this.h264Decoder?.reset();
 
       this.ws.onopen = () => {
         console.log("WebSocket connected");
@@ -734,7 +1101,7 @@ class VRStreamViewer {
     }
 
     // Binary frame data
-    this.processFrame(event.data, receiveTime);
+    this.processFrame(FrameCodec.parse(event.data), receiveTime);
   }
 
   handleControlMessage(msg) {
@@ -757,11 +1124,11 @@ class VRStreamViewer {
     }
   }
 
-  processFrame(blob, receiveTime) {
+  processFrame(frame, receiveTime) {
     // Update stats
     this.stats.frameCount++;
     this.stats.totalFrames++;
-    this.stats.lastSize = blob.size;
+    this.stats.lastSize = frame.size;
 
     // Calculate latency (rough estimate based on frame timing)
     const now = performance.now();
@@ -778,13 +1145,25 @@ class VRStreamViewer {
       this.updateStatsDisplay();
     }
 
+    // Patches must all be applied in order, so they bypass the frame buffer
+    if (frame.type === FrameType.TILES) {
+      this.applyTiles(frame);
+      return;
+    }
+
+    // Video frames reference earlier ones, so they go straight to the decoder too
+    if (frame.type === FrameType.H264) {
+      this.applyVideo(frame);
+      return;
+    }
+
     // Buffer management
     if (this.settings.bufferFrames === 0) {
       // No buffering - display immediately
-      this.displayFrame(blob);
+      this.displayFrame(frame);
     } else {
       // Add to buffer
-      this.frameBuffer.push(blob);
+      this.frameBuffer.push(frame);
 
       // Trim buffer if too large
       while (this.frameBuffer.length > this.settings.bufferFrames) {
@@ -805,61 +1184,160 @@ class VRStreamViewer {
     }
 
     this.isProcessingFrame = true;
-    const blob = this.frameBuffer.shift();
-    this.displayFrame(blob);
+    const frame = this.frameBuffer.shift();
+    this.displayFrame(frame);
   }
 
-  displayFrame(blob) {
-    // Use createImageBitmap for GPU-accelerated decoding (prevents jitter)
-    // This decodes the JPEG using hardware acceleration where available
-    if (typeof createImageBitmap === "function") {
-      createImageBitmap(blob, {
-        premultiplyAlpha: "none",
-        colorSpaceConversion: "none", // Skip color conversion for speed
+  displayFrame(frame) {
+    // Decode every part in parallel (both eyes in dual-eye mode)
+    Promise.all(frame.parts.map((part) => this.decodeFramePart(frame, part)))
+      .then((images) => {
+        // Store the decoded images for synchronized rendering
+        this.releaseFrame(this.pendingFrame);
+        this.pendingFrame = { ...frame, images };
+        this.frameReady = true;
+
+        // Schedule render on next animation frame for smooth timing
+        if (!this.renderScheduled) {
+          this.renderScheduled = true;
+          requestAnimationFrame(() => this.renderFrame());
+        }
       })
-        .then((bitmap) => {
-          // Store the decoded bitmap for synchronized rendering
-          if (this.pendingFrame && this.pendingFrame.close) {
-            this.pendingFrame.close(); // Release previous bitmap
-          }
-          this.pendingFrame = bitmap;
-          this.frameReady = true;
+      .catch((e) => {
+        console.warn("Frame decode failed:", e);
+        this.isProcessingFrame = false;
+      });
+  }
+
+  applyTiles(frame) {
+    // Decode as soon as the message arrives, composite strictly in order
+    const decoded = Promise.all(frame.parts.map((part) => this.decodePart(part)));
 
-          // Schedule render on next animation frame for smooth timing
-          if (!this.renderScheduled) {
-            this.renderScheduled = true;
-            requestAnimationFrame(() => this.renderFrame());
+    this.tileQueue = this.tileQueue
+      .then(() => decoded)
+      .then((images) => {
+        const canvas = this.tileCanvas;
+
+        if (frame.keyframe) {
+          if (canvas.width !== frame.width || canvas.height !== frame.height) {
+            canvas.width = frame.width;
+            canvas.height = frame.height;
           }
-        })
-        .catch((e) => {
-          // Fallback to Image element if createImageBitmap fails
-          console.warn("ImageBitmap failed, using fallback:", e);
-          this.displayFrameFallback(blob);
-        });
-    } else {
-      // Fallback for older browsers without createImageBitmap
-      this.displayFrameFallback(blob);
+          this.tileCanvasReady = true;
+        }
+
+        // Patches before the first keyframe have nothing to land on
+        if (this.tileCanvasReady) {
+          frame.rects.forEach((rect, i) => {
+            this.tileCtx.drawImage(images[i], rect.x, rect.y, rect.w, rect.h);
+          });
+        }
+        this.releaseFrame({ images });
+
+        if (!this.tileCanvasReady) return;
+
+        this.releaseFrame(this.pendingFrame);
+        this.pendingFrame = {
+          type: FrameType.TILES,
+          width: canvas.width,
+          height: canvas.height,
+          images: [canvas],
+        };
+        this.frameReady = true;
+
+        if (!this.renderScheduled) {
+          this.renderScheduled = true;
+          requestAnimationFrame(() => this.renderFrame());
+        }
+      })
+      .catch((e) => {
+        console.warn("Tile decode failed:", e);
+      });
+  }
+
+  applyVideo(frame) {
+    if (!this.h264Decoder) {
+      if (!H264Decoder.isSupported()) {
+        if (!this.h264Unsupported) {
+          this.h264Unsupported = true;
+          Toast.error("This browser cannot decode H.264 - pick a JPEG encoder on the PC", 6000);
+        }
+        return;
+      }
+      this.h264Decoder = new H264Decoder(
+        (videoFrame) => this.presentVideoFrame(videoFrame),
+        () => this.requestKeyframe()
+      );
     }
+
+    this.h264Decoder.decode(frame);
   }
 
-  displayFrameFallback(blob) {
-    // Legacy fallback using Image element
-    const url = URL.createObjectURL(blob);
+  presentVideoFrame(videoFrame) {
+    // VideoFrames hold decoder memory: releaseFrame() closes the one replaced
+    this.releaseFrame(this.pendingFrame);
+    this.pendingFrame = {
+      type: FrameType.H264,
+      width: videoFrame.displayWidth,
+      height: videoFrame.displayHeight,
+      images: [videoFrame],
+    };
+    this.frameReady = true;
+
+    if (!this.renderScheduled) {
+      this.renderScheduled = true;
+      requestAnimationFrame(() => this.renderFrame());
+    }
+  }
+
+  decodeFramePart(frame, part) {
+    if (frame.type === FrameType.RAW) {
+      this.rawDecoder ??= new RawDecoder();
+      return this.rawDecoder.decode(part, frame.width, frame.height);
+    }
+    return this.decodePart(part);
+  }
 
-    // Clean up previous URL
-    if (this.currentFrameUrl) {
-      URL.revokeObjectURL(this.currentFrameUrl);
+  decodePart(blob) {
+    // Use createImageBitmap for GPU-accelerated decoding (prevents jitter)
+    // This decodes the JPEG using hardware acceleration where available
+    if (typeof createImageBitmap === "function") {
+      return createImageBitmap(blob, {
+        premultiplyAlpha: "none",
+        colorSpaceConversion: "none", // Skip color conversion for speed
+      }).catch((e) => {
+        // Fallback to Image element if createImageBitmap fails
+        console.warn("ImageBitmap failed, using fallback:", e);
+        return this.decodePartFallback(blob);
+      });
     }
-    this.currentFrameUrl = url;
 
-    // Load and display
-    this.frameImage.src = url;
+    // Fallback for older browsers without createImageBitmap
+    return this.decodePartFallback(blob);
+  }
+
+  decodePartFallback(blob) {
+    // Legacy fallback using Image element
+    return new Promise((resolve, reject) => {
+      const url = URL.createObjectURL(blob);
+      const img = new Image();
+      img.onload = () => {
+        URL.revokeObjectURL(url);
+        resolve(img);
+      };
+      img.onerror = (e) => {
+        URL.revokeObjectURL(url);
+        reject(e);
+      };
+      img.src = url;
+    });
   }
 
-  onFrameImageLoaded() {
-    // Called when legacy Image element has loaded
-    // Draw directly without double-buffering for fallback
-    this.drawFrameLegacy();
+  releaseFrame(frame) {
+    if (!frame) return;
+    for (const image of frame.images) {
+      if (image.close) image.close(); // Release ImageBitmap/VideoFrame memory
+    }
   }
 
   renderFrame() {
@@ -874,9 +1352,9 @@ class VRStreamViewer {
     }
 
     this.frameReady = false;
-    const bitmap = this.pendingFrame;
+    const frame = this.pendingFrame;
+    const images = frame.images;
 
-    const canvas = this.elements.canvas;
     const offCanvas = this.offscreenCanvas;
     const offCtx = this.offscreenCtx;
 
@@ -884,19 +1362,57 @@ class VRStreamViewer {
     offCtx.fillStyle = "#000";
     offCtx.fillRect(0, 0, offCanvas.width, offCanvas.height);
 
+    // Full frame size (framed messages carry it, plain JPEGs are one image)
+    const frameWidth = frame.width || images[0].width;
+    const frameHeight = frame.height || images[0].height;
+
     // Calculate scaling to fit canvas while maintaining aspect ratio
     const scale = Math.min(
-      offCanvas.width / bitmap.width,
-      offCanvas.height / bitmap.height
+      offCanvas.width / frameWidth,
+      offCanvas.height / frameHeight
     );
 
-    const drawWidth = bitmap.width * scale;
-    const drawHeight = bitmap.height * scale;
+    const drawWidth = frameWidth * scale;
+    const drawHeight = frameHeight * scale;
     const drawX = (offCanvas.width - drawWidth) / 2;
     const drawY = (offCanvas.height - drawHeight) / 2;
 
     // Draw to offscreen canvas
-    offCtx.drawImage(bitmap, drawX, drawY, drawWidth, drawHeight);
+    if (frame.type === FrameType.DUAL_JPEG && images.length === 2) {
+      // Each eye fills its half of the side-by-side layout
+      const eyeWidth = drawWidth / 2;
+      offCtx.drawImage(images[0], drawX, drawY, eyeWidth, drawHeight);
+      offCtx.drawImage(images[1], drawX + eyeWidth, drawY, eyeWidth, drawHeight);
+    } else if (frame.type === FrameType.SINGLE_VIEW && frame.viewInfo) {
+      // Both eyes are windows into one view, the right one starts disparity columns in
+      const eyeWidth = drawWidth / 2;
+      const { disparity, eyeWidth: sourceWidth } = frame.viewInfo;
+      const image = images[0];
+      offCtx.drawImage(
+        image,
+        0,
+        0,
+        sourceWidth,
+        image.height,
+        drawX,
+        drawY,
+        eyeWidth,
+        drawHeight
+      );
+      offCtx.drawImage(
+        image,
+        disparity,
+        0,
+        sourceWidth,
+        image.height,
+        drawX + eyeWidth,
+        drawY,
+        eyeWidth,
+        drawHeight
+      );
+    } else {
+      offCtx.drawImage(images[0], drawX, drawY, drawWidth, drawHeight);
+    }
 
     // Atomic copy to visible canvas (prevents tearing/jitter)
     this.ctx.drawImage(offCanvas, 0, 0);
@@ -909,36 +1425,6 @@ class VRStreamViewer {
     }
   }
 
-  drawFrameLegacy() {
-    // Legacy draw method for browsers without createImageBitmap
-    const canvas = this.elements.canvas;
-    const ctx = this.ctx;
-    const img = this.frameImage;
-
-    // Clear canvas
-    ctx.fillStyle = "#000";
-    ctx.fillRect(0, 0, canvas.width, canvas.height);
-
-    // Calculate scaling to fit canvas while maintaining aspect ratio
-    const scale = Math.min(
-      canvas.width / img.width,
-      canvas.height / img.height
-    );
-
-    const drawWidth = img.width * scale;
-    const drawHeight = img.height * scale;
-    const drawX = (canvas.width - drawWidth) / 2;
-    const drawY = (canvas.height - drawHeight) / 2;
-
-    // Draw the frame
-    ctx.drawImage(img, drawX, drawY, drawWidth, drawHeight);
-
-    // Continue processing buffer
-    if (this.settings.bufferFrames > 0) {
-      requestAnimationFrame(() => this.processNextFrame());
-    }
-  }
-
   updateStatsDisplay() {
     if (!this.settings.showStats) return;
 
@@ -959,6 +1445,12 @@ class VRStreamViewer {
     status.className = "status " + type;
   }
 
+  requestKeyframe() {
+    if (this.ws && this.ws.readyState === WebSocket.OPEN) {
+      this.ws.send(JSON.stringify({ type: "keyframe_request" }));
+    }
+  }
+
   sendQualityRequest() {
     if (this.ws && this.ws.readyState === WebSocket.OPEN) {
       this.ws.send(
@@ -0,0 +1,74 @@
+#pragma once
+/**
+ * VR Streamer - Benchmarks
+ * Synthetic frames shared by the benchmark areas, and the areas themselves.
+ */
+
+#include "core/common.hpp"
+#include "core/config.hpp"
+#include "core/memory_pool.hpp"
+
+namespace vrs::bench
+{
+
+    // ============================================================================
+    // Synthetic frames
+    // ============================================================================
+
+    /**
+     * Gradient plus hard edges, so the entropy coder has realistic work.
+     * @param channels 3 (BGR) or 4 (BGRA, opaque)
+     */
+    [[nodiscard]] std::vector<u8> gradient_frame(u32 width, u32 height, u32 channels);
+
+    /**
+     * Pseudo-random bytes, for passes that only move or resample memory.
+     */
+    [[nodiscard]] std::vector<u8> noise_frame(size_t bytes);
+
+    /**
+     * Desktop text: dark glyph runs on a light background (BGR of one pixel).
+     */
+    void text_pixel(u8 *p, u32 x, u32 y);
+
+    /**
+     * Copy source into a capture buffer as capture_loop does.
+     * @return nullptr if every buffer is still with the encoders (drop the frame)
+     */
+    [[nodiscard]] FrameBufferPool::BufferPtr capture(FrameBufferPool &frames, const std::vector<u8> &source,
+                                                     u32 width, u32 height, u32 frame_id);
+
+    /**
+     * CPU time used by the calling thread so far.
+     */
+    [[nodiscard]] f64 thread_cpu_ms();
+
+    // ============================================================================
+    // Areas
+    // ============================================================================
+
+    /**
+     * JPEG encoders and strip threads, tile patches, lossless RAW,
+     * centre-weighted quantisation and fused stereo + encode.
+     */
+    void run_encode_benchmarks(const EncoderConfig &config);
+
+    /**
+     * Encode worker pool: throughput and latency per worker count, and
+     * settings switches while streaming.
+     */
+    void run_pipeline_benchmarks(const EncoderConfig &config);
+
+    /**
+     * Frame arena against heap buffers, and the compressed frame pool
+     * against the mutex pool it replaced.
+     */
+    void run_memory_benchmarks(const EncoderConfig &config);
+
+    /**
+     * Frame handoff, pipeline statistics and row-loop dispatch, each
+     * against the design it replaced.
+     */
+    void run_thread_benchmarks();
+
+} // namespace vrs::bench
@@ -0,0 +1,462 @@
+/**
+ * VR Streamer - Encode Benchmarks
+ * JPEG encoders, tile patches, lossless RAW, centre-weighted quantisation
+ * and fused stereo + encode on synthetic frames.
+ */
+
+#include "bench.hpp"
+#include "encoder/parallel_jpeg_encoder.hpp"
+#include "encoder/raw_encoder.hpp"
+#include "encoder/stereo_processor.hpp"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <turbojpeg.h>
+
+namespace vrs::bench
+{
+
+    namespace
+    {
+        /**
+         * Encode synthetic SBS frames with TurboJPEG, the built-in encoder and the
+         * parallel strip encoder at increasing thread counts and print the per-frame time.
+         */
+        void run_jpeg_benchmark(u32 quality)
+        {
+            struct Case
+            {
+                const char *label;
+                u32 width;
+                u32 height;
+            };
+            const Case cases[] = {{"1080p SBS", 3840, 1080}, {"4K SBS", 7680, 2160}};
+            constexpr int ITERATIONS = 30;
+
+            std::vector<u32> thread_counts;
+            for (u32 t = 1; t <= std::max(1u, std::thread::hardware_concurrency()); t *= 2)
+            {
+                thread_counts.push_back(t);
+            }
+
+            for (const auto &c : cases)
+            {
+                const u32 pitch = c.width * 3;
+                const std::vector<u8> frame = gradient_frame(c.width, c.height, 3);
+
+                auto time_encoder = [&](IJPEGEncoder &encoder, CompressedFrame &out)
+                {
+                    encoder.encode(frame.data(), c.width, c.height, pitch, 3, quality, out); // Warm-up
+                    Timer timer;
+                    for (int i = 0; i < ITERATIONS; ++i)
+                    {
+                        encoder.encode(frame.data(), c.width, c.height, pitch, 3, quality, out);
+                    }
+                    return timer.elapsed_ms() / ITERATIONS;
+                };
+
+                CompressedFrame out;
+                TurboJPEGEncoder turbo;
+                const f64 baseline_ms = time_encoder(turbo, out);
+
+                std::cout << c.label << " (" << c.width << "x" << c.height << ", q" << quality << ")\n"
+                          << std::fixed << std::setprecision(2)
+                          << "  TurboJPEG         : " << baseline_ms << " ms  " << out.size() / 1024 << " KB\n";
+
+                SimdJPEGEncoder builtin;
+                const f64 builtin_ms = time_encoder(builtin, out);
+                std::cout << "  Built-in " << std::left << std::setw(9) << SimdJPEGEncoder::simd_path() << std::right
+                          << ": " << builtin_ms << " ms  " << out.size() / 1024 << " KB  (" << baseline_ms / builtin_ms << "x)\n";
+
+                size_t annex_k_size = 0;
+                for (u32 threads : thread_counts)
+                {
+                    ParallelJPEGEncoder parallel(threads);
+                    const f64 ms = time_encoder(parallel, out);
+                    std::cout << "  Parallel x" << std::setw(2) << threads << "     : " << ms << " ms  "
+                              << out.size() / 1024 << " KB  (" << baseline_ms / ms << "x)\n";
+                    if (threads == 1)
+                        annex_k_size = out.size();
+                }
+
+                // Single-threaded libjpeg path once the background learner has published tables
+                // (the first frame is sampled immediately, the next one only after the interval)
+                ParallelJPEGEncoder learned(1);
+                learned.set_adaptive_huffman(60000);
+                learned.encode(frame.data(), c.width, c.height, pitch, 3, quality, out);
+                for (int i = 0; i < 500 && learned.huffman_stats().tables_built == 0; ++i)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                std::cout << "  Learned Huffman x1: ";
+                if (learned.huffman_stats().tables_built == 0)
+                {
+                    std::cout << "no tables\n";
+                }
+                else
+                {
+                    const f64 ms = time_encoder(learned, out);
+                    std::cout << ms << " ms  " << out.size() / 1024 << " KB  ("
+                              << 100.0 * (1.0 - static_cast<f64>(out.size()) / annex_k_size) << "% smaller)\n";
+                }
+                std::cout << std::endl;
+            }
+        }
+
+        void run_tile_benchmark(u32 quality)
+        {
+            // Desktop-like BGRA capture: flat background with text-sized detail
+            constexpr u32 WIDTH = 1920;
+            constexpr u32 HEIGHT = 1080;
+            constexpr u32 PITCH = WIDTH * 4;
+            constexpr int FRAMES = 240;
+            constexpr f64 FPS = 60.0;
+
+            auto fill_row = [](u8 *row, u32 y)
+            {
+                for (u32 x = 0; x < WIDTH; ++x)
+                {
+                    text_pixel(row + x * 4, x, y);
+                    row[x * 4 + 3] = 255;
+                }
+            };
+
+            auto typing = [](std::vector<u8> &frame, int i)
+            {
+                // One glyph per frame along a text line
+                const u32 gx = 200 + static_cast<u32>(i % 150) * 10;
+                const u32 gy = 400 + static_cast<u32>(i / 150) * 20;
+                for (u32 y = gy; y < gy + 14; ++y)
+                {
+                    for (u32 x = gx; x < gx + 8; ++x)
+                    {
+                        u8 *p = frame.data() + static_cast<size_t>(y) * PITCH + x * 4;
+                        p[0] = p[1] = p[2] = static_cast<u8>(((x + y + i) & 3) ? 20 : 245);
+                    }
+                }
+            };
+
+            auto scrolling = [&](std::vector<u8> &frame, int i)
+            {
+                // 8 rows per frame
+                constexpr u32 STEP = 8;
+                std::memmove(frame.data(), frame.data() + STEP * PITCH, (HEIGHT - STEP) * PITCH);
+                for (u32 y = HEIGHT - STEP; y < HEIGHT; ++y)
+                {
+                    fill_row(frame.data() + static_cast<size_t>(y) * PITCH, y + static_cast<u32>(i) * STEP);
+                }
+            };
+
+            std::cout << "Tile patches (" << WIDTH << "x" << HEIGHT << " desktop -> SBS, q" << quality
+                      << ", " << FRAMES << " frames @ " << FPS << " fps)\n";
+
+            for (const char *workload : {"typing", "scrolling"})
+            {
+                const bool scroll = (std::string_view(workload) == "scrolling");
+
+                for (auto mode : {EncoderConfig::OutputMode::SBS, EncoderConfig::OutputMode::TILES})
+                {
+                    std::vector<u8> frame(static_cast<size_t>(PITCH) * HEIGHT);
+                    for (u32 y = 0; y < HEIGHT; ++y)
+                    {
+                        fill_row(frame.data() + static_cast<size_t>(y) * PITCH, y);
+                    }
+
+                    EncoderConfig config;
+                    config.jpeg_quality = quality;
+                    config.output_mode = mode;
+                    VRFrameEncoder encoder(config);
+                    CompressedFrame out;
+
+                    encoder.encode(frame.data(), WIDTH, HEIGHT, PITCH, 4, out); // Warm-up and first keyframe
+
+                    u64 bytes = 0;
+                    f64 encode_ms = 0;
+                    u64 tiles = 0;
+                    for (int i = 0; i < FRAMES; ++i)
+                    {
+                        if (scroll)
+                            scrolling(frame, i);
+                        else
+                            typing(frame, i);
+                        bytes += encoder.encode(frame.data(), WIDTH, HEIGHT, PITCH, 4, out);
+                        encode_ms += encoder.stats().encode_time_ms;
+                        tiles += encoder.stats().tiles_changed;
+                    }
+
+                    const bool tiled = (mode == EncoderConfig::OutputMode::TILES);
+                    std::cout << std::fixed << std::setprecision(2)
+                              << "  " << std::setw(9) << workload << (tiled ? " tiles" : " sbs  ")
+                              << " : " << encode_ms / FRAMES << " ms  "
+                              << bytes * FPS / FRAMES / (1024.0 * 1024.0) << " MB/s";
+                    if (tiled)
+                    {
+                        std::cout << "  " << static_cast<f64>(tiles) / FRAMES << "/" << encoder.stats().tiles_total
+                                  << " tiles  " << encoder.stats().keyframes << " keyframes";
+                    }
+                    std::cout << "\n";
+                }
+            }
+            std::cout << std::endl;
+        }
+
+        /**
+         * Lossless RAW encoding of desktop-like BGRA frames: ratio and throughput.
+         */
+        void run_raw_benchmark()
+        {
+            constexpr u32 WIDTH = 1920;
+            constexpr u32 HEIGHT = 1080;
+            constexpr u32 PITCH = WIDTH * 4;
+            constexpr int ITERATIONS = 30;
+
+            auto ui = [](u8 *p, u32 x, u32 y)
+            {
+                // Gradient title bars, flat panels and a noisy thumbnail grid
+                if (y % 270 < 32)
+                {
+                    p[0] = static_cast<u8>(120 + y % 270 * 3);
+                    p[1] = static_cast<u8>(80 + y % 270 * 2);
+                    p[2] = 40;
+                }
+                else if (x > 1400 && (x / 96 + y / 96) % 2)
+                {
+                    p[0] = static_cast<u8>((x * 7 + y * 13) ^ (x * y));
+                    p[1] = static_cast<u8>(p[0] + x);
+                    p[2] = static_cast<u8>(p[0] + y);
+                }
+                else
+                {
+                    p[0] = p[1] = p[2] = (x < 300) ? 45 : 250;
+                }
+            };
+
+            auto photo = [](u8 *p, u32 x, u32 y)
+            {
+                // Smooth shading with sensor-like noise: close to the worst case
+                const u32 noise = (x * 2654435761u ^ y * 40503u) >> 29;
+                p[0] = static_cast<u8>((x + y) / 12 + noise);
+                p[1] = static_cast<u8>(x / 8 + noise);
+                p[2] = static_cast<u8>(y / 5 + noise);
+            };
+
+            std::cout << "Lossless RAW (" << WIDTH << "x" << HEIGHT << " BGRA)\n";
+
+            auto run = [&](const char *label, auto &&pixel)
+            {
+                std::vector<u8> frame(static_cast<size_t>(PITCH) * HEIGHT, 255);
+                for (u32 y = 0; y < HEIGHT; ++y)
+                {
+                    for (u32 x = 0; x < WIDTH; ++x)
+                    {
+                        pixel(frame.data() + static_cast<size_t>(y) * PITCH + x * 4, x, y);
+                    }
+                }
+
+                RawEncoder encoder;
+                CompressedFrame out;
+                encoder.encode(frame.data(), WIDTH, HEIGHT, PITCH, 4, out); // Warm-up
+                Timer timer;
+                for (int i = 0; i < ITERATIONS; ++i)
+                {
+                    encoder.encode(frame.data(), WIDTH, HEIGHT, PITCH, 4, out);
+                }
+                const f64 ms = timer.elapsed_ms() / ITERATIONS;
+
+                std::cout << std::fixed << std::setprecision(2)
+                          << "  " << std::setw(6) << label << " : " << ms << " ms  "
+                          << frame.size() / (ms * 1e6) << " GB/s  "
+                          << out.size() / 1024 << " KB  (" << static_cast<f64>(frame.size()) / out.size() << ":1, "
+                          << std::setprecision(0) << encoder.up_row_ratio() * 100.0 << "% up rows)\n";
+            };
+
+            run("text", text_pixel);
+            run("ui", ui);
+            run("photo", photo);
+            std::cout << std::endl;
+        }
+
+        /**
+         * Encode a synthetic SBS frame with the built-in encoder at uniform quality
+         * and with centre-weighted quantisation, decode both and compare the size
+         * and the PSNR inside the full-quality centre of each eye and over the frame.
+         */
+        void run_roi_benchmark(const EncoderConfig &config)
+        {
+            constexpr u32 WIDTH = 3840;
+            constexpr u32 HEIGHT = 1080;
+            constexpr u32 PITCH = WIDTH * 3;
+            constexpr u32 EYE_WIDTH = WIDTH / 2;
+
+            // Shaded gradients, hard edges and fine noise in both eyes
+            std::vector<u8> frame(static_cast<size_t>(PITCH) * HEIGHT);
+            for (u32 y = 0; y < HEIGHT; ++y)
+            {
+                for (u32 x = 0; x < WIDTH; ++x)
+                {
+                    const u32 ex = x % EYE_WIDTH;
+                    const u32 noise = (ex * 2654435761u ^ y * 40503u) >> 30;
+                    u8 *p = frame.data() + static_cast<size_t>(y) * PITCH + x * 3;
+                    p[0] = static_cast<u8>((ex + y) / 8 + noise);
+                    p[1] = static_cast<u8>(((ex / 40 + y / 40) % 2 ? 180 : 70) + noise);
+                    p[2] = static_cast<u8>(128 + 100 * std::sin(ex * 0.02) * std::cos(y * 0.015));
+                }
+            }
+
+            // Pixels whose MCU lies inside the inner radius are coded identically in both modes
+            auto in_centre = [&](u32 x, u32 y)
+            {
+                const f32 cx = std::min((x % EYE_WIDTH) / 16 * 16 + 8.0f, EYE_WIDTH - 1.0f);
+                const f32 cy = std::min(y / 16 * 16 + 8.0f, HEIGHT - 1.0f);
+                const f32 dx = (cx - EYE_WIDTH / 2.0f) / (EYE_WIDTH / 2.0f);
+                const f32 dy = (cy - HEIGHT / 2.0f) / (HEIGHT / 2.0f);
+                return std::sqrt(dx * dx + dy * dy) <= config.roi_inner_radius;
+            };
+
+            tjhandle decoder = tjInitDecompress();
+            std::vector<u8> decoded(frame.size());
+
+            // Returns {centre PSNR, frame PSNR}
+            auto psnr = [&](const CompressedFrame &jpeg) -> std::pair<f64, f64>
+            {
+                if (tjDecompress2(decoder, jpeg.ptr(), static_cast<unsigned long>(jpeg.size()), decoded.data(),
+                                  WIDTH, PITCH, HEIGHT, TJPF_BGR, 0) != 0)
+                {
+                    return {0, 0};
+                }
+
+                f64 centre_error = 0, frame_error = 0;
+                u64 centre_samples = 0;
+                for (u32 y = 0; y < HEIGHT; ++y)
+                {
+                    for (u32 x = 0; x < WIDTH; ++x)
+                    {
+                        const size_t i = static_cast<size_t>(y) * PITCH + x * 3;
+                        f64 error = 0;
+                        for (u32 c = 0; c < 3; ++c)
+                        {
+                            const f64 d = static_cast<f64>(frame[i + c]) - decoded[i + c];
+                            error += d * d;
+                        }
+                        frame_error += error;
+                        if (in_centre(x, y))
+                        {
+                            centre_error += error;
+                            centre_samples += 3;
+                        }
+                    }
+                }
+
+                auto to_db = [](f64 error, u64 samples)
+                { return error == 0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 * samples / error); };
+                return {to_db(centre_error, centre_samples), to_db(frame_error, frame.size())};
+            };
+
+            std::cout << std::fixed << std::setprecision(2)
+                      << "Centre-weighted quantisation (" << WIDTH << "x" << HEIGHT << " SBS, q" << config.jpeg_quality
+                      << ", full quality inside r=" << config.roi_inner_radius << ", coarsest from r="
+                      << config.roi_outer_radius << ")\n";
+
+            SimdJPEGEncoder encoder;
+            CompressedFrame out;
+            encoder.encode(frame.data(), WIDTH, HEIGHT, PITCH, 3, config.jpeg_quality, out);
+            const size_t uniform_size = out.size();
+            const auto [uniform_centre, uniform_frame] = psnr(out);
+            std::cout << "  Uniform     : " << uniform_size / 1024 << " KB  centre " << uniform_centre
+                      << " dB  frame " << uniform_frame << " dB\n";
+
+            for (u32 step = 2; step <= 6; step += 2)
+            {
+                encoder.set_roi(2, config.roi_inner_radius, config.roi_outer_radius, step);
+                encoder.encode(frame.data(), WIDTH, HEIGHT, PITCH, 3, config.jpeg_quality, out);
+                const auto [centre, whole] = psnr(out);
+                std::cout << "  ROI step x" << step << ": " << out.size() / 1024 << " KB  centre " << centre
+                          << " dB  frame " << whole << " dB  ("
+                          << 100.0 * (1.0 - static_cast<f64>(out.size()) / uniform_size) << "% smaller)\n";
+            }
+            std::cout << std::endl;
+
+            tjDestroy(decoder);
+        }
+
+        /**
+         * Encode 4K BGRA captures as SBS and single view, first through a full
+         * intermediate stereo frame and then with stereo sampling fused into the
+         * JPEG strips, and print the per-frame time and the intermediate avoided.
+         */
+        void run_fused_benchmark(const EncoderConfig &base)
+        {
+            constexpr u32 WIDTH = 3840;
+            constexpr u32 HEIGHT = 2160;
+            constexpr u32 PITCH = WIDTH * 4;
+            constexpr int ITERATIONS = 30;
+
+            const std::vector<u8> source = gradient_frame(WIDTH, HEIGHT, 4);
+
+            struct Case
+            {
+                const char *label;
+                EncoderConfig::OutputMode mode;
+            };
+            const Case cases[] = {{"SBS        ", EncoderConfig::OutputMode::SBS},
+                                  {"Single view", EncoderConfig::OutputMode::SINGLE_VIEW}};
+
+            std::cout << "Fused stereo + encode (" << WIDTH << "x" << HEIGHT << " BGRA, scale " << base.downscale_factor
+                      << ", q" << base.jpeg_quality << ")\n"
+                      << std::fixed << std::setprecision(2);
+
+            for (const auto &c : cases)
+            {
+                f64 times[2] = {};
+                size_t sizes[2] = {};
+                for (int fused = 0; fused < 2; ++fused)
+                {
+                    EncoderConfig config = base;
+                    config.vr_enabled = true;
+                    config.use_gpu = false;
+                    config.roi_enabled = false;
+                    config.method = EncoderConfig::Method::TURBOJPEG;
+                    config.dynamic_resolution = false;
+                    config.output_width = 0;
+                    config.output_height = 0;
+                    config.output_mode = c.mode;
+                    config.fused_encode = fused != 0;
+
+                    VRFrameEncoder encoder(config);
+                    CompressedFrame out;
+                    encoder.encode(source.data(), WIDTH, HEIGHT, PITCH, 4, out); // Warm up plans and buffers
+
+                    Timer timer;
+                    for (int i = 0; i < ITERATIONS; ++i)
+                    {
+                        encoder.encode(source.data(), WIDTH, HEIGHT, PITCH, 4, out);
+                    }
+                    times[fused] = timer.elapsed_ms() / ITERATIONS;
+                    sizes[fused] = out.size();
+                }
+
+                // Frame the unfused path writes and the encoder reads back (SBS, or one view plus disparity)
+                const u32 out_width = static_cast<u32>(WIDTH * base.downscale_factor) / 2 * 2;
+                const u32 out_height = static_cast<u32>(HEIGHT * base.downscale_factor) / 2 * 2;
+                const u32 disparity = std::min(static_cast<u32>(std::lround(out_width / 2 * base.eye_separation)), out_width / 2);
+                const u32 columns = c.mode == EncoderConfig::OutputMode::SBS ? out_width : out_width / 2 + disparity;
+                const size_t intermediate = static_cast<size_t>(columns) * out_height * 3;
+
+                std::cout << "  " << c.label << ": " << times[0] << " ms -> " << times[1] << " ms fused  ("
+                          << sizes[0] / 1024 << " / " << sizes[1] / 1024 << " KB, "
+                          << intermediate / (1024.0 * 1024.0) << " MB frame not written)\n";
+            }
+            std::cout << std::endl;
+        }
+    } // namespace
+
+    void run_encode_benchmarks(const EncoderConfig &config)
+    {
+        run_jpeg_benchmark(config.jpeg_quality);
+        run_tile_benchmark(config.jpeg_quality);
+        run_raw_benchmark();
+        run_roi_benchmark(config);
+        run_fused_benchmark(config);
+    }
+
+} // namespace vrs::bench
@@ -0,0 +1,91 @@
+/**
+ * VR Streamer - Benchmark Entry Point
+ * Runs the benchmark areas on synthetic frames, without capture or network.
+ */
+
+#include "bench.hpp"
+#include <iostream>
+
+using namespace vrs;
+
+void print_help()
+{
+    std::cout << R"(
+Usage: vrs_bench [options] [area...]
+
+Areas (default: all):
+  encode     JPEG, tile, RAW and ROI encoding, fused stereo + encode
+  pipeline   Encode workers at 90 fps, settings switches while streaming
+  memory     Frame arena, frame pool
+  threads    Frame handoff, pipeline statistics, row-loop dispatch
+
+Options:
+  -h, --help          Show this help message
+  --config <file>     Encoder settings to benchmark (default: built-in defaults)
+  -q, --quality <q>   JPEG quality 1-100
+  --encode-workers <n>
+                      Frame-parallel encode workers (0 = auto)
+)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    Config config = Config::default_config();
+    std::vector<std::string_view> areas;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+
+        if (arg == "-h" || arg == "--help")
+        {
+            print_help();
+            return 0;
+        }
+        else if (arg == "--config" && i + 1 < argc)
+        {
+            try
+            {
+                config = Config::load(argv[++i]);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Cannot load " << argv[i] << ": " << e.what() << std::endl;
+                return 1;
+            }
+        }
+        else if ((arg == "-q" || arg == "--quality") && i + 1 < argc)
+        {
+            config.encoder.jpeg_quality = std::clamp(std::stoi(argv[++i]), 1, 100);
+        }
+        else if (arg == "--encode-workers" && i + 1 < argc)
+        {
+            config.encoder.encode_workers = static_cast<u32>(std::clamp(std::stoi(argv[++i]), 0, 16));
+        }
+        else if (arg == "encode" || arg == "pipeline" || arg == "memory" || arg == "threads")
+        {
+            areas.push_back(arg);
+        }
+        else
+        {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            print_help();
+            return 1;
+        }
+    }
+
+    auto selected = [&](std::string_view area)
+    {
+        return areas.empty() || std::find(areas.begin(), areas.end(), area) != areas.end();
+    };
+
+    if (selected("encode"))
+        bench::run_encode_benchmarks(config.encoder);
+    if (selected("pipeline"))
+        bench::run_pipeline_benchmarks(config.encoder);
+    if (selected("memory"))
+        bench::run_memory_benchmarks(config.encoder);
+    if (selected("threads"))
+        bench::run_thread_benchmarks();
+    return 0;
+}
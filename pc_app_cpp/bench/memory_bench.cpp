@@ -0,0 +1,205 @@
+/**
+ * VR Streamer - Memory Benchmarks
+ * Capture buffers and the compressed frame pool.
+ */
+
+#include "bench.hpp"
+#include "core/frame_arena.hpp"
+#include "encoder/stereo_processor.hpp"
+#include <iomanip>
+#include <iostream>
+#include <stack>
+
+namespace vrs::bench
+{
+
+    namespace
+    {
+        /**
+         * Capture-sized buffers in a heap pool against the pre-faulted frame arena
+         * on 4 KB and huge pages: page faults and time of the first capture copy
+         * into each buffer, then the CPU stereo pass over them once warm.
+         */
+        void run_arena_benchmark(const EncoderConfig &config)
+        {
+            constexpr u32 WIDTH = 3840;
+            constexpr u32 HEIGHT = 2160;
+            constexpr u32 PITCH = WIDTH * 4;
+            constexpr size_t FRAME_SIZE = static_cast<size_t>(PITCH) * HEIGHT;
+            constexpr size_t BUFFERS = 6;
+            constexpr int ROUNDS = 5;
+
+            const std::vector<u8> source = noise_frame(FRAME_SIZE);
+
+            const u32 out_width = static_cast<u32>(WIDTH * config.downscale_factor) / 2 * 2;
+            const u32 out_height = static_cast<u32>(HEIGHT * config.downscale_factor) / 2 * 2;
+            std::vector<u8> output(static_cast<size_t>(out_width) * out_height * 3, 0);
+            CPUStereoProcessor stereo;
+
+            std::cout << "Frame buffers (" << BUFFERS << " x " << WIDTH << "x" << HEIGHT << " BGRA, stereo to "
+                      << out_width << "x" << out_height << ")\n"
+                      << std::fixed << std::setprecision(2);
+
+            for (int variant = 0; variant < 3; ++variant)
+            {
+                FrameBufferPool::Options options;
+                options.buffers = BUFFERS;
+                options.use_arena = variant > 0;
+                options.arena.huge_pages = variant == 2;
+                FrameBufferPool pool(options);
+
+                u64 faults = page_fault_count();
+                Timer setup;
+                pool.provision(FRAME_SIZE);
+                const f64 setup_ms = setup.elapsed_ms();
+                const u64 setup_faults = page_fault_count() - faults;
+                const std::string label = pool.arena() ? std::string("arena, ") + FrameArena::backing_name(pool.arena()->backing())
+                                                       : "heap";
+
+                // First capture into each buffer, as after start or a resize
+                std::array<FrameBufferPool::BufferPtr, BUFFERS> buffers;
+                faults = page_fault_count();
+                Timer first;
+                for (auto &buffer : buffers)
+                {
+                    buffer = pool.acquire(FRAME_SIZE);
+                    std::memcpy(buffer->data, source.data(), FRAME_SIZE);
+                }
+                const f64 first_ms = first.elapsed_ms() / BUFFERS;
+                const u64 first_faults = page_fault_count() - faults;
+
+                faults = page_fault_count();
+                Timer steady;
+                for (int round = 0; round < ROUNDS; ++round)
+                {
+                    for (auto &buffer : buffers)
+                    {
+                        stereo.process_scaled(buffer->data, WIDTH, HEIGHT, PITCH, 4, output.data(), out_width, out_height,
+                                              config.downscale_factor, config.eye_separation);
+                    }
+                }
+                const f64 stereo_ms = steady.elapsed_ms() / (ROUNDS * BUFFERS);
+                const u64 stereo_faults = page_fault_count() - faults;
+
+                std::cout << "  " << std::left << std::setw(30) << label << std::right
+                          << ": setup " << setup_ms << " ms / " << setup_faults << " faults, first copy "
+                          << first_ms << " ms / " << first_faults / BUFFERS << " faults per buffer, stereo "
+                          << stereo_ms << " ms (" << stereo_faults << " faults)\n";
+            }
+
+            // Size classes against the fixed 4K-sized set every capture used to get
+            std::cout << "  Buffer memory by capture size:";
+            const std::pair<u32, u32> sizes[] = {{1280, 720}, {1920, 1080}, {2560, 1440}, {3840, 2160}};
+            for (const auto &[width, height] : sizes)
+            {
+                const size_t bytes = FrameBufferPool::size_class(static_cast<size_t>(width) * height * 4) * BUFFERS;
+                std::cout << " " << width << "x" << height << " " << (bytes >> 20) << " MB,";
+            }
+            const size_t fixed = (FRAME_SIZE + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE * BUFFERS;
+            std::cout << " fixed 4K set " << (fixed >> 20) << " MB\n"
+                      << std::endl;
+        }
+
+        /**
+         * Acquire a compressed frame, hand two extra references around (as the
+         * encoder, reorder buffer and sessions do) and drop them, from 1..N threads
+         * at once: the lock-free slot pool against the mutex + shared_ptr stack it
+         * replaced.
+         */
+        void run_pool_benchmark()
+        {
+            constexpr u32 CYCLES = 200000;
+            constexpr size_t POOL_SIZE = 16;
+
+            // Previous design, kept here for comparison
+            class MutexPool
+            {
+            public:
+                MutexPool()
+                {
+                    for (size_t i = 0; i < POOL_SIZE; ++i)
+                    {
+                        free_.push(std::make_unique<CompressedFrame>());
+                    }
+                }
+
+                std::shared_ptr<CompressedFrame> acquire()
+                {
+                    std::unique_ptr<CompressedFrame> frame;
+                    {
+                        std::lock_guard lock(mutex_);
+                        if (!free_.empty())
+                        {
+                            frame = std::move(free_.top());
+                            free_.pop();
+                        }
+                    }
+                    if (!frame)
+                        frame = std::make_unique<CompressedFrame>();
+                    frame->clear();
+                    return std::shared_ptr<CompressedFrame>(frame.release(), [this](CompressedFrame *released)
+                                                            {
+                        std::unique_ptr<CompressedFrame> owned(released);
+                        std::lock_guard lock(mutex_);
+                        free_.push(std::move(owned)); });
+                }
+
+            private:
+                std::mutex mutex_;
+                std::stack<std::unique_ptr<CompressedFrame>> free_;
+            };
+
+            auto run = [&](u32 threads, auto &&cycle)
+            {
+                std::vector<std::thread> workers;
+                Timer timer;
+                for (u32 t = 0; t < threads; ++t)
+                {
+                    workers.emplace_back([&]
+                                         {
+                        for (u32 i = 0; i < CYCLES; ++i)
+                        {
+                            cycle();
+                        } });
+                }
+                for (auto &worker : workers)
+                {
+                    worker.join();
+                }
+                return timer.elapsed_ns() / (static_cast<f64>(CYCLES) * threads);
+            };
+
+            std::cout << "Frame pool under contention (acquire + 2 shared references + release, ns per cycle)\n"
+                      << std::fixed << std::setprecision(1);
+
+            const u32 max_threads = std::max(2u, std::thread::hardware_concurrency());
+            for (u32 threads = 1; threads <= max_threads; threads *= 2)
+            {
+                CompressedFramePool slot_pool(0, POOL_SIZE);
+                MutexPool mutex_pool;
+
+                const f64 slot_ns = run(threads, [&]
+                                        {
+                    CompressedFramePtr frame = slot_pool.acquire();
+                    CompressedFramePtr session = frame;
+                    CompressedFramePtr queued = session; });
+                const f64 mutex_ns = run(threads, [&]
+                                         {
+                    auto frame = mutex_pool.acquire();
+                    auto session = frame;
+                    auto queued = session; });
+
+                std::cout << "  " << std::setw(2) << threads << " thread(s): slot pool " << slot_ns << "  mutex pool "
+                          << mutex_ns << "  (" << mutex_ns / slot_ns << "x)\n";
+            }
+            std::cout << std::endl;
+        }
+    } // namespace
+
+    void run_memory_benchmarks(const EncoderConfig &config)
+    {
+        run_arena_benchmark(config);
+        run_pool_benchmark();
+    }
+
+} // namespace vrs::bench
@@ -0,0 +1,249 @@
+/**
+ * VR Streamer - Pipeline Benchmarks
+ * The encode worker pool fed with synthetic captures at a fixed frame rate.
+ */
+
+#include "bench.hpp"
+#include "encoder/encode_workers.hpp"
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+
+namespace vrs::bench
+{
+
+    namespace
+    {
+        /**
+         * Feed 4K BGRA captures to the encode worker pool at 90 fps the way the
+         * capture loop does (drop when every worker is busy) and print delivered fps
+         * and capture-to-sink latency for 1..N workers.
+         */
+        void run_worker_benchmark(const EncoderConfig &base)
+        {
+            constexpr u32 WIDTH = 3840;
+            constexpr u32 HEIGHT = 2160;
+            constexpr u32 PITCH = WIDTH * 4;
+            constexpr f64 TARGET_FPS = 90.0;
+            constexpr u32 FRAMES = 270;
+            const size_t frame_size = static_cast<size_t>(PITCH) * HEIGHT;
+
+            const std::vector<u8> source = gradient_frame(WIDTH, HEIGHT, 4);
+
+            std::cout << "Encode workers (" << WIDTH << "x" << HEIGHT << " BGRA at " << TARGET_FPS << " fps, "
+                      << FRAMES << " frames)\n";
+
+            const u32 max_workers = std::min(std::max(1u, std::thread::hardware_concurrency()), EncodeWorkerPool::MAX_WORKERS);
+            for (u32 workers = 1; workers <= max_workers; workers *= 2)
+            {
+                EncoderConfig config = base;
+                config.encode_workers = workers;
+
+                FrameBufferPool frames(frame_size, workers * 2 + 2);
+                CompressedFramePool compressed(1024 * 1024, workers * 2 + 2);
+
+                Timer clock;
+                std::mutex mutex;
+                std::vector<f64> latencies;
+                latencies.reserve(FRAMES);
+                f64 last_delivery_ms = 0;
+
+                u32 submitted = 0;
+                u64 superseded = 0;
+                {
+                    EncodeWorkerPool pool(config, compressed, [&](CompressedFramePtr frame)
+                                          {
+                        const f64 now = clock.elapsed_ms();
+                        const f64 latency = std::chrono::duration<f64, std::milli>(Clock::now().time_since_epoch()).count() -
+                                            frame->timestamp / 1e6;
+                        std::lock_guard lock(mutex);
+                        latencies.push_back(latency);
+                        last_delivery_ms = now; });
+
+                    const f64 start_ms = clock.elapsed_ms();
+                    for (u32 i = 0; i < FRAMES; ++i)
+                    {
+                        const f64 due = start_ms + i * 1000.0 / TARGET_FPS;
+                        while (clock.elapsed_ms() < due)
+                        {
+                            std::this_thread::sleep_for(std::chrono::microseconds(200));
+                        }
+
+                        auto buffer = capture(frames, source, WIDTH, HEIGHT, i);
+                        if (!buffer)
+                            continue; // Back-pressure: every buffer is still with the encoders, drop as capture_loop does
+
+                        if (pool.submit(buffer))
+                            ++submitted;
+                    }
+
+                    // Let the last frames drain
+                    for (int i = 0; i < 500; ++i)
+                    {
+                        {
+                            std::lock_guard lock(mutex);
+                            if (latencies.size() + pool.frames_superseded() >= submitted)
+                                break;
+                        }
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    }
+                    superseded = pool.frames_superseded();
+
+                    std::lock_guard lock(mutex);
+                    if (!latencies.empty())
+                    {
+                        const f64 span_ms = last_delivery_ms - start_ms;
+                        std::sort(latencies.begin(), latencies.end());
+                        const f64 avg = std::accumulate(latencies.begin(), latencies.end(), 0.0) / latencies.size();
+                        std::cout << std::fixed << std::setprecision(1)
+                                  << "  x" << std::setw(2) << workers << " : " << latencies.size() * 1000.0 / span_ms << " fps  "
+                                  << "latency avg " << avg << " ms, p95 " << latencies[latencies.size() * 95 / 100]
+                                  << " ms  (" << FRAMES - submitted << " dropped at capture, " << superseded << " superseded)\n";
+                    }
+                }
+            }
+            std::cout << std::endl;
+        }
+
+        /**
+         * Stream synthetic 1080p captures through the encode worker pool at 60 fps
+         * and flip downscale_factor from another thread every 20 frames. Reports
+         * the time from publishing a setting to the first frame out with it, and
+         * checks the switch is clean: every frame has the old or new size, and none
+         * of the old size follows the first new one.
+         */
+        void run_config_switch_benchmark(const EncoderConfig &base)
+        {
+            constexpr u32 WIDTH = 1920;
+            constexpr u32 HEIGHT = 1080;
+            constexpr u32 PITCH = WIDTH * 4;
+            constexpr u32 SWITCHES = 6;
+            constexpr u32 FRAMES_PER_SWITCH = 20;
+            constexpr auto INTERVAL = std::chrono::microseconds(16667);
+            constexpr f32 SCALES[] = {0.5f, 0.75f};
+            const size_t frame_size = static_cast<size_t>(PITCH) * HEIGHT;
+
+            EncoderConfig config = base;
+            config.method = EncoderConfig::Method::TURBOJPEG;
+            config.output_mode = EncoderConfig::OutputMode::SBS;
+            config.roi_enabled = false;
+            config.dynamic_resolution = false;
+            config.output_width = 0;
+            config.output_height = 0;
+            config.downscale_factor = SCALES[0];
+
+            // Width from the JPEG frame header
+            auto jpeg_width = [](const CompressedFrame &frame) -> u32
+            {
+                const u8 *data = frame.ptr();
+                for (size_t i = 2; i + 9 < frame.length; ++i)
+                {
+                    if (data[i] == 0xFF && data[i + 1] >= 0xC0 && data[i + 1] <= 0xC2)
+                        return (static_cast<u32>(data[i + 7]) << 8) | data[i + 8];
+                }
+                return 0;
+            };
+
+            const std::vector<u8> source = noise_frame(frame_size);
+
+            const u32 workers = EncodeWorkerPool::worker_count_for(config);
+            FrameBufferPool frames(frame_size, workers * 2 + 2);
+            CompressedFramePool compressed(1024 * 1024, workers * 2 + 2);
+
+            std::mutex mutex;
+            std::vector<std::pair<TimePoint, u32>> delivered; // Arrival time and width, in order
+            delivered.reserve(SWITCHES * FRAMES_PER_SWITCH + 16);
+            std::vector<TimePoint> published;
+
+            {
+                EncodeWorkerPool pool(config, compressed, [&](CompressedFramePtr frame)
+                                      {
+                    const u32 width = jpeg_width(*frame);
+                    std::lock_guard lock(mutex);
+                    delivered.emplace_back(Clock::now(), width); });
+
+                std::atomic<u32> frame_index{0};
+                std::thread ui([&]
+                               {
+                    // Publishes from its own thread, as the console and file watch do
+                    for (u32 s = 1; s <= SWITCHES; ++s)
+                    {
+                        while (frame_index.load() < s * FRAMES_PER_SWITCH)
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        EncoderConfig next = config;
+                        next.downscale_factor = SCALES[s % 2];
+                        published.push_back(Clock::now());
+                        pool.update_config(next);
+                    } });
+
+                auto next = Clock::now();
+                for (u32 i = 0; i < (SWITCHES + 1) * FRAMES_PER_SWITCH; ++i)
+                {
+                    next += INTERVAL;
+                    std::this_thread::sleep_until(next);
+
+                    auto buffer = capture(frames, source, WIDTH, HEIGHT, i);
+                    if (!buffer)
+                        continue;
+                    pool.submit(buffer);
+                    frame_index.store(i + 1);
+                }
+                ui.join();
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            }
+
+            const u32 widths[] = {static_cast<u32>(WIDTH * SCALES[0]) / 2 * 2, static_cast<u32>(WIDTH * SCALES[1]) / 2 * 2};
+            std::vector<f64> latencies_ms;
+            u32 glitches = 0;
+            size_t cursor = 0;
+            for (u32 s = 0; s < SWITCHES; ++s)
+            {
+                const u32 target = widths[(s + 1) % 2];
+                while (cursor < delivered.size() && delivered[cursor].first < published[s])
+                    ++cursor;
+                size_t first = cursor;
+                while (first < delivered.size() && delivered[first].second != target)
+                    ++first;
+                if (first == delivered.size())
+                    break;
+                latencies_ms.push_back(std::chrono::duration<f64, std::milli>(delivered[first].first - published[s]).count());
+
+                // After the first new frame, until the next switch, only new frames
+                const TimePoint until = s + 1 < SWITCHES ? published[s + 1] : TimePoint::max();
+                for (size_t i = first; i < delivered.size() && delivered[i].first < until; ++i)
+                {
+                    if (delivered[i].second != target)
+                        ++glitches;
+                }
+                cursor = first;
+            }
+            for (const auto &[time, width] : delivered)
+            {
+                if (width != widths[0] && width != widths[1])
+                    ++glitches;
+            }
+
+            std::cout << "Config switch (" << workers << " worker(s), 60 fps, downscale " << SCALES[0] << " <-> "
+                      << SCALES[1] << ")\n"
+                      << std::fixed << std::setprecision(1);
+            if (latencies_ms.empty())
+            {
+                std::cout << "  No switch observed\n"
+                          << std::endl;
+                return;
+            }
+            const f64 mean = std::accumulate(latencies_ms.begin(), latencies_ms.end(), 0.0) / latencies_ms.size();
+            std::cout << "  Publish to first frame with it: mean " << mean << " ms, worst "
+                      << *std::max_element(latencies_ms.begin(), latencies_ms.end()) << " ms over " << latencies_ms.size()
+                      << " switches; " << delivered.size() << " frames, " << glitches << " out of order or mis-sized\n"
+                      << std::endl;
+        }
+    } // namespace
+
+    void run_pipeline_benchmarks(const EncoderConfig &config)
+    {
+        run_worker_benchmark(config);
+        run_config_switch_benchmark(config);
+    }
+
+} // namespace vrs::bench
@@ -0,0 +1,80 @@
+/**
+ * VR Streamer - Benchmark Frames Implementation
+ */
+
+#include "bench.hpp"
+
+namespace vrs::bench
+{
+
+    std::vector<u8> gradient_frame(u32 width, u32 height, u32 channels)
+    {
+        const size_t pitch = static_cast<size_t>(width) * channels;
+        std::vector<u8> frame(pitch * height, 255);
+        for (u32 y = 0; y < height; ++y)
+        {
+            for (u32 x = 0; x < width; ++x)
+            {
+                u8 *p = frame.data() + y * pitch + x * channels;
+                p[0] = static_cast<u8>(x + y);
+                p[1] = static_cast<u8>((x / 24 + y / 24) % 2 ? 220 : 40);
+                p[2] = static_cast<u8>((x * 3) ^ y);
+            }
+        }
+        return frame;
+    }
+
+    std::vector<u8> noise_frame(size_t bytes)
+    {
+        std::vector<u8> frame(bytes);
+        for (size_t i = 0; i < bytes; ++i)
+        {
+            frame[i] = static_cast<u8>(i * 7 + (i >> 12));
+        }
+        return frame;
+    }
+
+    void text_pixel(u8 *p, u32 x, u32 y)
+    {
+        const bool ink = ((x / 9 + y / 17) % 7 == 0) && (y % 17 < 12);
+        p[0] = ink ? 30 : 245;
+        p[1] = ink ? 30 : 242;
+        p[2] = ink ? 30 : 238;
+    }
+
+    FrameBufferPool::BufferPtr capture(FrameBufferPool &frames, const std::vector<u8> &source,
+                                       u32 width, u32 height, u32 frame_id)
+    {
+        auto buffer = frames.acquire(source.size());
+        if (!buffer)
+        {
+            return buffer;
+        }
+
+        std::memcpy(buffer->data, source.data(), source.size());
+        buffer->size = source.size();
+        buffer->width = width;
+        buffer->height = height;
+        buffer->stride = width * 4;
+        buffer->frame_id = frame_id;
+        buffer->timestamp = std::chrono::duration_cast<Nanoseconds>(Clock::now().time_since_epoch()).count();
+        return buffer;
+    }
+
+    f64 thread_cpu_ms()
+    {
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+        if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+            return 0.0;
+        const auto ticks = [](const FILETIME &time)
+        { return (static_cast<u64>(time.dwHighDateTime) << 32) | time.dwLowDateTime; };
+        return (ticks(kernel) + ticks(user)) / 1e4; // 100 ns units
+#else
+        timespec time{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+        return time.tv_sec * 1e3 + time.tv_nsec / 1e6;
+#endif
+    }
+
+} // namespace vrs::bench
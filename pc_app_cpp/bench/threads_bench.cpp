@@ -0,0 +1,357 @@
+/**
+ * VR Streamer - Threading Benchmarks
+ * Frame handoff, pipeline statistics and row-loop dispatch, each against
+ * the design it replaced.
+ */
+
+#include "bench.hpp"
+#include "vr_streamer.hpp"
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace vrs::bench
+{
+
+    namespace
+    {
+        /**
+         * Hand frames to a consumer thread at 60 fps, as capture does to an encode
+         * worker: the spin-then-sleep polling loop the workers used against the
+         * blocking pop_wait()/push_notify() handoff. Reports the consumer's CPU
+         * use and the delay from push to pop.
+         */
+        void run_handoff_benchmark()
+        {
+            constexpr u32 FRAMES = 120;
+            constexpr auto INTERVAL = std::chrono::microseconds(16667);
+
+            std::cout << "Frame handoff at 60 fps (" << FRAMES << " frames, consumer CPU and push-to-pop latency)\n"
+                      << std::fixed << std::setprecision(1);
+
+            for (int variant = 0; variant < 2; ++variant)
+            {
+                const bool blocking = variant == 1;
+                SPSCQueue<TimePoint, 4> queue;
+                std::atomic<bool> stop{false};
+                std::vector<f64> latencies_us;
+                latencies_us.reserve(FRAMES);
+                f64 cpu_ms = 0.0;
+
+                Timer wall;
+                std::thread consumer([&]
+                                     {
+                    const f64 cpu_start = thread_cpu_ms();
+                    u32 idle = 0;
+                    while (!stop.load(std::memory_order_relaxed))
+                    {
+                        TimePoint pushed;
+                        if (blocking)
+                        {
+                            if (!queue.pop_wait(pushed))
+                                continue;
+                        }
+                        else if (!queue.try_pop(pushed))
+                        {
+                            // Previous encode worker loop
+                            if (++idle < 64)
+                                spin_wait(50);
+                            else
+                                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                            continue;
+                        }
+                        idle = 0;
+                        latencies_us.push_back(std::chrono::duration<f64, std::micro>(Clock::now() - pushed).count());
+                    }
+                    cpu_ms = thread_cpu_ms() - cpu_start; });
+
+                auto next = Clock::now();
+                for (u32 i = 0; i < FRAMES; ++i)
+                {
+                    next += INTERVAL;
+                    std::this_thread::sleep_until(next);
+                    const bool pushed = blocking ? queue.push_notify(Clock::now()) : queue.try_push(Clock::now());
+                    (void)pushed;
+                }
+                std::this_thread::sleep_for(INTERVAL);
+                stop.store(true);
+                queue.close();
+                consumer.join();
+                const f64 wall_ms = wall.elapsed_ms();
+
+                std::sort(latencies_us.begin(), latencies_us.end());
+                const f64 mean = latencies_us.empty() ? 0.0 : std::accumulate(latencies_us.begin(), latencies_us.end(), 0.0) / latencies_us.size();
+                const f64 p99 = latencies_us.empty() ? 0.0 : latencies_us[latencies_us.size() * 99 / 100];
+
+                std::cout << "  " << std::left << std::setw(22) << (blocking ? "pop_wait (futex)" : "spin + 100 us sleep")
+                          << std::right << ": consumer CPU " << std::setw(5) << 100.0 * cpu_ms / wall_ms << "%, latency mean "
+                          << mean << " us, p99 " << p99 << " us (" << latencies_us.size() << " frames)\n";
+            }
+            std::cout << std::endl;
+        }
+
+        /**
+         * Per-frame statistics updates from 4 client IO threads plus the capture
+         * and encode threads, flat out, while a stats thread snapshots them in a
+         * loop: the shared struct under one mutex they used to take against the
+         * sharded counters and seqlock snapshot. Reports the CPU time of each
+         * hot-path update (lock handoffs and cache-line transfers included) and
+         * the snapshots taken.
+         */
+        void run_stats_benchmark()
+        {
+            constexpr u32 CLIENTS = 4;
+            constexpr u32 UPDATES = 200000; // Per thread; 4 x 90 fps makes 360 client updates a second
+            constexpr u32 WRITERS = CLIENTS + 2;
+
+            struct Result
+            {
+                f64 update_ns = 0;
+                f64 snapshots_per_s = 0;
+            };
+
+            // writer(index) performs one update: 0..CLIENTS-1 are clients, then capture, then encode
+            auto run = [&](auto &&writer, auto &&snapshot)
+            {
+                std::atomic<u32> running{WRITERS};
+                std::array<f64, WRITERS> cpu_ms{};
+                u64 snapshots = 0;
+
+                Timer wall;
+                std::thread reader([&]
+                                   {
+                    while (running.load(std::memory_order_relaxed) > 0)
+                    {
+                        snapshot();
+                        ++snapshots;
+                    } });
+
+                std::vector<std::thread> threads;
+                for (u32 t = 0; t < WRITERS; ++t)
+                {
+                    threads.emplace_back([&, t]
+                                         {
+                        const f64 start = thread_cpu_ms();
+                        for (u32 i = 0; i < UPDATES; ++i)
+                        {
+                            writer(t);
+                        }
+                        cpu_ms[t] = thread_cpu_ms() - start;
+                        running.fetch_sub(1); });
+                }
+                for (auto &thread : threads)
+                {
+                    thread.join();
+                }
+                reader.join();
+
+                Result result;
+                result.update_ns = std::accumulate(cpu_ms.begin(), cpu_ms.end(), 0.0) * 1e6 / (static_cast<f64>(UPDATES) * WRITERS);
+                result.snapshots_per_s = snapshots / wall.elapsed_s();
+                return result;
+            };
+
+            // Previous design, kept here for comparison
+            std::mutex mutex;
+            PipelineStats locked;
+            const Result mutex_result = run(
+                [&](u32 t)
+                {
+                    std::lock_guard lock(mutex);
+                    if (t < CLIENTS)
+                    {
+                        locked.bytes_sent += 1500;
+                        locked.frames_sent++;
+                    }
+                    else if (t == CLIENTS)
+                    {
+                        locked.frames_captured++;
+                        locked.capture_fps = 90.0;
+                        locked.capture_time_ms = 1.0;
+                    }
+                    else
+                    {
+                        locked.frames_encoded++;
+                        locked.encode_fps = 90.0;
+                        locked.total_encode_time_ms = 5.0;
+                    }
+                },
+                [&]
+                {
+                    std::lock_guard lock(mutex);
+                    PipelineStats copy = locked;
+                    (void)copy;
+                });
+
+            struct alignas(CACHE_LINE_SIZE) Stage
+            {
+                std::atomic<u64> frames{0};
+                std::atomic<f64> fps{0};
+                std::atomic<f64> time_ms{0};
+            };
+            ShardedCounter bytes_sent;
+            ShardedCounter frames_sent;
+            Stage capture;
+            Stage encode;
+            SeqLock<PipelineStats> published;
+            const Result lock_free_result = run(
+                [&](u32 t)
+                {
+                    if (t < CLIENTS)
+                    {
+                        bytes_sent.add(1500);
+                        frames_sent.add();
+                    }
+                    else
+                    {
+                        Stage &stage = t == CLIENTS ? capture : encode;
+                        stage.frames.fetch_add(1, std::memory_order_relaxed);
+                        stage.fps.store(90.0, std::memory_order_relaxed);
+                        stage.time_ms.store(t == CLIENTS ? 1.0 : 5.0, std::memory_order_relaxed);
+                    }
+                },
+                [&]
+                {
+                    // Stats thread gathers and publishes, GUI reads
+                    PipelineStats snapshot;
+                    snapshot.bytes_sent = bytes_sent.load();
+                    snapshot.frames_sent = frames_sent.load();
+                    snapshot.frames_captured = capture.frames.load(std::memory_order_relaxed);
+                    snapshot.capture_fps = capture.fps.load(std::memory_order_relaxed);
+                    snapshot.frames_encoded = encode.frames.load(std::memory_order_relaxed);
+                    snapshot.encode_fps = encode.fps.load(std::memory_order_relaxed);
+                    published.store(snapshot);
+                    PipelineStats copy = published.load();
+                    (void)copy;
+                });
+
+            std::cout << "Pipeline statistics (" << CLIENTS << " clients + capture + encode updating, stats thread snapshotting)\n"
+                      << std::fixed << std::setprecision(1);
+            for (const auto &[label, result] : {std::pair{"mutex + shared struct", mutex_result},
+                                                std::pair{"sharded + seqlock", lock_free_result}})
+            {
+                std::cout << "  " << std::left << std::setw(22) << label << std::right << ": update " << result.update_ns
+                          << " ns CPU, " << result.snapshots_per_s / 1e6 << "M snapshots/s\n";
+            }
+            std::cout << std::endl;
+        }
+
+        /**
+         * Row loops over a 1080-line frame in bands of 16 rows, as the stereo pass
+         * runs them: an empty body (fork, band claiming and join alone) and a
+         * half-width nearest-neighbour resample. Compares the time per loop run
+         * serially, on the shared work-stealing pool and, in builds with OpenMP,
+         * under a schedule(dynamic) loop over the same bands, as the kernels used
+         * before.
+         */
+        void run_dispatch_benchmark()
+        {
+            constexpr u32 WIDTH = 1920;
+            constexpr u32 HEIGHT = 1080;
+            constexpr u32 PITCH = WIDTH * 3;
+            constexpr u32 OUT_PITCH = WIDTH / 2 * 3;
+            constexpr u32 GRAIN = 16;
+
+            const std::vector<u8> source = noise_frame(static_cast<size_t>(PITCH) * HEIGHT);
+            std::vector<u8> output(static_cast<size_t>(OUT_PITCH) * HEIGHT);
+
+            std::atomic<u32> rows_seen{0};
+            auto empty_rows = [&](u32 first, u32 last)
+            {
+                rows_seen.fetch_add(last - first, std::memory_order_relaxed);
+            };
+            auto resample_rows = [&](u32 first, u32 last)
+            {
+                for (u32 y = first; y < last; ++y)
+                {
+                    const u8 *src = source.data() + static_cast<size_t>(y) * PITCH;
+                    u8 *dst = output.data() + static_cast<size_t>(y) * OUT_PITCH;
+                    for (u32 x = 0; x < WIDTH / 2; ++x, dst += 3)
+                    {
+                        const u8 *pixel = src + x * 2 * 3;
+                        dst[0] = pixel[0];
+                        dst[1] = pixel[1];
+                        dst[2] = pixel[2];
+                    }
+                }
+            };
+
+            // Mean microseconds per call of loop, after a warm-up
+            auto time_us = [](u32 iterations, auto &&loop)
+            {
+                for (u32 i = 0; i < iterations / 10 + 1; ++i)
+                {
+                    loop();
+                }
+                Timer timer;
+                for (u32 i = 0; i < iterations; ++i)
+                {
+                    loop();
+                }
+                const f64 us = timer.elapsed_ms() * 1e3 / iterations;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50)); // Let the other variant's workers go idle
+                return us;
+            };
+
+            ThreadPool &pool = get_global_thread_pool();
+
+            std::cout << "Row-loop dispatch (" << HEIGHT << " rows in bands of " << GRAIN << ", pool " << pool.size() + 1
+                      << " threads";
+#ifdef _OPENMP
+            std::cout << ", OpenMP " << omp_get_max_threads() << " threads";
+#endif
+            std::cout << ", us per loop)\n"
+                      << std::fixed << std::setprecision(1);
+
+            constexpr i32 BANDS = (HEIGHT + GRAIN - 1) / GRAIN;
+            for (int variant = 0; variant < 2; ++variant)
+            {
+                const bool empty = variant == 0;
+                const u32 iterations = empty ? 20000 : 500;
+                auto run_band = [&](i32 band)
+                {
+                    const u32 first = band * GRAIN;
+                    empty ? empty_rows(first, std::min(HEIGHT, first + GRAIN))
+                          : resample_rows(first, std::min(HEIGHT, first + GRAIN));
+                };
+
+                const f64 serial_us = time_us(iterations, [&]
+                                              {
+                    for (i32 band = 0; band < BANDS; ++band)
+                        run_band(band); });
+
+                const f64 pool_us = time_us(iterations, [&]
+                                            { empty ? pool.parallel_for(0, HEIGHT, GRAIN, empty_rows)
+                                                    : pool.parallel_for(0, HEIGHT, GRAIN, resample_rows); });
+
+                std::cout << "  " << std::left << std::setw(20) << (empty ? "empty body" : "half-width resample") << std::right << ": serial " << std::setw(7)
+                          << serial_us << "  pool " << std::setw(7) << pool_us;
+#ifdef _OPENMP
+                // Previous dispatch, kept here for comparison
+                const f64 omp_us = time_us(iterations, [&]
+                                           {
+#pragma omp parallel for schedule(dynamic)
+                    for (i32 band = 0; band < BANDS; ++band)
+                        run_band(band); });
+                std::cout << "  OpenMP " << std::setw(7) << omp_us;
+#else
+                std::cout << "  (OpenMP not in this build)";
+#endif
+                std::cout << "\n";
+            }
+            std::cout << std::endl;
+        }
+    } // namespace
+
+    void run_thread_benchmarks()
+    {
+        run_handoff_benchmark();
+        run_stats_benchmark();
+        run_dispatch_benchmark();
+    }
+
+} // namespace vrs::bench
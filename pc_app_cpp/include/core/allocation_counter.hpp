@@ -0,0 +1,32 @@
+#pragma once
+/**
+ * VR Streamer - Allocation Counter
+ * Debug hook on the global operator new, to check that the streaming
+ * pipeline stops allocating once it has warmed up.
+ * Built with ENABLE_ALLOC_COUNTER (VRS_COUNT_ALLOCATIONS); otherwise the
+ * count stays 0 and operator new is the standard one.
+ */
+
+#include "common.hpp"
+
+namespace vrs
+{
+
+    /**
+     * Whether this build counts allocations.
+     */
+    [[nodiscard]] constexpr bool allocation_counting() noexcept
+    {
+#ifdef VRS_COUNT_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Calls to operator new (all forms, all threads) since start.
+     */
+    [[nodiscard]] u64 allocation_count() noexcept;
+
+} // namespace vrs
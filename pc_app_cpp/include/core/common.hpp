@@ -66,6 +66,8 @@
 #endif
 
 // Standard includes
+#include <algorithm>
+#include <utility>
 #include <cstdint>
 #include <cstddef>
 #include <cstring>
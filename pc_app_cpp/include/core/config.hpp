@@ -5,6 +5,7 @@
  */
 
 #include "common.hpp"
+#include <filesystem>
 #include <fstream>
 
 namespace vrs
@@ -23,6 +24,10 @@ namespace vrs
         // Performance tuning
         u32 frame_buffer_count = 3;  // Triple buffering
         bool wait_for_vsync = false; // Wait for VSync (reduces tearing but adds latency)
+        bool huge_pages = true;      // Back frame buffers with 2 MB pages where the OS allows
+        bool lock_frames = false;    // Pin frame buffers in RAM (mlock / VirtualLock)
+
+        bool operator==(const CaptureConfig &) const = default;
     };
 
     /**
@@ -31,35 +36,75 @@ namespace vrs
     struct EncoderConfig
     {
         // Quality settings
-        u32 jpeg_quality = 65;        // JPEG quality (1-100)
-        f32 downscale_factor = 0.65f; // Resolution scale (1.0 = native)
-        u32 output_width = 0;         // Custom output width (0 = auto)
-        u32 output_height = 0;        // Custom output height (0 = auto)
+        u32 jpeg_quality = 65;           // JPEG quality (1-100)
+        f32 downscale_factor = 0.65f;    // Resolution scale (1.0 = native)
+        u32 output_width = 0;            // Custom output width (0 = auto)
+        u32 output_height = 0;           // Custom output height (0 = auto)
+        bool dynamic_resolution = false; // Scale below downscale_factor while encoding misses the target FPS
+        f32 min_downscale = 0.25f;       // Dynamic resolution floor
+
+        // Centre-weighted quantisation (SBS/mono JPEG, coded by the built-in encoder)
+        bool roi_enabled = false;     // Coarser AC quantisation away from each lens centre
+        f32 roi_inner_radius = 0.5f;  // Full quality inside (1.0 = middle of the eye's edges)
+        f32 roi_outer_radius = 1.25f; // Coarsest quantisation from here out
+        u32 roi_max_step = 4;         // AC quantiser multiple at roi_outer_radius (1-8)
+
+        // Rate control (JPEG SBS/DUAL_EYE): jpeg_quality becomes the starting point
+        u32 frame_budget_bytes = 0;     // Target bytes per frame (0 = fixed quality)
+        bool frame_budget_auto = false; // Derive the budget from client throughput
+        u32 rate_min_quality = 25;      // Quality range the controller may use
+        u32 rate_max_quality = 90;
+
+        // Idle refinement (JPEG SBS/DUAL_EYE): resend a static screen at high quality
+        bool refine_enabled = false;    // Encode one refined frame once the screen stops changing
+        u32 refine_static_frames = 30;  // Unchanged captures before refining
+        u32 refine_quality = 95;        // JPEG quality of the refined frame
+        bool refine_full_chroma = true; // Refined frame uses 4:4:4 chroma
+        bool full_chroma = false;       // 4:4:4 instead of 4:2:0 (TurboJPEG paths)
 
         // Compression method
         enum class Method : u8
         {
-            JPEG,      // Standard JPEG
+            JPEG,      // Built-in SIMD encoder
             NVJPEG,    // NVIDIA nvJPEG (GPU)
             TURBOJPEG, // libjpeg-turbo (SIMD optimized)
-            H264,      // NVENC H.264 (lowest bandwidth)
-            RAW        // Uncompressed (highest bandwidth)
+            H264,      // x264 H.264 with intra refresh (lowest bandwidth)
+            RAW        // Lossless prediction + QOI-style codec (wired links)
         } method = Method::TURBOJPEG;
 
+        // CPU encoding
+        u32 jpeg_threads = 0;           // Parallel restart-strip JPEG threads (0 = auto, 1 = single-threaded)
+        u32 huffman_interval_ms = 1000; // Learn Huffman tables in the background (0 = Annex K tables)
+        u32 encode_workers = 1;         // Frame-parallel encoders (0 = auto); TILES/H.264 always use one
+        bool fused_encode = true;       // Sample stereo rows straight into the JPEG strips (no SBS frame in memory)
+
         // VR settings
         bool vr_enabled = true;     // Enable VR stereo output
         f32 eye_separation = 0.03f; // IPD simulation (0-0.1)
 
+        // Wire layout of a VR frame
+        enum class OutputMode : u8
+        {
+            SBS,        // One side-by-side JPEG
+            DUAL_EYE,   // Left/right JPEGs encoded in parallel, one framed message
+            TILES,      // Only changed tiles, composited by the client
+            SINGLE_VIEW // One view plus disparity, both eyes cut from it by the client (shift stereo only)
+        } output_mode = OutputMode::SBS;
+        u32 tile_size = 128;              // TILES: tile edge in pixels (per eye grid)
+        u32 tile_keyframe_interval = 120; // TILES: full frame every N frames (0 = only on connect)
+
         // GPU acceleration
         bool use_gpu = true;    // Enable GPU processing
         i32 gpu_device_id = 0;  // GPU device ID
         bool use_nvenc = true;  // Use NVENC for H.264
         bool use_nvjpeg = true; // Use nvJPEG for JPEG
 
-        // H.264 specific (if using NVENC)
+        // H.264 specific
         u32 h264_bitrate = 20000;     // Kbps
-        u32 h264_gop_length = 30;     // Keyframe interval
-        bool h264_low_latency = true; // Low latency mode
+        u32 h264_gop_length = 30;     // Intra refresh period in frames
+        bool h264_low_latency = true; // Fastest x264 preset (false = better quality per bit)
+
+        bool operator==(const EncoderConfig &) const = default;
     };
 
     /**
@@ -79,6 +124,25 @@ namespace vrs
         // Performance
         bool use_tcp_nodelay = true; // Disable Nagle's algorithm
         bool use_cork = false;       // Cork TCP for better batching
+
+        bool operator==(const NetworkConfig &) const = default;
+    };
+
+    /**
+     * Thread placement. Core sets are CPU lists such as "2" or "4-7,12"
+     * (empty = any CPU).
+     */
+    struct ThreadConfig
+    {
+        std::string capture_cores;    // Capture loop
+        std::string encode_cores;     // Encode workers, strip and eye threads
+        std::string network_cores;    // WebSocket and HTTP IO threads
+        std::string background_cores; // Refinement, Huffman learning, stats
+        bool avoid_smt = false;       // Capture/encode on one logical CPU per physical core
+        bool realtime = false;        // Capture/encode at real-time priority (SCHED_FIFO needs CAP_SYS_NICE)
+        i32 background_nice = 10;     // Background niceness (Windows: below normal if > 0)
+
+        bool operator==(const ThreadConfig &) const = default;
     };
 
     /**
@@ -101,6 +165,7 @@ namespace vrs
         CaptureConfig capture;
         EncoderConfig encoder;
         NetworkConfig network;
+        ThreadConfig threads;
 
         /**
          * Apply a quality preset.
@@ -111,16 +176,63 @@ namespace vrs
          * Save configuration to YAML file.
          */
         bool save(const std::string &filepath = "config.yaml") const;
+        void save(std::ostream &out) const;
 
         /**
          * Load configuration from YAML file.
          */
         static Config load(const std::string &filepath = "config.yaml");
+        static Config load(std::istream &in);
+
+        /**
+         * Take every field that differs between two reads of a config file
+         * (before, after); fields the file did not change keep their value
+         * here, so command-line overrides and interactive changes survive
+         * a reload that did not touch them.
+         */
+        void apply_changes(const Config &before, const Config &after);
 
         /**
          * Get default configuration.
          */
         static Config default_config();
+
+        bool operator==(const Config &) const = default;
+    };
+
+    /**
+     * Hot reload: notices when a config file has been written since it was
+     * last read. Polled (once a second by the stats thread), so it needs no
+     * platform file notification API.
+     */
+    class ConfigWatcher
+    {
+    public:
+        /**
+         * The file as it is now counts as already read.
+         */
+        explicit ConfigWatcher(std::string filepath);
+
+        /**
+         * File contents at the previous read and now.
+         */
+        struct Change
+        {
+            Config before;
+            Config after;
+        };
+
+        /**
+         * Load the file if its modification time changed since the last call.
+         */
+        [[nodiscard]] std::optional<Change> poll();
+
+        [[nodiscard]] const std::string &filepath() const noexcept { return filepath_; }
+
+    private:
+        std::string filepath_;
+        std::filesystem::file_time_type last_write_{};
+        Config last_read_;
     };
 
     // Preset parameters
@@ -0,0 +1,85 @@
+#pragma once
+/**
+ * VR Streamer - Frame Arena
+ * One mapping for all capture buffers, backed by 2 MB pages where the OS
+ * allows and touched up front, so the first frames after start do not
+ * stall on page faults and the stereo pass walks far fewer TLB entries.
+ */
+
+#include "common.hpp"
+
+namespace vrs
+{
+
+    // Large page size on x86-64 (Windows reports its own minimum at runtime)
+    constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    /**
+     * block_count blocks of block_size bytes, each starting on a 2 MB
+     * boundary. Mapping falls back in order:
+     *   - explicit huge pages (MAP_HUGETLB / MEM_LARGE_PAGES), which need
+     *     pages reserved by the admin (vm.nr_hugepages / SeLockMemoryPrivilege);
+     *   - ordinary pages with madvise(MADV_HUGEPAGE), which transparent huge
+     *     pages may back (Linux only);
+     *   - ordinary pages.
+     * Every page is written once in the constructor.
+     */
+    class FrameArena
+    {
+    public:
+        enum class Backing : u8
+        {
+            HUGE_PAGES,             // Explicit large pages
+            TRANSPARENT_HUGE_PAGES, // Hinted; the kernel decides per 2 MB range
+            REGULAR_PAGES
+        };
+
+        struct Options
+        {
+            bool huge_pages = true; // Try large pages before 4 KB ones
+            bool lock = false;      // Pin in RAM (mlock / VirtualLock); best effort
+        };
+
+        /**
+         * @throws std::bad_alloc if nothing can be mapped
+         */
+        FrameArena(size_t block_size, size_t block_count, const Options &options);
+        ~FrameArena();
+
+        FrameArena(const FrameArena &) = delete;
+        FrameArena &operator=(const FrameArena &) = delete;
+
+        [[nodiscard]] u8 *block(size_t index) const noexcept { return base_ + index * block_stride_; }
+
+        /**
+         * Usable bytes per block (block_size rounded up to 2 MB).
+         */
+        [[nodiscard]] size_t block_size() const noexcept { return block_stride_; }
+        [[nodiscard]] size_t block_count() const noexcept { return block_count_; }
+        [[nodiscard]] size_t size_bytes() const noexcept { return block_stride_ * block_count_; }
+
+        [[nodiscard]] Backing backing() const noexcept { return backing_; }
+        [[nodiscard]] bool locked() const noexcept { return locked_; }
+
+        [[nodiscard]] static const char *backing_name(Backing backing) noexcept;
+
+    private:
+        void map(bool huge_pages);
+        void prefault() noexcept;
+        void lock();
+
+        u8 *base_ = nullptr;
+        size_t block_stride_;
+        size_t block_count_;
+        size_t mapped_size_ = 0; // Bytes to unmap (explicit huge pages round up further)
+        Backing backing_ = Backing::REGULAR_PAGES;
+        bool locked_ = false;
+    };
+
+    /**
+     * Page faults taken by this process so far (minor + major on Linux,
+     * PageFaultCount on Windows).
+     */
+    [[nodiscard]] u64 page_fault_count() noexcept;
+
+} // namespace vrs
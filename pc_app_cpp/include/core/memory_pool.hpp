@@ -6,22 +6,211 @@
  */
 
 #include "common.hpp"
-#include <mutex>
-#include <stack>
+#include "frame_arena.hpp"
 
 namespace vrs
 {
 
+    template <typename T>
+    class SlotPool;
+
+    /**
+     * Handle to an object in a SlotPool. Copies share the object through a
+     * count stored next to it; when the last copy goes the slot returns to
+     * its pool, so nothing needs a release() call. One pointer wide, no
+     * separate control block.
+     */
+    template <typename T>
+    class PoolPtr
+    {
+    public:
+        PoolPtr() noexcept = default;
+        PoolPtr(std::nullptr_t) noexcept {}
+
+        PoolPtr(const PoolPtr &other) noexcept : slot_(other.slot_)
+        {
+            if (slot_)
+                slot_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        PoolPtr(PoolPtr &&other) noexcept : slot_(std::exchange(other.slot_, nullptr)) {}
+
+        PoolPtr &operator=(PoolPtr other) noexcept
+        {
+            std::swap(slot_, other.slot_);
+            return *this;
+        }
+
+        ~PoolPtr() { reset(); }
+
+        void reset() noexcept
+        {
+            if (auto *slot = std::exchange(slot_, nullptr))
+                SlotPool<T>::release(slot);
+        }
+
+        [[nodiscard]] T *get() const noexcept { return slot_ ? &slot_->value : nullptr; }
+        [[nodiscard]] T &operator*() const noexcept { return slot_->value; }
+        [[nodiscard]] T *operator->() const noexcept { return &slot_->value; }
+        [[nodiscard]] explicit operator bool() const noexcept { return slot_ != nullptr; }
+
+        /**
+         * Handles sharing the object (approximate while other threads hold some).
+         */
+        [[nodiscard]] u32 use_count() const noexcept
+        {
+            return slot_ ? slot_->refs.load(std::memory_order_relaxed) : 0;
+        }
+
+    private:
+        friend class SlotPool<T>;
+
+        explicit PoolPtr(typename SlotPool<T>::Slot *slot) noexcept : slot_(slot) {}
+
+        typename SlotPool<T>::Slot *slot_ = nullptr;
+    };
+
     /**
-     * Fixed-size block pool for frame buffers.
-     * Thread-safe with minimal contention using a lock-free free list.
+     * Fixed array of objects with a lock-free (Treiber) free list. The head
+     * packs a slot index with a tag bumped on every change, so a slot that
+     * is popped and pushed back between a thread's load and its CAS cannot
+     * be mistaken for an unchanged list (ABA).
+     *
+     * Outstanding handles keep the pool alive: it is deleted when its owner
+     * has called destroy() and the last slot has come back.
+     */
+    template <typename T>
+    class SlotPool
+    {
+    public:
+        struct Slot
+        {
+            T value{};
+            std::atomic<u32> refs{0};
+            std::atomic<u32> next{EMPTY}; // Free-list link
+            u32 index = 0;
+            SlotPool *pool = nullptr;
+        };
+
+        /**
+         * @param init Called once on each object (e.g. to reserve its memory)
+         */
+        template <typename Init>
+        [[nodiscard]] static SlotPool *create(size_t count, Init &&init)
+        {
+            auto *pool = new SlotPool(static_cast<u32>(count));
+            for (u32 i = 0; i < pool->count_; ++i)
+            {
+                Slot &slot = pool->slots_[i];
+                slot.index = i;
+                slot.pool = pool;
+                init(slot.value);
+                pool->push(slot);
+            }
+            return pool;
+        }
+
+        /**
+         * Drop the owner's reference; the pool goes once every slot is back.
+         */
+        void destroy() noexcept { unref(); }
+
+        /**
+         * Pop a free object, or nullptr handle if none is free.
+         */
+        [[nodiscard]] PoolPtr<T> try_acquire() noexcept
+        {
+            Slot *slot = pop();
+            if (!slot)
+                return {};
+            refs_.fetch_add(1, std::memory_order_relaxed);
+            slot->refs.store(1, std::memory_order_relaxed);
+            return PoolPtr<T>(slot);
+        }
+
+        [[nodiscard]] size_t size() const noexcept { return count_; }
+
+        /**
+         * Free objects (approximate while other threads acquire and release).
+         */
+        [[nodiscard]] size_t free_count() const noexcept
+        {
+            return count_ - (refs_.load(std::memory_order_relaxed) - 1);
+        }
+
+        static void release(Slot *slot) noexcept
+        {
+            if (slot->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+
+            SlotPool *pool = slot->pool;
+            pool->push(*slot);
+            pool->unref();
+        }
+
+    private:
+        static constexpr u32 EMPTY = 0xFFFFFFFFu;
+
+        explicit SlotPool(u32 count) : slots_(std::make_unique<Slot[]>(count)), count_(count) {}
+
+        void push(Slot &slot) noexcept
+        {
+            u64 head = head_.load(std::memory_order_relaxed);
+            u64 next;
+            do
+            {
+                slot.next.store(static_cast<u32>(head), std::memory_order_relaxed);
+                next = ((head >> 32) + 1) << 32 | slot.index;
+            } while (!head_.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        [[nodiscard]] Slot *pop() noexcept
+        {
+            u64 head = head_.load(std::memory_order_acquire);
+            while (true)
+            {
+                const u32 index = static_cast<u32>(head);
+                if (index == EMPTY)
+                    return nullptr;
+
+                // May read a slot another thread just took; the tag then fails the CAS
+                const u32 after = slots_[index].next.load(std::memory_order_relaxed);
+                const u64 next = ((head >> 32) + 1) << 32 | after;
+                if (head_.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
+                    return &slots_[index];
+            }
+        }
+
+        void unref() noexcept
+        {
+            if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete this;
+        }
+
+        std::unique_ptr<Slot[]> slots_;
+        u32 count_;
+        alignas(CACHE_LINE_SIZE) std::atomic<u64> head_{EMPTY}; // Tag << 32 | slot index
+        alignas(CACHE_LINE_SIZE) std::atomic<u32> refs_{1};     // Owner + slots handed out
+    };
+
+    /**
+     * Frame buffers sized for the capture actually running. Buffers come in
+     * power-of-two size classes from 2 MB (a 1080p BGRA frame fits 8 MB, 4K
+     * fits 32 MB), and the whole set is re-provisioned when captures move to
+     * another class. Older buffers stay valid until their last handle goes.
+     *
+     * Each set holds a fixed number of buffers plus at most max_growth heap
+     * buffers made while all of them are in use; past that acquire() returns
+     * nullptr, and the capture should be dropped (back-pressure) rather than
+     * queued. Lock-free free list; buffers return to it when their last
+     * handle goes.
      */
     class FrameBufferPool
     {
     public:
         struct Buffer
         {
-            AlignedPtr<u8> data;
+            u8 *data;
             size_t capacity;
             size_t size;
             u32 width;
@@ -30,20 +219,37 @@ namespace vrs
             u32 format;    // DXGI_FORMAT or custom format enum
             u64 timestamp; // Capture timestamp in nanoseconds
             u32 frame_id;
+            AlignedPtr<u8> storage;            // Heap memory, if not in an arena
+            std::shared_ptr<FrameArena> arena; // Keeps arena memory mapped
 
-            Buffer() : capacity(0), size(0), width(0), height(0), stride(0),
+            Buffer() : data(nullptr), capacity(0), size(0), width(0), height(0), stride(0),
                        format(0), timestamp(0), frame_id(0) {}
 
             void allocate(size_t cap)
             {
                 if (cap > capacity)
                 {
-                    data = make_aligned_array<u8>(cap, PAGE_SIZE);
+                    // Outgrew its arena block (or has none): heap from here on
+                    storage = make_aligned_array<u8>(cap, PAGE_SIZE);
+                    arena.reset();
+                    data = storage.get();
                     capacity = cap;
                 }
                 size = 0;
             }
 
+            /**
+             * Use an arena block instead of heap memory.
+             */
+            void attach(std::shared_ptr<FrameArena> owner, size_t index)
+            {
+                data = owner->block(index);
+                capacity = owner->block_size();
+                size = 0;
+                storage.reset();
+                arena = std::move(owner);
+            }
+
             void reset()
             {
                 size = 0;
@@ -54,228 +260,377 @@ namespace vrs
             }
         };
 
-        using BufferPtr = std::shared_ptr<Buffer>;
+        using BufferPtr = PoolPtr<Buffer>;
+
+        struct Options
+        {
+            size_t buffers = 8;        // Per size class
+            size_t max_growth = 2;     // Heap buffers added while all are in use
+            bool use_arena = true;     // Map buffers in a pre-faulted FrameArena (else heap)
+            FrameArena::Options arena;
+        };
+
+        static constexpr size_t MIN_SIZE_CLASS = HUGE_PAGE_SIZE;
+
+        // Smaller captures in a row before the set shrinks (window resizes pass through many sizes)
+        static constexpr u32 SHRINK_AFTER = 120;
+
+        /**
+         * Nothing is allocated until the first acquire() (or provision()).
+         */
+        explicit FrameBufferPool(const Options &options) : options_(options) {}
 
+        /**
+         * pool_size heap buffers for buffer_size bytes, provisioned now.
+         */
         explicit FrameBufferPool(size_t buffer_size, size_t pool_size = 8)
-            : buffer_size_(buffer_size), pool_size_(pool_size)
+            : options_{pool_size, 2, false, {}}
         {
-            // Pre-allocate all buffers
-            for (size_t i = 0; i < pool_size; ++i)
-            {
-                auto buf = std::make_shared<Buffer>();
-                buf->allocate(buffer_size);
-                free_buffers_.push(buf);
-            }
+            provision(buffer_size);
+        }
+
+        ~FrameBufferPool()
+        {
+            if (slots_)
+                slots_->destroy();
         }
 
+        FrameBufferPool(const FrameBufferPool &) = delete;
+        FrameBufferPool &operator=(const FrameBufferPool &) = delete;
+
         /**
-         * Acquire a buffer from the pool.
-         * Returns nullptr if no buffers available.
+         * Smallest size class holding bytes.
          */
-        [[nodiscard]] BufferPtr acquire()
+        [[nodiscard]] static size_t size_class(size_t bytes) noexcept
         {
-            std::lock_guard lock(mutex_);
-            if (free_buffers_.empty())
+            size_t size = MIN_SIZE_CLASS;
+            while (size < bytes)
+                size <<= 1;
+            return size;
+        }
+
+        /**
+         * Buffer of at least bytes (capture thread only). Moves to a larger
+         * size class at once and to a smaller one after SHRINK_AFTER frames.
+         * @return nullptr if every buffer is in use and growth is used up
+         */
+        [[nodiscard]] BufferPtr acquire(size_t bytes)
+        {
+            const size_t wanted = size_class(bytes);
+            if (wanted > buffer_size_ || (wanted < buffer_size_ && ++smaller_frames_ >= SHRINK_AFTER))
             {
-                // Grow pool if needed (avoid in hot path)
-                auto buf = std::make_shared<Buffer>();
-                buf->allocate(buffer_size_);
+                provision(bytes);
+            }
+            else if (wanted == buffer_size_)
+            {
+                smaller_frames_ = 0;
+            }
+
+            BufferPtr buf = slots_->try_acquire();
+            if (!buf)
+            {
+                exhausted_.fetch_add(1, std::memory_order_relaxed);
                 return buf;
             }
-            auto buf = free_buffers_.top();
-            free_buffers_.pop();
+            if (buf->capacity < buffer_size_)
+            {
+                // Growth slot, first use (avoid in hot path)
+                buf->allocate(buffer_size_);
+                provisioned_bytes_.fetch_add(buffer_size_, std::memory_order_relaxed);
+            }
             buf->reset();
             return buf;
         }
 
         /**
-         * Release a buffer back to the pool.
+         * Replace the buffer set with one for the size class of bytes
+         * (capture thread only).
          */
-        void release(BufferPtr buf)
+        void provision(size_t bytes)
         {
-            if (!buf)
-                return;
-            std::lock_guard lock(mutex_);
-            if (free_buffers_.size() < pool_size_ * 2)
+            const size_t size = size_class(bytes);
+            std::shared_ptr<FrameArena> arena;
+            if (options_.use_arena)
             {
-                buf->reset();
-                free_buffers_.push(std::move(buf));
+                try
+                {
+                    arena = std::make_shared<FrameArena>(size, options_.buffers, options_.arena);
+                }
+                catch (const std::bad_alloc &)
+                {
+                    VRS_LOG_WARN("Could not map a frame arena, using heap buffers");
+                }
             }
-            // Else let it be destroyed (pool is oversized)
+
+            // Growth slots take the low indices: pushed first, so popped only once the rest are out
+            const size_t growth = options_.max_growth;
+            auto *slots = SlotPool<Buffer>::create(
+                options_.buffers + growth, [&, index = size_t{0}](Buffer &buffer) mutable
+                {
+                    if (index >= growth)
+                    {
+                        if (arena)
+                            buffer.attach(arena, index - growth);
+                        else
+                            buffer.allocate(size);
+                    }
+                    ++index; });
+
+            if (slots_)
+                slots_->destroy();
+            slots_ = slots;
+            arena_ = std::move(arena);
+            buffer_size_ = size;
+            smaller_frames_ = 0;
+            provisioned_bytes_.store(size * options_.buffers, std::memory_order_relaxed);
+
+            VRS_LOG_INFO(std::format("Frame buffers: {} x {} MB, {}{}", options_.buffers, size >> 20,
+                                     arena_ ? FrameArena::backing_name(arena_->backing()) : "heap",
+                                     arena_ && arena_->locked() ? ", locked" : ""));
         }
 
         /**
-         * Get buffer size.
+         * Current size class (0 before the first acquire()).
          */
         [[nodiscard]] size_t buffer_size() const noexcept { return buffer_size_; }
 
         /**
-         * Get number of free buffers.
+         * Arena behind the current set (capture thread only; nullptr for heap buffers).
+         */
+        [[nodiscard]] const FrameArena *arena() const noexcept { return arena_.get(); }
+
+        /**
+         * Get number of free buffers in the current set (capture thread only).
          */
-        [[nodiscard]] size_t free_count() const
+        [[nodiscard]] size_t free_count() const noexcept { return slots_ ? slots_->free_count() : 0; }
+
+        /**
+         * acquire() calls that found every buffer in use.
+         */
+        [[nodiscard]] u64 exhausted() const noexcept { return exhausted_.load(std::memory_order_relaxed); }
+
+        /**
+         * Bytes of buffers in the current set, growth included.
+         */
+        [[nodiscard]] size_t provisioned_bytes() const noexcept
         {
-            std::lock_guard lock(mutex_);
-            return free_buffers_.size();
+            return provisioned_bytes_.load(std::memory_order_relaxed);
         }
 
     private:
-        size_t buffer_size_;
-        size_t pool_size_;
-        std::stack<BufferPtr> free_buffers_;
-        mutable std::mutex mutex_;
+        Options options_;
+        SlotPool<Buffer> *slots_ = nullptr; // Outlives this pool while buffers are out
+        std::shared_ptr<FrameArena> arena_;
+        size_t buffer_size_ = 0;
+        u32 smaller_frames_ = 0;
+        std::atomic<u64> exhausted_{0};
+        std::atomic<size_t> provisioned_bytes_{0};
     };
 
     /**
-     * RAII wrapper for auto-release of pooled buffers.
+     * Bump allocator for per-frame scratch: allocate() hands out aligned
+     * slices of one block and reset() drops them all at once. A frame that
+     * outgrows the block is served from the heap, and the next reset()
+     * resizes the block to that frame's peak, so a steady stream of
+     * same-sized frames allocates nothing. Not thread-safe: one per thread.
      */
-    class PooledBuffer
+    class ScratchArena
     {
     public:
-        PooledBuffer() : pool_(nullptr) {}
-
-        PooledBuffer(FrameBufferPool &pool, FrameBufferPool::BufferPtr buf)
-            : pool_(&pool), buffer_(std::move(buf)) {}
-
-        PooledBuffer(PooledBuffer &&other) noexcept
-            : pool_(other.pool_), buffer_(std::move(other.buffer_))
+        explicit ScratchArena(size_t capacity = 0)
         {
-            other.pool_ = nullptr;
-        }
-
-        PooledBuffer &operator=(PooledBuffer &&other) noexcept
-        {
-            if (this != &other)
+            if (capacity > 0)
             {
-                release();
-                pool_ = other.pool_;
-                buffer_ = std::move(other.buffer_);
-                other.pool_ = nullptr;
+                block_ = make_aligned_array<u8>(capacity, CACHE_LINE_SIZE);
+                capacity_ = capacity;
             }
-            return *this;
         }
 
-        ~PooledBuffer() { release(); }
+        ScratchArena(ScratchArena &&) noexcept = default;
+        ScratchArena &operator=(ScratchArena &&) noexcept = default;
+        ScratchArena(const ScratchArena &) = delete;
+        ScratchArena &operator=(const ScratchArena &) = delete;
 
-        PooledBuffer(const PooledBuffer &) = delete;
-        PooledBuffer &operator=(const PooledBuffer &) = delete;
-
-        void release()
+        /**
+         * Uninitialised storage for count objects, valid until reset().
+         */
+        template <typename T>
+        [[nodiscard]] T *allocate(size_t count, size_t alignment = alignof(T))
         {
-            if (pool_ && buffer_)
-            {
-                pool_->release(std::move(buffer_));
-                buffer_.reset();
-            }
+            static_assert(std::is_trivially_destructible_v<T>, "arena memory is dropped without destructors");
+            return reinterpret_cast<T *>(allocate_bytes(count * sizeof(T), std::max(alignment, alignof(T))));
         }
 
-        [[nodiscard]] FrameBufferPool::Buffer *get() const noexcept
+        /**
+         * @param alignment Power of two, at most CACHE_LINE_SIZE
+         */
+        [[nodiscard]] u8 *allocate_bytes(size_t bytes, size_t alignment = CACHE_LINE_SIZE)
         {
-            return buffer_.get();
-        }
+            const size_t offset = (used_ + alignment - 1) & ~(alignment - 1);
+            used_ = offset + bytes;
+            peak_ = std::max(peak_, used_);
+            if (used_ <= capacity_)
+            {
+                return block_.get() + offset;
+            }
 
-        [[nodiscard]] FrameBufferPool::Buffer *operator->() const noexcept
-        {
-            return buffer_.get();
+            // Overflow: heap until the next reset() grows the block
+            overflow_.push_back(make_aligned_array<u8>(std::max<size_t>(bytes, 1), CACHE_LINE_SIZE));
+            return overflow_.back().get();
         }
 
-        [[nodiscard]] FrameBufferPool::BufferPtr shared() const noexcept
+        /**
+         * Release everything allocated since the last reset().
+         */
+        void reset()
         {
-            return buffer_;
+            if (peak_ > capacity_)
+            {
+                overflow_.clear();
+                block_ = make_aligned_array<u8>(peak_, CACHE_LINE_SIZE);
+                capacity_ = peak_;
+            }
+            used_ = 0;
+            peak_ = 0;
         }
 
-        [[nodiscard]] explicit operator bool() const noexcept
-        {
-            return buffer_ != nullptr;
-        }
+        [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+        [[nodiscard]] size_t used() const noexcept { return used_; }
 
     private:
-        FrameBufferPool *pool_;
-        FrameBufferPool::BufferPtr buffer_;
+        AlignedPtr<u8> block_;
+        size_t capacity_ = 0;
+        size_t used_ = 0; // Bytes handed out, including alignment and overflow
+        size_t peak_ = 0;
+        std::vector<AlignedPtr<u8>> overflow_;
     };
 
     /**
      * Compressed frame buffer for encoded data.
+     * Encoders write straight into data[0..capacity) and set the used length,
+     * so the buffer that leaves the encoder is the one that goes on the wire.
      */
     struct CompressedFrame
     {
-        std::vector<u8> data;
+        AlignedPtr<u8> data;
+        size_t capacity;
+        size_t length;
         u32 width;
         u32 height;
         u64 timestamp;
         u32 frame_id;
         f32 encode_time_ms;
+        bool delta; // Patch on top of earlier frames (TILES); unusable after a drop
 
-        CompressedFrame() : width(0), height(0), timestamp(0), frame_id(0), encode_time_ms(0) {}
+        CompressedFrame() : capacity(0), length(0), width(0), height(0), timestamp(0), frame_id(0), encode_time_ms(0), delta(false) {}
 
+        /**
+         * Ensure at least cap bytes are available.
+         * Contents are not preserved when the buffer has to grow.
+         */
         void reserve(size_t cap)
         {
-            if (data.capacity() < cap)
+            if (cap > capacity)
             {
-                data.reserve(cap);
+                data = make_aligned_array<u8>(cap, CACHE_LINE_SIZE);
+                capacity = cap;
             }
         }
 
         void clear()
         {
-            data.clear();
+            length = 0;
             encode_time_ms = 0;
+            delta = false;
         }
 
-        [[nodiscard]] size_t size() const noexcept { return data.size(); }
-        [[nodiscard]] const u8 *ptr() const noexcept { return data.data(); }
+        [[nodiscard]] size_t size() const noexcept { return length; }
+        [[nodiscard]] const u8 *ptr() const noexcept { return data.get(); }
+        [[nodiscard]] u8 *ptr() noexcept { return data.get(); }
     };
 
-    using CompressedFramePtr = std::shared_ptr<CompressedFrame>;
+    using CompressedFramePtr = PoolPtr<CompressedFrame>;
 
     /**
      * Pool for compressed frames.
+     * A frame handed out by acquire() returns to the pool when its last
+     * handle is dropped (typically the last client write completing), so a
+     * single buffer can be shared by the encoder and every session.
+     * Sessions may keep frames after the pool itself is gone.
+     *
+     * pool_size frames are reserved up front and up to max_growth more on
+     * first use once the rest are out; past that acquire() returns nullptr
+     * and the frame should be dropped. Frames keep the size of the largest
+     * encode they have held.
      */
     class CompressedFramePool
     {
     public:
-        explicit CompressedFramePool(size_t reserve_size = 512 * 1024, size_t pool_size = 8)
-            : reserve_size_(reserve_size), pool_size_(pool_size)
+        // Default growth covers one stalled session's full write queue
+        static constexpr size_t DEFAULT_GROWTH = 16;
+
+        explicit CompressedFramePool(size_t reserve_size = 512 * 1024, size_t pool_size = 8,
+                                     size_t max_growth = DEFAULT_GROWTH)
+            : reserve_size_(reserve_size),
+              slots_(SlotPool<CompressedFrame>::create(
+                  pool_size + max_growth, [reserve_size, max_growth, index = size_t{0}](CompressedFrame &frame) mutable
+                  {
+                      // Growth slots take the low indices, popped last
+                      if (index++ >= max_growth)
+                          frame.reserve(reserve_size); }))
         {
-            for (size_t i = 0; i < pool_size; ++i)
-            {
-                auto frame = std::make_shared<CompressedFrame>();
-                frame->reserve(reserve_size);
-                free_frames_.push(std::move(frame));
-            }
         }
 
+        ~CompressedFramePool() { slots_->destroy(); }
+
+        CompressedFramePool(const CompressedFramePool &) = delete;
+        CompressedFramePool &operator=(const CompressedFramePool &) = delete;
+
+        /**
+         * Reservation for frames from a capture size class: about 1/32 of
+         * the raw frame (1 MB at 4K), at least 256 KB.
+         */
+        [[nodiscard]] static size_t reserve_for(size_t frame_bytes) noexcept
+        {
+            return std::max<size_t>(256 * 1024, frame_bytes / 32);
+        }
+
+        /**
+         * @return nullptr if every frame is in use and growth is used up
+         */
         [[nodiscard]] CompressedFramePtr acquire()
         {
-            std::lock_guard lock(mutex_);
-            if (free_frames_.empty())
+            CompressedFramePtr frame = slots_->try_acquire();
+            if (!frame)
             {
-                auto frame = std::make_shared<CompressedFrame>();
-                frame->reserve(reserve_size_);
+                exhausted_.fetch_add(1, std::memory_order_relaxed);
                 return frame;
             }
-            auto frame = free_frames_.top();
-            free_frames_.pop();
+            // Growth slot on first use, or a larger capture size class (avoid in hot path)
+            frame->reserve(reserve_size_.load(std::memory_order_relaxed));
             frame->clear();
             return frame;
         }
 
-        void release(CompressedFramePtr frame)
-        {
-            if (!frame)
-                return;
-            std::lock_guard lock(mutex_);
-            if (free_frames_.size() < pool_size_ * 2)
-            {
-                frame->clear();
-                free_frames_.push(std::move(frame));
-            }
-        }
+        /**
+         * Reservation for frames from now on; frames already larger keep their memory.
+         */
+        void set_reserve_size(size_t bytes) noexcept { reserve_size_.store(bytes, std::memory_order_relaxed); }
+
+        /**
+         * Get number of free frames.
+         */
+        [[nodiscard]] size_t free_count() const noexcept { return slots_->free_count(); }
+
+        /**
+         * acquire() calls that found every frame in use.
+         */
+        [[nodiscard]] u64 exhausted() const noexcept { return exhausted_.load(std::memory_order_relaxed); }
 
     private:
-        size_t reserve_size_;
-        size_t pool_size_;
-        std::stack<CompressedFramePtr> free_frames_;
-        mutable std::mutex mutex_;
+        std::atomic<size_t> reserve_size_;
+        SlotPool<CompressedFrame> *slots_; // Outlives this pool while frames are out
+        std::atomic<u64> exhausted_{0};
     };
 
 } // namespace vrs
@@ -0,0 +1,161 @@
+#pragma once
+/**
+ * VR Streamer - Reorder Buffer
+ * Restores sequence order for work that completes out of order, such as
+ * frames encoded concurrently by several workers.
+ */
+
+#include "common.hpp"
+
+namespace vrs
+{
+
+    /**
+     * Sequence-numbered reorder buffer.
+     * Producers complete() every sequence number exactly once, in any order;
+     * items come out of the emit callback in sequence order. An empty item
+     * (T{} == false) marks a sequence number that produced nothing.
+     *
+     * Items that are already superseded when their turn comes (a later item
+     * is ready in the same drain) are dropped if the caller marked them
+     * droppable, since sending both back to back only queues stale data.
+     *
+     * Template parameters:
+     *   T - Nullable handle (e.g. std::shared_ptr)
+     */
+    template <typename T>
+    class ReorderBuffer
+    {
+    public:
+        /**
+         * @param capacity Maximum sequence numbers in flight (rounded up to a power of 2)
+         */
+        explicit ReorderBuffer(size_t capacity)
+            : slots_(next_power_of_2(std::max<size_t>(capacity, 2))),
+              mask_(slots_.size() - 1)
+        {
+        }
+
+        ReorderBuffer(const ReorderBuffer &) = delete;
+        ReorderBuffer &operator=(const ReorderBuffer &) = delete;
+
+        /**
+         * Hand in the result for seq and emit everything that is now in order.
+         * emit(T&&) runs under the buffer lock, so calls never interleave.
+         * @return Number of items dropped as superseded
+         */
+        template <typename Emit>
+        u32 complete(u64 seq, T item, bool droppable, Emit &&emit)
+        {
+            std::lock_guard lock(mutex_);
+
+            if (seq < next_)
+            {
+                // Skipped past already (see below): too late to be useful
+                return 0;
+            }
+
+            if (seq - next_ > mask_)
+            {
+                // More in flight than the buffer holds: give up on the oldest
+                // entries rather than stall, emitting whatever is ready
+                while (seq - next_ > mask_)
+                {
+                    Slot &slot = slots_[next_ & mask_];
+                    if (slot.ready && slot.item)
+                    {
+                        emit(std::move(slot.item));
+                    }
+                    slot = Slot{};
+                    ++next_;
+                }
+            }
+
+            Slot &slot = slots_[seq & mask_];
+            slot.item = std::move(item);
+            slot.droppable = droppable;
+            slot.ready = true;
+
+            // Find the end of the ready run starting at next_
+            u64 end = next_;
+            u64 newest = UINT64_MAX; // Last non-empty item in the run
+            while (slots_[end & mask_].ready && end - next_ <= mask_)
+            {
+                if (slots_[end & mask_].item)
+                {
+                    newest = end;
+                }
+                ++end;
+            }
+
+            u32 dropped = 0;
+            for (; next_ < end; ++next_)
+            {
+                Slot &ready = slots_[next_ & mask_];
+                if (ready.item)
+                {
+                    if (next_ != newest && ready.droppable)
+                    {
+                        ++dropped;
+                    }
+                    else
+                    {
+                        emit(std::move(ready.item));
+                    }
+                }
+                ready = Slot{};
+            }
+
+            return dropped;
+        }
+
+        /**
+         * Emit an extra item that belongs right after seq (e.g. a re-encode of
+         * it), but only if nothing later has been emitted or is waiting.
+         * @return true if item was emitted
+         */
+        template <typename Emit>
+        bool emit_if_current(u64 seq, T item, Emit &&emit)
+        {
+            std::lock_guard lock(mutex_);
+            if (next_ != seq + 1)
+            {
+                return false;
+            }
+
+            for (u64 i = next_; i - next_ <= mask_; ++i)
+            {
+                if (slots_[i & mask_].ready)
+                {
+                    return false;
+                }
+            }
+
+            emit(std::move(item));
+            return true;
+        }
+
+        /**
+         * Next sequence number waiting to be emitted.
+         */
+        [[nodiscard]] u64 next_sequence() const
+        {
+            std::lock_guard lock(mutex_);
+            return next_;
+        }
+
+    private:
+        struct Slot
+        {
+            T item{};
+            bool droppable = false;
+            bool ready = false;
+        };
+
+        std::vector<Slot> slots_;
+        const u64 mask_;
+        u64 next_ = 0;
+        mutable std::mutex mutex_;
+    };
+
+} // namespace vrs
@@ -0,0 +1,96 @@
+#pragma once
+/**
+ * VR Streamer - Snapshot Cell
+ * Read-copy-update for settings: writers publish a new immutable copy and
+ * each reader switches to it at a point of its choosing (a frame boundary),
+ * so nothing ever sees a half-applied change.
+ */
+
+#include "common.hpp"
+
+namespace vrs
+{
+
+    /**
+     * Latest immutable T, replaced whole by publish() or update().
+     * A reader holds its own Snapshot plus the version it was taken at;
+     * refresh() is a single atomic load while nothing has changed. A
+     * replaced copy is freed when the last reader holding it moves on.
+     */
+    template <typename T>
+    class SnapshotCell
+    {
+    public:
+        using Snapshot = std::shared_ptr<const T>;
+
+        explicit SnapshotCell(T initial = T{})
+            : current_(std::make_shared<const T>(std::move(initial)))
+        {
+        }
+
+        SnapshotCell(const SnapshotCell &) = delete;
+        SnapshotCell &operator=(const SnapshotCell &) = delete;
+
+        /**
+         * Replace the value (any thread).
+         */
+        void publish(T value)
+        {
+            auto next = std::make_shared<const T>(std::move(value));
+            std::lock_guard lock(write_mutex_);
+            store(std::move(next));
+        }
+
+        /**
+         * Publish an edited copy of the latest value (any thread). Writers
+         * are serialised, so concurrent edits never drop each other.
+         * @return The value published
+         */
+        template <typename Edit>
+        T update(Edit &&edit)
+        {
+            std::lock_guard lock(write_mutex_);
+            T value = *current_.load(std::memory_order_acquire);
+            edit(value);
+            store(std::make_shared<const T>(value));
+            return value;
+        }
+
+        [[nodiscard]] Snapshot load() const noexcept { return current_.load(std::memory_order_acquire); }
+
+        /**
+         * Bumped by every publish; starts at 1.
+         */
+        [[nodiscard]] u64 version() const noexcept { return version_.load(std::memory_order_acquire); }
+
+        /**
+         * Move snapshot to the latest value if it changed since seen
+         * (seen = 0 always loads).
+         * @return true if snapshot was replaced
+         */
+        bool refresh(Snapshot &snapshot, u64 &seen) const
+        {
+            const u64 latest = version();
+            if (latest == seen)
+            {
+                return false;
+            }
+            // publish() stores the value before bumping the version, so this is at least as new
+            snapshot = load();
+            seen = latest;
+            return true;
+        }
+
+    private:
+        void store(Snapshot next)
+        {
+            current_.store(std::move(next), std::memory_order_release);
+            version_.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        std::atomic<Snapshot> current_;
+        std::atomic<u64> version_{1};
+        std::mutex write_mutex_;
+    };
+
+} // namespace vrs
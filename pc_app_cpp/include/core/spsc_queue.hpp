@@ -100,6 +100,77 @@ namespace vrs
             return true;
         }
 
+        /**
+         * try_push() that wakes a consumer blocked in pop_wait() (producer only).
+         */
+        [[nodiscard]] bool push_notify(T &&item) noexcept
+        {
+            if (!try_push(std::move(item)))
+            {
+                return false;
+            }
+            notify_consumer();
+            return true;
+        }
+
+        [[nodiscard]] bool push_notify(const T &item) noexcept
+        {
+            if (!try_push(item))
+            {
+                return false;
+            }
+            notify_consumer();
+            return true;
+        }
+
+        /**
+         * Pop, blocking while the queue is empty (consumer only). Spins
+         * for a while first, then sleeps on a futex (std::atomic::wait)
+         * until push_notify() or close(). The spin adapts: it grows while
+         * items turn up during it and shrinks each time the consumer has
+         * to sleep, so a 60 fps stream settles on a few microseconds.
+         * @return false if nothing was queued after close()
+         */
+        [[nodiscard]] bool pop_wait(T &item) noexcept
+        {
+            for (u32 round = 0; round < spin_rounds_; ++round)
+            {
+                if (try_pop(item))
+                {
+                    spin_rounds_ = std::min(spin_rounds_ * 2, MAX_SPIN_ROUNDS);
+                    return true;
+                }
+                spin_wait(16);
+            }
+            spin_rounds_ = std::max(spin_rounds_ / 2, MIN_SPIN_ROUNDS);
+
+            // Read before closed_: a close() after this changes signal_ and ends the wait
+            const u32 epoch = signal_.load(std::memory_order_seq_cst);
+            waiting_.store(true, std::memory_order_relaxed);
+            // Pairs with the fence in notify_consumer(): either it sees waiting_ or we see its item
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const bool popped = try_pop(item);
+            if (popped || closed_.load(std::memory_order_seq_cst))
+            {
+                waiting_.store(false, std::memory_order_relaxed);
+                return popped;
+            }
+            signal_.wait(epoch, std::memory_order_acquire);
+            waiting_.store(false, std::memory_order_relaxed);
+            return try_pop(item);
+        }
+
+        /**
+         * Stop pop_wait() from blocking, now and from then on, so the
+         * consumer can see its shutdown flag (any thread).
+         */
+        void close() noexcept
+        {
+            closed_.store(true, std::memory_order_seq_cst);
+            signal_.fetch_add(1, std::memory_order_seq_cst);
+            signal_.notify_all();
+        }
+
         /**
          * Peek at the front element without removing (consumer only).
          */
@@ -153,9 +224,26 @@ namespace vrs
         }
 
     private:
+        static constexpr u32 MIN_SPIN_ROUNDS = 4;
+        static constexpr u32 MAX_SPIN_ROUNDS = 256;
+
+        void notify_consumer() noexcept
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiting_.load(std::memory_order_relaxed))
+            {
+                signal_.fetch_add(1, std::memory_order_release);
+                signal_.notify_one();
+            }
+        }
+
         // Separate head and tail into different cache lines to avoid false sharing
         alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_;
+        u32 spin_rounds_ = 64; // Consumer only
+        std::atomic<bool> waiting_{false};
         alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_;
+        alignas(CACHE_LINE_SIZE) std::atomic<u32> signal_{0}; // Bumped to wake the consumer
+        std::atomic<bool> closed_{false};
         alignas(CACHE_LINE_SIZE) std::array<T, N> storage_;
     };
 
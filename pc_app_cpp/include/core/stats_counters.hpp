@@ -0,0 +1,141 @@
+#pragma once
+/**
+ * VR Streamer - Statistics Counters
+ * Per-frame counters that hot threads bump without locks, and a seqlock
+ * that publishes a consistent copy of a stats struct to readers that never
+ * block the writer.
+ */
+
+#include "common.hpp"
+
+namespace vrs
+{
+
+    /**
+     * Counter split over cache-line-padded shards. Each thread adds to its
+     * own shard with a relaxed atomic, so threads bumping the same counter
+     * (e.g. network IO threads) do not bounce one cache line between cores.
+     * load() sums the shards: exact once writers are quiet, otherwise a
+     * value some writes may not have reached yet.
+     */
+    class ShardedCounter
+    {
+    public:
+        void add(u64 count = 1) noexcept
+        {
+            shards_[shard_index()].value.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] u64 load() const noexcept
+        {
+            u64 total = 0;
+            for (const auto &shard : shards_)
+            {
+                total += shard.value.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+
+    private:
+        static constexpr size_t SHARDS = 16;
+
+        struct alignas(CACHE_LINE_SIZE) Shard
+        {
+            std::atomic<u64> value{0};
+        };
+
+        /**
+         * Threads take shards round-robin on first use.
+         */
+        [[nodiscard]] static size_t shard_index() noexcept
+        {
+            static std::atomic<size_t> next{0};
+            thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+            return index;
+        }
+
+        std::array<Shard, SHARDS> shards_;
+    };
+
+    /**
+     * Sequence lock around a trivially copyable struct.
+     * store() makes the sequence odd, writes the words and makes it even
+     * again; load() copies the words and retries if the sequence moved.
+     * Readers never delay the writer, so the stats thread and GUI can take
+     * snapshots as often as they like. Concurrent store() calls queue on the
+     * sequence, which only matters if several threads publish.
+     *
+     * The words are relaxed atomics so torn reads are retried, not undefined.
+     */
+    template <typename T>
+    class SeqLock
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "SeqLock copies T word by word");
+
+    public:
+        SeqLock() noexcept { store(T{}); }
+
+        SeqLock(const SeqLock &) = delete;
+        SeqLock &operator=(const SeqLock &) = delete;
+
+        void store(const T &value) noexcept
+        {
+            u64 sequence = 0;
+            while (true)
+            {
+                sequence = sequence_.load(std::memory_order_relaxed);
+                if (!(sequence & 1) && sequence_.compare_exchange_weak(sequence, sequence + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+                spin_wait(16);
+            }
+            // Odd sequence visible before any word changes
+            std::atomic_thread_fence(std::memory_order_release);
+
+            std::array<u64, WORDS> words{};
+            std::memcpy(words.data(), &value, sizeof(T));
+            for (size_t i = 0; i < WORDS; ++i)
+            {
+                words_[i].store(words[i], std::memory_order_relaxed);
+            }
+
+            sequence_.store(sequence + 2, std::memory_order_release);
+        }
+
+        [[nodiscard]] T load() const noexcept
+        {
+            std::array<u64, WORDS> words;
+            while (true)
+            {
+                const u64 before = sequence_.load(std::memory_order_acquire);
+                if (before & 1)
+                {
+                    spin_wait(16); // Store in progress
+                    continue;
+                }
+                for (size_t i = 0; i < WORDS; ++i)
+                {
+                    words[i] = words_[i].load(std::memory_order_relaxed);
+                }
+                // Word loads complete before the sequence is checked again
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence_.load(std::memory_order_relaxed) == before)
+                {
+                    break;
+                }
+            }
+
+            T value;
+            std::memcpy(static_cast<void *>(&value), words.data(), sizeof(T));
+            return value;
+        }
+
+    private:
+        static constexpr size_t WORDS = (sizeof(T) + sizeof(u64) - 1) / sizeof(u64);
+
+        alignas(CACHE_LINE_SIZE) std::atomic<u64> sequence_{0};
+        std::array<std::atomic<u64>, WORDS> words_{};
+    };
+
+} // namespace vrs
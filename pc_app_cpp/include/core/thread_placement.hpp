@@ -0,0 +1,61 @@
+#pragma once
+/**
+ * VR Streamer - Thread Placement
+ * Names every pipeline thread and gives it its role's CPU set and priority
+ * (ThreadConfig), so encode does not share a core with IO or background
+ * work. Threads place themselves when they start.
+ */
+
+#include "common.hpp"
+
+namespace vrs
+{
+
+    struct ThreadConfig;
+
+    enum class ThreadRole : u8
+    {
+        CAPTURE,    // Capture loop
+        ENCODE,     // Encode workers and the shared pool (stereo rows, strips, eyes)
+        NETWORK,    // WebSocket and HTTP IO
+        BACKGROUND, // Refinement, Huffman learning, stats
+        COUNT
+    };
+
+    /**
+     * Process-wide placement policy. configure() runs once before the
+     * pipeline starts; threads started without it are only named and, for
+     * BACKGROUND, niced.
+     *
+     * Linux threads inherit their creator's CPU set and scheduling policy,
+     * so apply() always sets both: an empty core set means every CPU the
+     * process started with, and only CAPTURE/ENCODE keep real-time priority.
+     */
+    class ThreadPlacement
+    {
+    public:
+        /**
+         * Resolve the core sets (SMT siblings dropped for CAPTURE/ENCODE
+         * with avoid_smt) and log the plan.
+         */
+        static void configure(const ThreadConfig &config);
+
+        /**
+         * Name the calling thread and apply its role's CPU set and priority.
+         * @param name Up to 15 characters are kept on Linux
+         * @param report Log the placement achieved (off for short-lived threads)
+         */
+        static void apply(ThreadRole role, std::string_view name, bool report = true);
+
+        /**
+         * CPUs of a list such as "0-3,8"; malformed entries are skipped.
+         */
+        [[nodiscard]] static std::vector<u32> parse_cpu_list(std::string_view list);
+
+        /**
+         * Inverse of parse_cpu_list(): sorted CPUs with runs collapsed.
+         */
+        [[nodiscard]] static std::string format_cpu_list(const std::vector<u32> &cpus);
+    };
+
+} // namespace vrs
@@ -1,51 +1,98 @@
 #pragma once
 /**
  * VR Streamer - Thread Pool
- * High-performance thread pool with work stealing for parallel encoding.
+ * Work-stealing pool with priority lanes. The frame kernels (stereo row
+ * bands, JPEG strips, the two eyes), refinement and Huffman learning share
+ * one process-wide set of workers through get_global_thread_pool().
  */
 
 #include "common.hpp"
-#include <queue>
+#include "thread_placement.hpp"
+#include <functional>
 #include <future>
 
 namespace vrs
 {
 
     /**
-     * Modern thread pool implementation with minimal overhead.
+     * Queue lane of a task. Idle workers take from the highest lane that
+     * has work, so a burst of refinement or background tasks never delays
+     * the row bands of the next live frame. A pool with background workers
+     * keeps REFINE and BACKGROUND off its ENCODE-placed threads.
+     */
+    enum class TaskPriority : u8
+    {
+        ENCODE,     // Live frame work: stereo rows, JPEG strips, eyes
+        REFINE,     // Re-encodes of a static scene
+        BACKGROUND, // Huffman learning, stats
+        COUNT
+    };
+
+    /**
+     * Each worker owns a deque per lane. Tasks submitted from a worker go on
+     * its own deque and it takes the newest first (still cache-warm); other
+     * threads' tasks are dealt round-robin, and an idle worker steals the
+     * oldest task of another worker's deque. Workers spin briefly (about
+     * 0.1 ms) before sleeping, so back-to-back row loops find them awake.
+     *
+     * Background workers, if any, are placed as ThreadRole::BACKGROUND and
+     * take only the REFINE and BACKGROUND lanes; the others then take only
+     * ENCODE. Without them every worker takes every lane.
+     *
+     * Deques only grow, so a steady task rate does not allocate once warm.
      */
     class ThreadPool
     {
     public:
-        explicit ThreadPool(size_t num_threads = 0) : stop_(false)
+        /**
+         * @param role Placement of the worker threads, named name-0, name-1, ...
+         * @param background_threads Extra BACKGROUND-placed workers for the
+         *        REFINE and BACKGROUND lanes, named name-bg0, ...
+         */
+        explicit ThreadPool(size_t num_threads = 0, ThreadRole role = ThreadRole::ENCODE,
+                            std::string_view name = "pool", size_t background_threads = 0)
+            : foreground_(num_threads), split_(background_threads > 0)
         {
-            if (num_threads == 0)
+            if (foreground_ == 0)
+            {
+                foreground_ = std::thread::hardware_concurrency();
+                if (foreground_ == 0)
+                    foreground_ = 4;
+            }
+
+            const size_t total = foreground_ + background_threads;
+            workers_.reserve(total);
+            for (size_t i = 0; i < total; ++i)
             {
-                num_threads = std::thread::hardware_concurrency();
-                if (num_threads == 0)
-                    num_threads = 4;
+                workers_.push_back(std::make_unique<Worker>());
             }
 
-            workers_.reserve(num_threads);
-            for (size_t i = 0; i < num_threads; ++i)
+            threads_.reserve(total);
+            for (size_t i = 0; i < total; ++i)
             {
-                workers_.emplace_back([this]
-                                      { worker_loop(); });
+                const bool background = i >= foreground_;
+                threads_.emplace_back([this, i, role = background ? ThreadRole::BACKGROUND : role,
+                                       name = background ? std::format("{}-bg{}", name, i - foreground_)
+                                                         : std::format("{}-{}", name, i)]
+                                      {
+                    ThreadPlacement::apply(role, name);
+                    worker_loop(i); });
             }
         }
 
         ~ThreadPool()
         {
+            stop_.store(true);
+            for (auto &group : groups_)
             {
-                std::lock_guard lock(mutex_);
-                stop_ = true;
+                group.wake.fetch_add(1);
+                group.wake.notify_all();
             }
-            cv_.notify_all();
-            for (auto &worker : workers_)
+            for (auto &thread : threads_)
             {
-                if (worker.joinable())
+                if (thread.joinable())
                 {
-                    worker.join();
+                    thread.join();
                 }
             }
         }
@@ -53,6 +100,13 @@ namespace vrs
         ThreadPool(const ThreadPool &) = delete;
         ThreadPool &operator=(const ThreadPool &) = delete;
 
+        /**
+         * Lane for work the calling thread submits without naming one
+         * (ENCODE unless set). Set once by threads such as refinement.
+         */
+        static void set_thread_priority(TaskPriority priority) noexcept { thread_priority_ = priority; }
+        [[nodiscard]] static TaskPriority thread_priority() noexcept { return thread_priority_; }
+
         /**
          * Submit a task and get a future for the result.
          */
@@ -66,88 +120,400 @@ namespace vrs
                 std::bind(std::forward<F>(f), std::forward<Args>(args)...));
 
             std::future<ReturnType> result = task->get_future();
+            if (!push([task]()
+                      { (*task)(); },
+                      thread_priority()))
+            {
+                throw std::runtime_error("ThreadPool stopped");
+            }
+            return result;
+        }
 
+        /**
+         * Submit a task without caring about the result.
+         * Does not allocate once the deques have grown if f fits
+         * std::function's inline storage (a lambda capturing up to two pointers).
+         * @return false if the pool is stopping and f was dropped
+         */
+        template <typename F>
+        bool submit_detached(F &&f, TaskPriority priority = thread_priority())
+        {
+            return push(Task(std::forward<F>(f)), priority);
+        }
+
+        /**
+         * Fork-join without allocating: run task(item) for every item in
+         * [0, items) on the calling thread and up to helpers pool threads,
+         * which claim items in order, and return once the last item has
+         * finished. A helper that starts after every item is claimed (stuck
+         * behind another frame's work, say) finds nothing to do and exits
+         * without being waited on; the claim state it reads belongs to the
+         * pool, not to this call. Called from one of this pool's workers,
+         * or with every join slot held by late helpers, the items run on
+         * the calling thread alone.
+         */
+        template <typename F>
+        void run_with_helpers(size_t helpers, size_t items, F &task, TaskPriority priority = thread_priority())
+        {
+            helpers = std::min({helpers, items > 0 ? items - 1 : 0, workers_for(priority)});
+            Join *join = (helpers > 0 && current_pool_ != this) ? acquire_join() : nullptr;
+            if (!join)
             {
-                std::lock_guard lock(mutex_);
-                if (stop_)
+                for (size_t item = 0; item < items; ++item)
                 {
-                    throw std::runtime_error("ThreadPool stopped");
+                    task(item);
                 }
-                tasks_.emplace([task]()
-                               { (*task)(); });
+                return;
             }
 
-            cv_.notify_one();
-            return result;
+            join->next.store(0, std::memory_order_relaxed);
+            join->done.store(0, std::memory_order_relaxed);
+            join->items = items;
+            join->task = &task;
+            join->run = [](void *task, size_t item)
+            { (*static_cast<F *>(task))(item); };
+
+            // Two pointers: stored inline by std::function
+            for (size_t i = 0; i < helpers; ++i)
+            {
+                join->users.fetch_add(1, std::memory_order_relaxed);
+                if (!submit_detached([this, join]
+                                     { run_items(*join);
+                                       release_join(*join); },
+                                     priority))
+                {
+                    join->users.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+
+            run_items(*join);
+
+            size_t done;
+            while ((done = join->done.load(std::memory_order_acquire)) < items)
+            {
+                join->done.wait(done, std::memory_order_acquire);
+            }
+            release_join(*join);
         }
 
         /**
-         * Submit a task without caring about the result.
+         * Run body(first, last) over the row bands [begin + k * grain, + grain)
+         * of [begin, end), on the calling thread and the pool. Band edges
+         * depend only on the range and grain, never on thread count or
+         * timing; threads claim bands in order from a shared counter, as
+         * OpenMP schedule(dynamic, grain) would. Does not allocate.
          */
-        template <typename F>
-        void submit_detached(F &&f)
+        template <typename Body>
+        void parallel_for(u32 begin, u32 end, u32 grain, Body &&body, TaskPriority priority = thread_priority())
         {
+            if (end <= begin)
+                return;
+            grain = std::max<u32>(grain, 1);
+            const u32 bands = (end - begin - 1) / grain + 1;
+
+            auto run_band = [&](size_t band)
             {
-                std::lock_guard lock(mutex_);
-                if (stop_)
-                    return;
-                tasks_.emplace(std::forward<F>(f));
+                const u32 first = begin + static_cast<u32>(band) * grain;
+                body(first, std::min(end, first + grain));
+            };
+            run_with_helpers(bands - 1, bands, run_band, priority);
+        }
+
+        /**
+         * Get the number of worker threads that take ENCODE tasks.
+         */
+        [[nodiscard]] size_t size() const noexcept { return foreground_; }
+
+        /**
+         * Get approximate number of queued tasks.
+         */
+        [[nodiscard]] size_t pending() const noexcept { return queued_.load(std::memory_order_relaxed); }
+
+    private:
+        using Task = std::function<void()>;
+
+        static constexpr size_t LANES = static_cast<size_t>(TaskPriority::COUNT);
+        static constexpr u32 SPIN_ROUNDS = 256; // Of spin_wait(16) before sleeping
+        static constexpr size_t JOIN_SLOTS = 64;
+
+        /**
+         * Double-ended ring of tasks. Starts with room for a few and only
+         * grows, so a steady task rate reuses its slots, even on a lane that
+         * sees one task a second on a different worker each time.
+         */
+        class TaskRing
+        {
+        public:
+            TaskRing() : slots_(INITIAL_SLOTS) {}
+
+            void push_back(Task &&task)
+            {
+                if (count_ == slots_.size())
+                {
+                    std::vector<Task> grown(slots_.size() * 2);
+                    for (size_t i = 0; i < count_; ++i)
+                    {
+                        grown[i] = std::move(slots_[(head_ + i) % slots_.size()]);
+                    }
+                    slots_ = std::move(grown);
+                    head_ = 0;
+                }
+                slots_[(head_ + count_) % slots_.size()] = std::move(task);
+                ++count_;
+            }
+
+            bool pop_back(Task &task)
+            {
+                if (count_ == 0)
+                    return false;
+                --count_;
+                take(slots_[(head_ + count_) % slots_.size()], task);
+                return true;
             }
-            cv_.notify_one();
+
+            bool pop_front(Task &task)
+            {
+                if (count_ == 0)
+                    return false;
+                take(slots_[head_], task);
+                head_ = (head_ + 1) % slots_.size();
+                --count_;
+                return true;
+            }
+
+        private:
+            static void take(Task &slot, Task &task)
+            {
+                task = std::move(slot);
+                slot = nullptr;
+            }
+
+            static constexpr size_t INITIAL_SLOTS = 16;
+
+            std::vector<Task> slots_; // count_ tasks from head_
+            size_t head_ = 0;
+            size_t count_ = 0;
+        };
+
+        struct alignas(CACHE_LINE_SIZE) Worker
+        {
+            std::mutex mutex;
+            std::array<TaskRing, LANES> lanes;
+        };
+
+        /**
+         * Workers that take the same lanes, and how to wake them.
+         */
+        struct alignas(CACHE_LINE_SIZE) Group
+        {
+            std::atomic<u32> sleepers{0};
+            std::atomic<u32> wake{0};
+        };
+
+        /**
+         * Claim state of one run_with_helpers call. Owned by the pool and
+         * reused once its caller and every helper it submitted are done.
+         */
+        struct alignas(CACHE_LINE_SIZE) Join
+        {
+            std::atomic<u32> users{0};   // Caller and helpers still to finish; 0 = free
+            std::atomic<size_t> next{0}; // Next item to claim
+            std::atomic<size_t> done{0}; // Items finished
+            size_t items = 0;
+            void *task = nullptr;
+            void (*run)(void *task, size_t item) = nullptr;
+        };
+
+        /**
+         * A free join slot, held by the caller, or nullptr if all are taken.
+         */
+        Join *acquire_join() noexcept
+        {
+            const size_t start = next_join_.fetch_add(1, std::memory_order_relaxed);
+            for (size_t i = 0; i < JOIN_SLOTS; ++i)
+            {
+                Join &join = joins_[(start + i) % JOIN_SLOTS];
+                u32 free = 0;
+                if (join.users.compare_exchange_strong(free, 1, std::memory_order_acquire, std::memory_order_relaxed))
+                    return &join;
+            }
+            return nullptr;
         }
 
+        static void release_join(Join &join) noexcept { join.users.fetch_sub(1, std::memory_order_acq_rel); }
+
         /**
-         * Get the number of worker threads.
+         * Claim and run items until none are left. Touches the caller's task
+         * only for an item it claimed, so only while the caller still waits.
          */
-        [[nodiscard]] size_t size() const noexcept { return workers_.size(); }
+        static void run_items(Join &join)
+        {
+            size_t item;
+            while ((item = join.next.fetch_add(1, std::memory_order_relaxed)) < join.items)
+            {
+                join.run(join.task, item);
+                if (join.done.fetch_add(1, std::memory_order_acq_rel) + 1 == join.items)
+                    join.done.notify_all(); // The slot outlives the caller: safe after it returns
+            }
+        }
+
+        static constexpr size_t ENCODE_LANE = static_cast<size_t>(TaskPriority::ENCODE);
+
+        [[nodiscard]] size_t group_of_lane(size_t lane) const noexcept { return split_ && lane != ENCODE_LANE ? 1 : 0; }
+        [[nodiscard]] size_t group_of_worker(size_t index) const noexcept { return index >= foreground_ ? 1 : 0; }
 
         /**
-         * Get approximate queue size.
+         * Lanes [first, last) taken by the workers of a group.
          */
-        [[nodiscard]] size_t pending() const
+        [[nodiscard]] std::pair<size_t, size_t> lanes_of(size_t group) const noexcept
         {
-            std::lock_guard lock(mutex_);
-            return tasks_.size();
+            if (!split_)
+                return {0, LANES};
+            return group == 0 ? std::pair<size_t, size_t>{0, ENCODE_LANE + 1} : std::pair<size_t, size_t>{ENCODE_LANE + 1, LANES};
         }
 
-    private:
-        void worker_loop()
+        [[nodiscard]] size_t workers_for(TaskPriority priority) const noexcept
         {
-            while (true)
+            return group_of_lane(static_cast<size_t>(priority)) == 0 ? foreground_ : workers_.size() - foreground_;
+        }
+
+        bool push(Task &&task, TaskPriority priority)
+        {
+            if (stop_.load(std::memory_order_acquire) || workers_.empty())
+                return false;
+
+            const size_t lane = static_cast<size_t>(priority);
+            const size_t target = current_pool_ == this
+                                      ? current_index_
+                                      : next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+            {
+                Worker &worker = *workers_[target];
+                std::lock_guard lock(worker.mutex);
+                worker.lanes[lane].push_back(std::move(task));
+                // Counted under the deque's lock, so a taker never sees the task before its count
+                lane_queued_[lane].fetch_add(1);
+                queued_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // Pairs with the sleeper's increment then check in worker_loop
+            Group &group = groups_[group_of_lane(lane)];
+            if (group.sleepers.load() > 0)
             {
-                std::function<void()> task;
+                group.wake.fetch_add(1);
+                group.wake.notify_one();
+            }
+            return true;
+        }
 
-                {
-                    std::unique_lock lock(mutex_);
-                    cv_.wait(lock, [this]
-                             { return stop_ || !tasks_.empty(); });
+        /**
+         * Next task for worker self from lanes [first, last): highest lane
+         * first, own deque newest first, then the oldest task of each other
+         * worker.
+         */
+        bool take(size_t self, size_t first, size_t last, Task &task)
+        {
+            for (size_t lane = first; lane < last; ++lane)
+            {
+                if (lane_queued_[lane].load(std::memory_order_relaxed) == 0)
+                    continue;
 
-                    if (stop_ && tasks_.empty())
+                for (size_t i = 0; i < workers_.size(); ++i)
+                {
+                    Worker &worker = *workers_[(self + i) % workers_.size()];
+                    std::lock_guard lock(worker.mutex);
+                    const bool found = i == 0 ? worker.lanes[lane].pop_back(task) : worker.lanes[lane].pop_front(task);
+                    if (found)
                     {
-                        return;
+                        lane_queued_[lane].fetch_sub(1, std::memory_order_relaxed);
+                        queued_.fetch_sub(1, std::memory_order_relaxed);
+                        return true;
                     }
+                }
+            }
+            return false;
+        }
+
+        void worker_loop(size_t index)
+        {
+            current_pool_ = this;
+            current_index_ = index;
+
+            const size_t group_index = group_of_worker(index);
+            const auto [first, last] = lanes_of(group_index);
+            Group &group = groups_[group_index];
+            if (group_index == 1)
+                thread_priority_ = TaskPriority::BACKGROUND;
+
+            u32 idle_rounds = 0;
+            while (true)
+            {
+                Task task;
+                if (take(index, first, last, task))
+                {
+                    task();
+                    idle_rounds = 0;
+                    continue;
+                }
 
-                    task = std::move(tasks_.front());
-                    tasks_.pop();
+                // Stops only once drained
+                if (stop_.load(std::memory_order_acquire))
+                {
+                    return;
+                }
+
+                if (++idle_rounds < SPIN_ROUNDS)
+                {
+                    spin_wait(16);
+                    continue;
                 }
 
-                task();
+                // Epoch first: a push after this read changes it, so wait() returns at once
+                const u32 epoch = group.wake.load();
+                group.sleepers.fetch_add(1);
+                if (queued_in(first, last) == 0 && !stop_.load())
+                {
+                    group.wake.wait(epoch);
+                }
+                group.sleepers.fetch_sub(1);
+                idle_rounds = 0;
+            }
+        }
+
+        [[nodiscard]] size_t queued_in(size_t first, size_t last) const noexcept
+        {
+            size_t queued = 0;
+            for (size_t lane = first; lane < last; ++lane)
+            {
+                queued += lane_queued_[lane].load();
             }
+            return queued;
         }
 
-        std::vector<std::thread> workers_;
-        std::queue<std::function<void()>> tasks_;
-        mutable std::mutex mutex_;
-        std::condition_variable cv_;
-        bool stop_;
+        size_t foreground_;  // Workers [0, foreground_) are placed by role, the rest BACKGROUND
+        bool split_;         // Background workers exist and own the REFINE and BACKGROUND lanes
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::vector<std::thread> threads_;
+        std::array<std::atomic<size_t>, LANES> lane_queued_{};
+        std::atomic<size_t> queued_{0};
+        std::atomic<size_t> next_worker_{0};
+        std::array<Group, 2> groups_; // Foreground, background
+        std::array<Join, JOIN_SLOTS> joins_;
+        std::atomic<size_t> next_join_{0};
+        std::atomic<bool> stop_{false};
+
+        static inline thread_local ThreadPool *current_pool_ = nullptr; // Pool the calling thread works for
+        static inline thread_local size_t current_index_ = 0;
+        static inline thread_local TaskPriority thread_priority_ = TaskPriority::ENCODE;
     };
 
     /**
-     * Global thread pool singleton.
+     * Process-wide pool: a pinned ENCODE worker for every CPU besides the
+     * calling thread for the stereo, strip and eye paths, and one
+     * BACKGROUND worker for refinement and Huffman learning.
      */
     inline ThreadPool &get_global_thread_pool()
     {
-        static ThreadPool pool;
+        static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1, ThreadRole::ENCODE, "worker", 1);
         return pool;
     }
 
@@ -0,0 +1,228 @@
+#pragma once
+/**
+ * VR Streamer - Frame-Parallel Encode Workers
+ * Several workers encode whole frames concurrently, each with its own
+ * VRFrameEncoder (and so its own JPEG handles and scratch buffers). Frames
+ * are dealt round-robin from the capture thread and a reorder buffer hands
+ * the results on in capture order. Rate control and dynamic resolution are
+ * shared: submit() picks each frame's quality and scale, and sizes and
+ * times are fed back in capture order.
+ *
+ * With refine_enabled the newest encoded capture is kept back, and a
+ * low-priority thread can re-encode it at refine_quality once the screen
+ * has stopped changing.
+ */
+
+#include "../core/common.hpp"
+#include "../core/config.hpp"
+#include "../core/memory_pool.hpp"
+#include "../core/reorder_buffer.hpp"
+#include "../core/snapshot_cell.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/stats_counters.hpp"
+#include "rate_controller.hpp"
+#include "resolution_controller.hpp"
+#include "stereo_processor.hpp"
+
+namespace vrs
+{
+
+    class EncodeWorkerPool
+    {
+    public:
+        /**
+         * Receives encoded frames in capture order (from a worker thread).
+         */
+        using FrameSink = std::function<void(CompressedFramePtr)>;
+
+        static constexpr u32 MAX_WORKERS = 16;
+
+        /**
+         * @param config Encoder settings shared by every worker
+         * @param compressed_pool Source of output frames
+         * @param sink Called with each frame that survives reordering
+         */
+        EncodeWorkerPool(
+            const EncoderConfig &config,
+            CompressedFramePool &compressed_pool,
+            FrameSink sink);
+        ~EncodeWorkerPool();
+
+        EncodeWorkerPool(const EncodeWorkerPool &) = delete;
+        EncodeWorkerPool &operator=(const EncodeWorkerPool &) = delete;
+
+        /**
+         * Workers to create for a configuration (encode_workers, 0 = auto).
+         */
+        [[nodiscard]] static u32 worker_count_for(const EncoderConfig &config);
+
+        /**
+         * Queue a captured frame (capture thread only).
+         * @return false if every active worker is busy; buffer is left untouched
+         */
+        bool submit(FrameBufferPool::BufferPtr &buffer);
+
+        /**
+         * Publish new settings (any thread). submit() attaches the latest
+         * settings to each frame, so the switch falls between two capture
+         * sequence numbers: every frame before it is encoded wholly with
+         * the old settings and every frame after with the new.
+         * TILES and H.264 frames build on the previous one from the same
+         * encoder, so those modes run on the first worker only.
+         */
+        void update_config(const EncoderConfig &config);
+
+        /**
+         * Make the next TILES/H.264 frame a keyframe.
+         */
+        void request_keyframe() noexcept;
+
+        /**
+         * Re-encode the newest frame at refine_quality on the refine thread
+         * (refine_enabled). Dropped if a newer frame is sent first.
+         */
+        void request_refinement();
+
+        /**
+         * Bytes-per-frame budget for rate control (0 = off). Used with
+         * frame_budget_auto; otherwise frame_budget_bytes applies.
+         */
+        void set_frame_budget(u32 bytes) noexcept;
+
+        /**
+         * Capture interval for dynamic_resolution. Frames are encoded
+         * active_workers() at a time, so each may take that many intervals.
+         */
+        void set_frame_interval(f64 ms) noexcept;
+
+        /**
+         * Stats of the most recently finished encode.
+         */
+        [[nodiscard]] VRFrameEncoder::Stats encoder_stats() const { return last_stats_.load(); }
+
+        [[nodiscard]] u32 worker_count() const noexcept { return static_cast<u32>(workers_.size()); }
+        [[nodiscard]] u32 active_workers() const noexcept { return active_.load(std::memory_order_relaxed); }
+
+        /**
+         * Frames encoded but dropped because a newer one was ready first.
+         */
+        [[nodiscard]] u64 frames_superseded() const noexcept { return superseded_.load(std::memory_order_relaxed); }
+
+        /**
+         * High-quality re-encodes of static frames that were sent.
+         */
+        [[nodiscard]] u64 frames_refined() const noexcept { return refined_.load(std::memory_order_relaxed); }
+
+    private:
+        using ConfigSnapshot = SnapshotCell<EncoderConfig>::Snapshot;
+
+        struct Job
+        {
+            FrameBufferPool::BufferPtr buffer;
+            u64 sequence = 0;
+            ConfigSnapshot config;                // Settings to encode with
+            VRFrameEncoder::FrameControl control; // Quality and scale picked for this frame
+        };
+
+        /**
+         * Encoded frame in the reorder buffer, with what the shared
+         * controllers learn from it once its turn comes.
+         */
+        struct Encoded
+        {
+            CompressedFramePtr frame;
+            u64 sequence = 0;
+            u32 quality = 0;       // Rate-controlled quality it was encoded at (0 = fixed)
+            f64 frame_time_ms = 0; // Stereo + encode time
+
+            explicit operator bool() const noexcept { return static_cast<bool>(frame); }
+        };
+
+        // One frame waiting per worker: capture drops rather than queueing stale frames
+        static constexpr size_t QUEUE_SIZE = 2;
+
+        struct Worker
+        {
+            std::unique_ptr<VRFrameEncoder> encoder;
+            ConfigSnapshot config; // Settings the encoder has
+            SPSCQueue<Job, QUEUE_SIZE> queue;
+            std::thread thread;
+        };
+
+        /**
+         * Per-worker settings: automatic strip threads are split between workers.
+         */
+        [[nodiscard]] EncoderConfig worker_config(const EncoderConfig &config) const;
+
+        /**
+         * Settings for the refine encoder: refine_quality, 4:4:4 if asked,
+         * no rate control, scaling or ROI.
+         */
+        [[nodiscard]] static EncoderConfig refine_config(const EncoderConfig &config);
+
+        /**
+         * Quality, budget and scale for the next frame (capture thread).
+         */
+        [[nodiscard]] VRFrameEncoder::FrameControl frame_control(const EncoderConfig &config);
+
+        /**
+         * Feed a frame to the controllers and pass it to the sink, in capture order.
+         */
+        void emit(Encoded &&encoded);
+
+        void worker_loop(Worker &worker);
+        void refine_loop();
+
+        /**
+         * Keep buffer as the refinement source if it is the newest so far,
+         * else drop it (back to its pool).
+         */
+        void retain(FrameBufferPool::BufferPtr &&buffer, u64 sequence);
+
+        CompressedFramePool &compressed_pool_;
+        FrameSink sink_;
+        SnapshotCell<EncoderConfig> config_;
+
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::atomic<u32> active_{1};
+        std::atomic<f64> frame_interval_ms_{0};
+        u32 next_worker_ = 0;   // Capture thread only
+        u64 next_sequence_ = 0; // Capture thread only
+        ConfigSnapshot submit_config_; // Capture thread only
+        u64 submit_config_version_ = 0;
+
+        // One rate and resolution controller for the stream: fed by emit(), read by submit()
+        std::mutex control_mutex_;
+        RateController rate_controller_;
+        u32 rate_base_quality_ = 0;
+        u32 rate_budget_ = 0;
+        u32 rate_min_quality_ = 0;
+        u32 rate_max_quality_ = 0;
+        u64 rate_reset_sequence_ = 0; // Earlier frames were encoded before the last reset
+        std::atomic<u32> frame_budget_{0};
+        ResolutionController resolution_controller_;
+        f32 resolution_base_ = 0; // downscale_factor the ladder was built for
+        f32 resolution_floor_ = 0;
+        bool resolution_dynamic_ = false;
+        u64 resolution_reset_sequence_ = 0;
+
+        ReorderBuffer<Encoded> reorder_;
+        std::atomic<u64> superseded_{0};
+
+        SeqLock<VRFrameEncoder::Stats> last_stats_; // Published by each worker after its encode
+
+        // Idle refinement
+        std::atomic<bool> refine_active_{false};
+        std::unique_ptr<VRFrameEncoder> refine_encoder_;
+        std::thread refine_thread_;
+        std::mutex refine_mutex_;
+        std::condition_variable refine_cv_;
+        FrameBufferPool::BufferPtr retained_; // Newest encoded capture (null while refining)
+        u64 retained_sequence_ = 0;
+        bool refine_requested_ = false;
+        std::atomic<u64> refined_{0};
+
+        std::atomic<bool> stop_{false};
+    };
+
+} // namespace vrs
@@ -0,0 +1,82 @@
+#pragma once
+/**
+ * VR Streamer - Software H.264 Encoder
+ * x264 in zerolatency mode for Method::H264: baseline profile, no B-frames,
+ * one frame in / one access unit out. Periodic intra refresh spreads intra
+ * blocks over h264_gop_length frames instead of sending IDR spikes; an IDR is
+ * only forced on request (new client, dropped frame).
+ *
+ * Each access unit is sent as one framed message (FrameType::H264) holding
+ * Annex-B NAL units; IDR frames carry SPS/PPS and FRAME_FLAG_KEYFRAME.
+ * mobile_app/app.js feeds them to a WebCodecs VideoDecoder.
+ *
+ * Only built with ENABLE_X264; otherwise available() is false and
+ * VRFrameEncoder falls back to JPEG.
+ */
+
+#include "../core/common.hpp"
+#include "../core/config.hpp"
+#include "../core/memory_pool.hpp"
+
+namespace vrs
+{
+
+    class H264Encoder
+    {
+    public:
+        H264Encoder();
+        ~H264Encoder();
+
+        H264Encoder(const H264Encoder &) = delete;
+        H264Encoder &operator=(const H264Encoder &) = delete;
+
+        /**
+         * Check whether H.264 support was compiled in.
+         */
+        [[nodiscard]] static bool available() noexcept;
+
+        /**
+         * Encode a BGR/BGRA frame into a complete H264 message.
+         * The encoder is (re)opened when the geometry or H.264 settings change.
+         * Odd dimensions are cropped to even for 4:2:0.
+         * @param force_idr Emit an IDR frame (with SPS/PPS)
+         * @return Size of the message, or 0 on failure
+         */
+        size_t encode(
+            const u8 *input,
+            u32 width, u32 height,
+            u32 pitch, u32 channels,
+            const EncoderConfig &config,
+            bool force_idr,
+            CompressedFrame &output);
+
+        /**
+         * Close the encoder; the next frame reopens it with an IDR.
+         */
+        void shutdown();
+
+        [[nodiscard]] f64 last_encode_time_ms() const { return last_encode_time_; }
+
+        /**
+         * Check whether the last frame was an IDR.
+         */
+        [[nodiscard]] bool last_keyframe() const { return last_keyframe_; }
+
+    private:
+        bool open(u32 width, u32 height, const EncoderConfig &config);
+
+        void *encoder_ = nullptr; // x264_t*
+        AlignedPtr<u8> yuv_;      // I420 planes for the current geometry
+        u32 width_ = 0;
+        u32 height_ = 0;
+        u32 bitrate_ = 0;
+        u32 gop_length_ = 0;
+        bool low_latency_ = false;
+
+        Timer clock_; // Presentation timestamps (ms) for rate control
+        i64 last_pts_ = -1;
+        f64 last_encode_time_ = 0;
+        bool last_keyframe_ = false;
+    };
+
+} // namespace vrs
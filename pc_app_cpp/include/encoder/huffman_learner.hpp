@@ -0,0 +1,130 @@
+#pragma once
+/**
+ * VR Streamer - Huffman Table Learner
+ * Builds optimised JPEG Huffman tables from recent frames in the background,
+ * so the hot encoder gets most of the optimize_coding size win for free.
+ */
+
+#include "../core/common.hpp"
+
+namespace vrs
+{
+
+    /**
+     * One DHT table in libjpeg layout (bits[0] unused).
+     */
+    struct HuffmanTable
+    {
+        std::array<u8, 17> bits{};
+        std::array<u8, 256> huffval{};
+    };
+
+    /**
+     * Luma (0) and chroma (1) DC/AC tables for a YCbCr baseline JPEG.
+     * Every legal symbol has a code, so the tables are safe for any frame.
+     */
+    struct HuffmanTables
+    {
+        std::array<HuffmanTable, 2> dc;
+        std::array<HuffmanTable, 2> ac;
+    };
+
+    /**
+     * Produces pixel rows on demand for encoders that never see a whole frame:
+     * fills rows [first_row, first_row + rows) into dst, dst_pitch bytes
+     * apart. May be called from several threads at once.
+     */
+    using RowSource = std::function<void(u32 first_row, u32 rows, u8 *dst, u32 dst_pitch)>;
+
+    /**
+     * The JPEG Annex K example tables (libjpeg's defaults).
+     */
+    [[nodiscard]] const HuffmanTables &annex_k_huffman_tables();
+
+    /**
+     * Install tables into a libjpeg compressor.
+     * jpeg_set_defaults() only fills empty table slots, so a compressor that
+     * once used custom tables needs the Annex K ones installed explicitly.
+     * @param cinfo jpeg_compress_struct*, after jpeg_set_defaults()
+     */
+    void install_huffman_tables(void *cinfo, const HuffmanTables &tables);
+
+    /**
+     * Background Huffman table learner.
+     *
+     * offer() is called with every encoded frame but only samples one every
+     * interval: a band of MCU rows spread over the frame is copied and handed
+     * to the shared pool's BACKGROUND lane, which runs a libjpeg
+     * optimize_coding pass, widens
+     * the result to cover every symbol, and checks it against the Annex K
+     * tables on the same sample. Tables are published only when they win.
+     */
+    class HuffmanLearner
+    {
+    public:
+        /**
+         * @param interval_ms Minimum time between samples
+         */
+        explicit HuffmanLearner(u32 interval_ms = 1000);
+        ~HuffmanLearner();
+
+        HuffmanLearner(const HuffmanLearner &) = delete;
+        HuffmanLearner &operator=(const HuffmanLearner &) = delete;
+
+        /**
+         * Offer a frame for sampling (cheap unless a sample is due).
+         */
+        void offer(
+            const u8 *input,
+            u32 width, u32 height,
+            u32 pitch, u32 channels,
+            u32 quality);
+
+        /**
+         * Offer a frame that only exists as rows (fused stereo + encode).
+         */
+        void offer(
+            const RowSource &source,
+            u32 width, u32 height,
+            u32 channels,
+            u32 quality);
+
+        /**
+         * Current tables, or nullptr to use the defaults.
+         */
+        [[nodiscard]] std::shared_ptr<const HuffmanTables> tables() const;
+
+        struct Stats
+        {
+            f64 table_age_ms = 0;   // Time since the tables in use were built
+            f64 gain_percent = 0;   // Size saved vs Annex K tables on the last sample
+            u64 tables_built = 0;   // Tables published so far
+        };
+        [[nodiscard]] Stats stats() const;
+
+    private:
+        [[nodiscard]] bool sample_due(u32 width, u32 height, u32 quality) const;
+        void learn();
+
+        u32 interval_ms_;
+        Timer sample_timer_;
+        bool sampled_ = false;
+        std::atomic<bool> busy_{false};
+
+        // Owned by the worker while busy_ is set
+        std::vector<u8> sample_;
+        u32 sample_width_ = 0;
+        u32 sample_height_ = 0;
+        u32 sample_channels_ = 0;
+        u32 sample_quality_ = 0;
+
+        mutable std::mutex mutex_;
+        std::condition_variable idle_; // busy_ cleared, under mutex_
+        std::shared_ptr<const HuffmanTables> tables_;
+        std::array<std::shared_ptr<HuffmanTables>, 3> table_slots_; // Published, still read, free
+        Timer table_timer_;
+        f64 gain_percent_ = 0;
+        u64 tables_built_ = 0;
+    };
+
+} // namespace vrs
@@ -1,7 +1,7 @@
 #pragma once
 /**
  * VR Streamer - JPEG Encoder
- * High-performance JPEG encoding using TurboJPEG and nvJPEG.
+ * High-performance JPEG encoding using TurboJPEG, nvJPEG or a built-in encoder.
  * SIMD-optimized CPU fallback with GPU acceleration support.
  */
 
@@ -32,7 +32,7 @@ namespace vrs
          * @param pitch Row pitch in bytes
          * @param channels 3 for BGR, 4 for BGRA
          * @param quality JPEG quality (1-100)
-         * @param output Output buffer for encoded data
+         * @param output Output frame; grown to fit and written in place
          * @return Size of encoded data, or 0 on failure
          */
         virtual size_t encode(
@@ -40,7 +40,7 @@ namespace vrs
             u32 width, u32 height,
             u32 pitch, u32 channels,
             u32 quality,
-            std::vector<u8> &output) = 0;
+            CompressedFrame &output) = 0;
 
         /**
          * Check if encoder is available.
@@ -58,15 +58,115 @@ namespace vrs
         [[nodiscard]] virtual f64 last_encode_time_ms() const = 0;
     };
 
+    /**
+     * Per-thread state for SharedJPEGEncoder: the TurboJPEG compressor
+     * handle and a scratch arena for encode_scratch() output. Cheap to
+     * create and movable; never shared between threads at the same time.
+     */
+    class JPEGEncodeContext
+    {
+    public:
+        JPEGEncodeContext() = default;
+        ~JPEGEncodeContext();
+
+        JPEGEncodeContext(JPEGEncodeContext &&other) noexcept;
+        JPEGEncodeContext &operator=(JPEGEncodeContext &&other) noexcept;
+        JPEGEncodeContext(const JPEGEncodeContext &) = delete;
+        JPEGEncodeContext &operator=(const JPEGEncodeContext &) = delete;
+
+        /**
+         * Start a new frame: drops everything encode_scratch() returned.
+         */
+        void reset() { arena_.reset(); }
+
+        [[nodiscard]] bool valid() const noexcept { return handle_ != nullptr; }
+        [[nodiscard]] f64 last_encode_time_ms() const noexcept { return last_encode_time_; }
+        [[nodiscard]] ScratchArena &arena() noexcept { return arena_; }
+
+    private:
+        friend class SharedJPEGEncoder;
+
+        void *handle_ = nullptr; // tjhandle
+        ScratchArena arena_;
+        f64 last_encode_time_ = 0;
+    };
+
+    /**
+     * TurboJPEG settings that any number of threads can encode with at
+     * once: every call takes the caller's JPEGEncodeContext, which holds
+     * all mutable state. A worker pool keeps one shared encoder and one
+     * context per thread, with no locks and, once the contexts are warm,
+     * no allocations.
+     */
+    class SharedJPEGEncoder
+    {
+    public:
+        /**
+         * @param full_chroma 4:4:4 instead of 4:2:0 (sharper coloured text, larger frames)
+         */
+        explicit SharedJPEGEncoder(bool full_chroma = false);
+
+        /**
+         * New context with its own compressor handle (invalid if TurboJPEG
+         * failed to initialise).
+         */
+        [[nodiscard]] JPEGEncodeContext make_context() const;
+
+        /**
+         * Encode into output (grown to fit). See IJPEGEncoder::encode().
+         * @return Size of encoded data, or 0 on failure
+         */
+        size_t encode(
+            JPEGEncodeContext &context,
+            const u8 *input,
+            u32 width, u32 height,
+            u32 pitch, u32 channels,
+            u32 quality,
+            CompressedFrame &output) const;
+
+        /**
+         * Encode into the context's arena, for JPEGs that are copied into a
+         * larger message. The bytes stay valid until context.reset().
+         * @return Encoded JPEG, empty on failure
+         */
+        [[nodiscard]] std::span<const u8> encode_scratch(
+            JPEGEncodeContext &context,
+            const u8 *input,
+            u32 width, u32 height,
+            u32 pitch, u32 channels,
+            u32 quality) const;
+
+        [[nodiscard]] bool full_chroma() const noexcept { return full_chroma_; }
+
+    private:
+        /**
+         * Compress into dst (at least tjBufSize bytes).
+         * @return Size of encoded data, or 0 on failure
+         */
+        size_t compress(
+            JPEGEncodeContext &context,
+            const u8 *input,
+            u32 width, u32 height,
+            u32 pitch, u32 channels,
+            u32 quality,
+            u8 *dst, size_t capacity) const;
+
+        bool full_chroma_ = false;
+    };
+
     /**
      * TurboJPEG encoder - SIMD-optimized CPU encoding.
      * Uses libjpeg-turbo for fast JPEG compression with AVX2/SSE support.
+     * A SharedJPEGEncoder with one context, for single-threaded callers.
      */
     class TurboJPEGEncoder : public IJPEGEncoder
     {
     public:
-        TurboJPEGEncoder();
-        ~TurboJPEGEncoder() override;
+        /**
+         * @param full_chroma 4:4:4 instead of 4:2:0 (sharper coloured text, larger frames)
+         */
+        explicit TurboJPEGEncoder(bool full_chroma = false);
+        ~TurboJPEGEncoder() override = default;
 
         TurboJPEGEncoder(const TurboJPEGEncoder &) = delete;
         TurboJPEGEncoder &operator=(const TurboJPEGEncoder &) = delete;
@@ -76,15 +176,15 @@ namespace vrs
             u32 width, u32 height,
             u32 pitch, u32 channels,
             u32 quality,
-            std::vector<u8> &output) override;
+            CompressedFrame &output) override;
 
-        [[nodiscard]] bool available() const override { return handle_ != nullptr; }
+        [[nodiscard]] bool available() const override { return context_.valid(); }
         [[nodiscard]] std::string_view name() const override { return "TurboJPEG"; }
-        [[nodiscard]] f64 last_encode_time_ms() const override { return last_encode_time_; }
+        [[nodiscard]] f64 last_encode_time_ms() const override { return context_.last_encode_time_ms(); }
 
     private:
-        void *handle_ = nullptr; // tjhandle
-        f64 last_encode_time_ = 0;
+        SharedJPEGEncoder shared_;
+        JPEGEncodeContext context_;
     };
 
     /**
@@ -115,7 +215,7 @@ namespace vrs
             u32 width, u32 height,
             u32 pitch, u32 channels,
             u32 quality,
-            std::vector<u8> &output) override;
+            CompressedFrame &output) override;
 
         /**
          * Encode directly from GPU texture (zero-copy).
@@ -125,7 +225,7 @@ namespace vrs
             u32 width, u32 height,
             u32 pitch,
             u32 quality,
-            std::vector<u8> &output);
+            CompressedFrame &output);
 
         [[nodiscard]] bool available() const override { return initialized_; }
         [[nodiscard]] std::string_view name() const override { return "nvJPEG"; }
@@ -143,26 +243,88 @@ namespace vrs
     };
 
     /**
-     * OpenCV JPEG encoder - Fallback when TurboJPEG is unavailable.
+     * Built-in JPEG encoder - dependency-free, selectable and used when TurboJPEG is unavailable.
+     * Baseline 4:2:0 only, Annex K tables scaled by quality. SIMD colour
+     * conversion (AVX2/NEON), fixed-point AAN DCT, reciprocal quantisation and
+     * a 64-bit Huffman bit writer; headers are prebuilt per quality.
      */
-    class OpenCVJPEGEncoder : public IJPEGEncoder
+    class SimdJPEGEncoder : public IJPEGEncoder
     {
     public:
-        OpenCVJPEGEncoder() = default;
-        ~OpenCVJPEGEncoder() override = default;
+        SimdJPEGEncoder();
+        ~SimdJPEGEncoder() override;
+
+        SimdJPEGEncoder(const SimdJPEGEncoder &) = delete;
+        SimdJPEGEncoder &operator=(const SimdJPEGEncoder &) = delete;
 
         size_t encode(
             const u8 *input,
             u32 width, u32 height,
             u32 pitch, u32 channels,
             u32 quality,
-            std::vector<u8> &output) override;
+            CompressedFrame &output) override;
 
         [[nodiscard]] bool available() const override { return true; }
-        [[nodiscard]] std::string_view name() const override { return "OpenCV"; }
+        [[nodiscard]] std::string_view name() const override { return "BuiltinJPEG"; }
         [[nodiscard]] f64 last_encode_time_ms() const override { return last_encode_time_; }
 
+        /**
+         * Get the SIMD path compiled in ("AVX2", "NEON" or "scalar").
+         */
+        [[nodiscard]] static std::string_view simd_path() noexcept;
+
+        static constexpr u32 MAX_ROI_STEP = 8;
+
+        /**
+         * Centre-weighted quantisation for lens optics: MCUs away from the
+         * centre of each region quantise their AC coefficients with a
+         * multiple of the table step and write them back scaled, so any
+         * decoder reads them with the one table while more coefficients
+         * round to zero. DC keeps the full step (no blocky brightness steps)
+         * and MCUs inside inner_radius are coded exactly as without ROI.
+         *
+         * Radii are per region, 1.0 being the middle of its left/right and
+         * top/bottom edges; the step rises linearly from 1 at inner_radius
+         * to max_step at outer_radius.
+         * @param regions Side-by-side regions (2 for SBS, 1 for mono, 0 = off)
+         */
+        void set_roi(u32 regions, f32 inner_radius, f32 outer_radius, u32 max_step) noexcept;
+
     private:
+        /**
+         * Rebuild quantisation tables, reciprocals and the JPEG header.
+         */
+        void set_quality(u32 quality);
+
+        /**
+         * Colour-convert and 2x2-subsample one 16-row band into the sample
+         * buffers. Takes row pointers so a producer can feed rows directly.
+         * @param rows 16 source row pointers (clamped at the bottom edge)
+         */
+        void convert_band(const u8 *const *rows, u32 width, u32 channels);
+
+        u32 quality_ = 0;
+        std::array<u8, 64> luma_quant_{};   // Natural order
+        std::array<u8, 64> chroma_quant_{};
+        std::array<f32, 64> luma_scale_{};  // 1 / (quant * AAN scale * 8)
+        std::array<f32, 64> chroma_scale_{};
+        std::vector<u8> header_;            // SOI .. SOS for the current quality
+
+        // One MCU row of level-shifted samples
+        u32 padded_width_ = 0;     // Width rounded up to the MCU
+        std::vector<i16> y_band_;  // 16 rows of padded width
+        std::vector<i16> cb_band_; // 8 rows of padded width / 2
+        std::vector<i16> cr_band_;
+
+        // Centre-weighted quantisation (set_roi)
+        u32 roi_regions_ = 0;
+        f32 roi_inner_ = 0;
+        f32 roi_outer_ = 1;
+        u32 roi_max_step_ = 1;
+        std::array<std::array<f32, 64>, MAX_ROI_STEP> roi_luma_scale_{}; // [step - 1]
+        std::array<std::array<f32, 64>, MAX_ROI_STEP> roi_chroma_scale_{};
+        std::vector<f32> roi_dx2_; // Squared normalised distance of each MCU column to its region centre
+
         f64 last_encode_time_ = 0;
     };
 
@@ -172,7 +334,10 @@ namespace vrs
     class AutoJPEGEncoder : public IJPEGEncoder
     {
     public:
-        AutoJPEGEncoder();
+        /**
+         * @param prefer_builtin Pick the built-in encoder over TurboJPEG
+         */
+        explicit AutoJPEGEncoder(bool prefer_builtin = false);
         ~AutoJPEGEncoder() override = default;
 
         size_t encode(
@@ -180,7 +345,7 @@ namespace vrs
             u32 width, u32 height,
             u32 pitch, u32 channels,
             u32 quality,
-            std::vector<u8> &output) override;
+            CompressedFrame &output) override;
 
         [[nodiscard]] bool available() const override { return best_encoder_ != nullptr; }
         [[nodiscard]] std::string_view name() const override;
@@ -191,10 +356,20 @@ namespace vrs
          */
         [[nodiscard]] IJPEGEncoder *selected() const { return best_encoder_; }
 
+        /**
+         * Check if the selected encoder runs on the GPU.
+         */
+        [[nodiscard]] bool gpu() const { return best_encoder_ != nullptr && best_encoder_ == nvjpeg_.get(); }
+
+        /**
+         * Check if the selected encoder is the built-in one.
+         */
+        [[nodiscard]] bool builtin() const { return best_encoder_ != nullptr && best_encoder_ == builtin_.get(); }
+
     private:
         std::unique_ptr<NvJPEGEncoder> nvjpeg_;
         std::unique_ptr<TurboJPEGEncoder> turbojpeg_;
-        std::unique_ptr<OpenCVJPEGEncoder> opencv_;
+        std::unique_ptr<SimdJPEGEncoder> builtin_;
         IJPEGEncoder *best_encoder_ = nullptr;
     };
 
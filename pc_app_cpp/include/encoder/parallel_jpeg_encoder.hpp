@@ -0,0 +1,121 @@
+#pragma once
+/**
+ * VR Streamer - Parallel JPEG Encoder
+ * Intra-frame parallel baseline JPEG encoding using restart-interval strips.
+ * Each strip of MCU rows is entropy-coded on its own core and the results are
+ * stitched into a single standards-compliant JPEG with RSTn markers.
+ */
+
+#include "jpeg_encoder.hpp"
+#include "huffman_learner.hpp"
+#include "../core/thread_pool.hpp"
+
+namespace vrs
+{
+
+    /**
+     * Parallel strip JPEG encoder.
+     *
+     * The frame is split into horizontal strips whose height is a multiple of
+     * the 4:2:0 MCU height (16 rows). Every strip is compressed independently
+     * with identical tables; the restart interval is set to the number of MCUs
+     * in one strip so each strip boundary is a restart point. The output keeps
+     * the headers of the first strip (SOF height patched to the full frame),
+     * then concatenates the entropy-coded segments separated by RST0..RST7.
+     * Any baseline decoder (including browsers) decodes it unchanged.
+     *
+     * With adaptive Huffman enabled, frames are also offered to a
+     * HuffmanLearner and the latest learned tables replace the Annex K ones.
+     *
+     * encode_rows() takes a RowSource instead of a frame: each strip asks for
+     * one MCU row (16 lines) at a time into a small per-strip buffer that
+     * stays in cache, so the producer's output never goes to memory.
+     */
+    class ParallelJPEGEncoder : public IJPEGEncoder
+    {
+    public:
+        /**
+         * @param num_threads Threads per frame: the caller plus up to num_threads - 1
+         *                    workers of the shared pool (0 = half the hardware threads)
+         */
+        explicit ParallelJPEGEncoder(u32 num_threads = 0);
+        ~ParallelJPEGEncoder() override;
+
+        ParallelJPEGEncoder(const ParallelJPEGEncoder &) = delete;
+        ParallelJPEGEncoder &operator=(const ParallelJPEGEncoder &) = delete;
+
+        size_t encode(
+            const u8 *input,
+            u32 width, u32 height,
+            u32 pitch, u32 channels,
+            u32 quality,
+            CompressedFrame &output) override;
+
+        /**
+         * Encode a BGR frame produced one MCU row at a time by source.
+         * Output is identical to encode() on the assembled frame.
+         */
+        size_t encode_rows(
+            const RowSource &source,
+            u32 width, u32 height,
+            u32 quality,
+            CompressedFrame &output);
+
+        [[nodiscard]] bool available() const override { return !strips_.empty(); }
+        [[nodiscard]] std::string_view name() const override { return "ParallelJPEG"; }
+        [[nodiscard]] f64 last_encode_time_ms() const override { return last_encode_time_; }
+
+        /**
+         * Get the number of worker threads.
+         */
+        [[nodiscard]] u32 threads() const noexcept { return num_threads_; }
+
+        /**
+         * Learn Huffman tables from recent frames in the background.
+         * @param interval_ms Sampling interval (0 = Annex K tables only)
+         */
+        void set_adaptive_huffman(u32 interval_ms);
+
+        /**
+         * Get learned-table statistics (zero when adaptive Huffman is off).
+         */
+        [[nodiscard]] HuffmanLearner::Stats huffman_stats() const;
+
+    private:
+        struct StripContext; // libjpeg state, defined in the .cpp
+
+        /**
+         * Compress one strip into its context's scratch buffer, reading
+         * rows from input, or from source if input is null.
+         * @return true on success
+         */
+        bool encode_strip(
+            StripContext &strip,
+            const u8 *input,
+            const RowSource *source,
+            u32 first_row,
+            u32 width, u32 rows,
+            u32 pitch, u32 channels,
+            u32 quality,
+            u32 restart_interval,
+            const HuffmanTables &tables);
+
+        /**
+         * Shared body of encode() and encode_rows().
+         */
+        size_t encode_frame(
+            const u8 *input,
+            const RowSource *source,
+            u32 width, u32 height,
+            u32 pitch, u32 channels,
+            u32 quality,
+            CompressedFrame &output);
+
+        u32 num_threads_ = 1;
+        std::vector<std::unique_ptr<StripContext>> strips_;
+        std::unique_ptr<HuffmanLearner> huffman_learner_;
+        u32 huffman_interval_ms_ = 0;
+        f64 last_encode_time_ = 0;
+    };
+
+} // namespace vrs
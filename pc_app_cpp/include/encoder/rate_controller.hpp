@@ -0,0 +1,76 @@
+#pragma once
+/**
+ * VR Streamer - JPEG Rate Controller
+ * Picks jpeg_quality per frame so messages land near a bytes-per-frame budget.
+ */
+
+#include "../core/common.hpp"
+
+namespace vrs
+{
+
+    /**
+     * Size-vs-quality model fitted on recent frames.
+     *
+     * libjpeg scales its quantisation tables by S(q) = 5000/q below 50 and
+     * 200 - 2q above, and frame size follows size = c * S^-a closely. The
+     * content term c is re-estimated every frame (scene changes are tracked
+     * within a frame or two); the exponent a is refit by least squares over
+     * the recent history once it spans enough qualities.
+     *
+     * The next quality is the model's answer for the budget, held inside a
+     * +-10% dead band and moved by bounded steps: large cuts when a frame
+     * overshoots (queues build up fast), small raises when it undershoots.
+     */
+    class RateController
+    {
+    public:
+        static constexpr u32 HISTORY = 16;
+
+        explicit RateController(u32 quality = 65) { reset(quality); }
+
+        /**
+         * Forget the model and continue from quality.
+         */
+        void reset(u32 quality);
+
+        /**
+         * Feed the size of a frame encoded at quality and choose the next quality.
+         * @param budget Target bytes per frame (> 0)
+         */
+        void update(u32 quality, size_t bytes, u32 budget, u32 min_quality, u32 max_quality);
+
+        /**
+         * Quality to use for the next frame.
+         */
+        [[nodiscard]] u32 quality() const noexcept { return quality_; }
+
+        /**
+         * Predicted size at quality for the current content.
+         */
+        [[nodiscard]] f64 predict(u32 quality) const noexcept;
+
+        /**
+         * Current size-vs-scale exponent.
+         */
+        [[nodiscard]] f64 exponent() const noexcept { return exponent_; }
+
+    private:
+        struct Sample
+        {
+            f64 log_scale;
+            f64 log_bytes;
+        };
+
+        void refit_exponent();
+
+        u32 quality_ = 65;
+        f64 log_content_ = 0; // log c
+        f64 exponent_ = 0;    // a
+        bool primed_ = false;
+        std::array<Sample, HISTORY> history_{};
+        u32 history_count_ = 0;
+        u32 history_next_ = 0;
+    };
+
+} // namespace vrs
@@ -0,0 +1,53 @@
+#pragma once
+/**
+ * VR Streamer - Lossless RAW Encoder
+ * Pixel-exact frames for wired/localhost links: per-row prediction followed
+ * by a QOI-style byte codec, sent as one framed message (FrameType::RAW).
+ *
+ * Payload layout (one part), for each of the frame's rows:
+ *
+ *   1 byte   predictor: 0 = none, 1 = up (value = pixel - pixel above, per channel mod 256)
+ *   ...      QOI ops covering exactly `width` RGB values, runs never cross rows
+ *
+ * Ops follow QOI without alpha: INDEX (00iiiiii), DIFF (01rrggbb), LUMA
+ * (10gggggg rrrrbbbb), RUN (11nnnnnn, 1..62) and RGB (FE r g b). The previous
+ * value and the 64-entry index (hash r*3 + g*5 + b*7) persist across rows
+ * and start at zero every frame.
+ *
+ * mobile_app/app.js mirrors this in its raw decoder worker.
+ */
+
+#include "../core/common.hpp"
+#include "../core/memory_pool.hpp"
+
+namespace vrs
+{
+
+    class RawEncoder
+    {
+    public:
+        RawEncoder() = default;
+
+        /**
+         * Encode a BGR/BGRA frame into a complete RAW message (alpha is dropped).
+         * @return Size of the message, or 0 on failure
+         */
+        size_t encode(
+            const u8 *input,
+            u32 width, u32 height,
+            u32 pitch, u32 channels,
+            CompressedFrame &output);
+
+        [[nodiscard]] f64 last_encode_time_ms() const { return last_encode_time_; }
+
+        /**
+         * Get the fraction of rows coded against the row above in the last frame.
+         */
+        [[nodiscard]] f64 up_row_ratio() const { return up_row_ratio_; }
+
+    private:
+        f64 last_encode_time_ = 0;
+        f64 up_row_ratio_ = 0;
+    };
+
+} // namespace vrs
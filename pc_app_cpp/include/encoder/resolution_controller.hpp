@@ -0,0 +1,66 @@
+#pragma once
+/**
+ * VR Streamer - Dynamic Resolution Controller
+ * Steps downscale_factor so stereo + encode time fits the frame interval.
+ */
+
+#include "../core/common.hpp"
+
+namespace vrs
+{
+
+    /**
+     * Moves along a ladder of cheap scale ratios (1, 3/4, 2/3, 1/2, 2/5, 1/3, 1/4)
+     * below the configured downscale_factor.
+     *
+     * Frame time is tracked as a moving average and assumed proportional to
+     * pixel count, so a step down goes straight to the largest rung predicted
+     * to fit. Integer ratios (1/2, 1/3, 1/4) sample whole pixels on both axes
+     * and are accepted with less margin than the fractional rungs. Steps up
+     * are one rung at a time after a hold period, with more margin than steps
+     * down, so the scale does not oscillate between neighbours.
+     */
+    class ResolutionController
+    {
+    public:
+        explicit ResolutionController(f32 max_scale = 1.0f, f32 min_scale = 0.25f) { reset(max_scale, min_scale); }
+
+        /**
+         * Rebuild the ladder below max_scale (the configured downscale_factor)
+         * and start from the top.
+         */
+        void reset(f32 max_scale, f32 min_scale);
+
+        /**
+         * Feed the processing time of a frame.
+         * @param frame_time_ms Stereo + encode time
+         * @param budget_ms Time available per frame
+         * @return true if scale() changed
+         */
+        bool update(f64 frame_time_ms, f64 budget_ms);
+
+        /**
+         * Scale to use for the next frame.
+         */
+        [[nodiscard]] f32 scale() const noexcept { return rungs_[rung_]; }
+
+        /**
+         * Smoothed frame time at the current scale.
+         */
+        [[nodiscard]] f64 average_ms() const noexcept { return average_ms_; }
+
+    private:
+        /**
+         * Largest fraction of the budget a rung may be predicted to use.
+         */
+        [[nodiscard]] f64 headroom(size_t rung, bool stepping_up) const noexcept;
+
+        [[nodiscard]] f64 predicted_ms(size_t rung) const noexcept;
+
+        std::vector<f32> rungs_; // Descending; rungs_[0] is the configured scale
+        size_t rung_ = 0;
+        f64 average_ms_ = 0;
+        u32 frames_at_rung_ = 0;
+    };
+
+} // namespace vrs
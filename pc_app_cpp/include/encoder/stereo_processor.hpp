@@ -7,6 +7,10 @@
 
 #include "../core/common.hpp"
 #include "../core/config.hpp"
+#include "../core/memory_pool.hpp"
+#include "../core/thread_pool.hpp"
+#include "../network/frame_protocol.hpp"
+#include "jpeg_encoder.hpp"
 
 namespace vrs
 {
@@ -19,6 +23,7 @@ namespace vrs
         u64 frames_processed = 0;
         f64 avg_process_time_ms = 0;
         f64 last_process_time_ms = 0;
+        u64 plan_rebuilds = 0; // Sampling tables rebuilt for a new geometry
     };
 
     /**
@@ -160,6 +165,45 @@ namespace vrs
             f32 downscale_factor,
             f32 eye_separation) override;
 
+        /**
+         * Sample one view for both eyes (OutputMode::SINGLE_VIEW): the left
+         * eye's eye_width columns as process_scaled() samples them, plus
+         * disparity more on the right, so the right eye is the same view
+         * starting disparity columns in.
+         * @return Output pitch ((eye_width + disparity) * 3)
+         */
+        u32 process_view(
+            const u8 *input,
+            u32 input_width, u32 input_height,
+            u32 input_pitch, u32 input_channels,
+            u8 *output,
+            u32 eye_width, u32 output_height,
+            u32 disparity);
+
+        /**
+         * Streaming variant of process_scaled() / process_view(): set up the
+         * geometry once per frame, then fetch rows in any order and from any
+         * thread with sample_rows() (fused stereo + encode).
+         * @return Output width in pixels
+         */
+        u32 prepare_sbs(
+            u32 input_width, u32 input_height,
+            u32 input_pitch, u32 input_channels,
+            u32 output_width, u32 output_height,
+            f32 eye_separation);
+
+        u32 prepare_view(
+            u32 input_width, u32 input_height,
+            u32 input_pitch, u32 input_channels,
+            u32 eye_width, u32 output_height,
+            u32 disparity);
+
+        /**
+         * Write output rows [first_row, first_row + rows) of the prepared
+         * geometry as BGR.
+         */
+        void sample_rows(const u8 *input, u32 first_row, u32 rows, u8 *output, u32 output_pitch) const;
+
         [[nodiscard]] bool available() const override { return true; }
         [[nodiscard]] std::string_view name() const override { return "CPU"; }
         [[nodiscard]] StereoStats stats() const override { return stats_; }
@@ -176,6 +220,38 @@ namespace vrs
             u8 *dst, u32 dst_width, u32 dst_height, u32 dst_pitch,
             u32 channels);
 
+        /**
+         * Source offsets for every output row and column of the SBS frame
+         * (or of the single view). Only depends on the geometry, so it is
+         * rebuilt when that changes (new resolution rung, window resize)
+         * rather than every frame.
+         */
+        struct SamplingPlan
+        {
+            u32 input_width = 0;
+            u32 input_height = 0;
+            u32 input_pitch = 0;
+            u32 input_channels = 0;
+            u32 output_width = 0;
+            u32 output_height = 0;
+            u32 separation = 0;       // Input pixels (SBS) or view columns (single view)
+            bool single_view = false; // output_width is the eye width
+            std::vector<u32> columns; // Byte offset within a source row, left eye then right eye
+            std::vector<u32> rows;    // Byte offset of the source row
+        };
+
+        const SamplingPlan &sampling_plan(
+            u32 input_width, u32 input_height,
+            u32 input_pitch, u32 input_channels,
+            u32 output_width, u32 output_height,
+            u32 separation, bool single_view);
+
+        /**
+         * Copy every row of the current plan; returns the output pitch.
+         */
+        u32 sample(const u8 *input, u8 *output);
+
+        SamplingPlan plan_;
         StereoStats stats_;
     };
 
@@ -205,6 +281,29 @@ namespace vrs
             f32 downscale_factor,
             f32 eye_separation) override;
 
+        /**
+         * See CPUStereoProcessor::process_view(). A plain resample, so it
+         * always runs on the CPU.
+         */
+        u32 process_view(
+            const u8 *input,
+            u32 input_width, u32 input_height,
+            u32 input_pitch, u32 input_channels,
+            u8 *output,
+            u32 eye_width, u32 output_height,
+            u32 disparity);
+
+        /**
+         * CPU sampler, for the paths that always run there (single view,
+         * fused stereo + encode). Created on first use next to CUDA.
+         */
+        CPUStereoProcessor &cpu();
+
+        /**
+         * Whether process_scaled() runs on the GPU.
+         */
+        [[nodiscard]] bool gpu() const noexcept { return best_ != nullptr && best_ == cuda_.get(); }
+
         [[nodiscard]] bool available() const override { return best_ != nullptr; }
         [[nodiscard]] std::string_view name() const override;
         [[nodiscard]] StereoStats stats() const override;
@@ -228,6 +327,19 @@ namespace vrs
         VRFrameEncoder(const VRFrameEncoder &) = delete;
         VRFrameEncoder &operator=(const VRFrameEncoder &) = delete;
 
+        /**
+         * Rate control and scale decided by the caller. EncodeWorkerPool owns
+         * the stream's rate and resolution controllers and fills one in for
+         * every frame; without it a frame uses jpeg_quality and
+         * downscale_factor.
+         */
+        struct FrameControl
+        {
+            u32 quality = 0;      // JPEG quality if the frame is rate-controlled
+            u32 frame_budget = 0; // Bytes-per-frame target (0 = fixed jpeg_quality)
+            f32 downscale = 1.0f; // Stereo output scale, dynamic_resolution included
+        };
+
         /**
          * Encode a frame for VR streaming.
          * @param input Input image data
@@ -235,31 +347,52 @@ namespace vrs
          * @param height Image height
          * @param pitch Row pitch
          * @param channels 3 or 4
-         * @param output Output compressed data
+         * @param output Output frame, typically drawn from a CompressedFramePool
+         * @param control Quality and scale picked for this frame (nullptr = as configured)
          * @return Size of compressed output, or 0 on failure
          */
         size_t encode(
             const u8 *input,
             u32 width, u32 height,
             u32 pitch, u32 channels,
-            std::vector<u8> &output);
+            CompressedFrame &output,
+            const FrameControl *control = nullptr);
 
         /**
-         * Update configuration.
+         * Update configuration, between frames on the thread that calls
+         * encode(). Strip encoders are rebuilt on the next frame only if
+         * their own fields changed;
+         * switching to or from the built-in JPEG method rebuilds the JPEG
+         * encoders here.
          */
         void update_config(const EncoderConfig &config);
 
+        /**
+         * Make the next TILES/H.264 frame a keyframe (new client, dropped patch).
+         * Safe to call from any thread.
+         */
+        void request_keyframe() noexcept { keyframe_requested_.store(true, std::memory_order_relaxed); }
+
         /**
          * Get encoding statistics.
          */
         struct Stats
         {
-            f64 stereo_time_ms = 0;
+            f64 stereo_time_ms = 0;       // 0 when fused into encode_time_ms
             f64 encode_time_ms = 0;
             f64 total_time_ms = 0;
             u64 frames_encoded = 0;
             u64 bytes_encoded = 0;
             f64 compression_ratio = 0;
+            u32 tiles_changed = 0;        // TILES: tiles sent in the last frame
+            u32 tiles_total = 0;          // TILES: tiles in the grid
+            u64 keyframes = 0;            // TILES: full frames sent, H264: IDR frames sent
+            f64 huffman_table_age_ms = 0; // Age of the learned Huffman tables (0 = Annex K)
+            f64 huffman_gain_percent = 0; // Size saved by them on the last sample
+            u32 quality = 0;              // JPEG quality of the last frame
+            u32 frame_budget_bytes = 0;   // Rate control target (0 = off)
+            u64 last_frame_bytes = 0;     // Size of the last frame
+            f32 downscale_factor = 0;     // Scale of the last frame (dynamic_resolution may lower it)
         };
         [[nodiscard]] Stats stats() const { return stats_; }
 
@@ -269,9 +402,107 @@ namespace vrs
         [[nodiscard]] const EncoderConfig &config() const { return config_; }
 
     private:
+        /**
+         * Log once per selection when Method::H264 has to fall back to JPEG.
+         */
+        void warn_if_h264_unavailable() const;
+
+        /**
+         * Single-frame JPEG encoder: GPU if available, else restart strips across cores.
+         */
+        class IJPEGEncoder *frame_encoder();
+
+        /**
+         * Built-in encoder set up for centre-weighted quantisation (roi_enabled).
+         * @param regions Lens regions side by side (2 for SBS)
+         */
+        class IJPEGEncoder *roi_encoder(u32 regions);
+
+        /**
+         * Strip encoder for fused stereo + encode, or nullptr if the frame
+         * has to be materialised first (fused_encode off, 4:4:4, GPU or
+         * built-in JPEG).
+         */
+        class ParallelJPEGEncoder *fused_encoder();
+
+        /**
+         * Restart-strip encoder sized for jpeg_threads, created on first use.
+         */
+        class ParallelJPEGEncoder &strip_encoder();
+
+        /**
+         * Wrap the view JPEG in view_frame_ in a FrameType::SINGLE_VIEW
+         * message that tells the client where each eye's window lies.
+         * @param view_size Size of the view JPEG (0 = failed)
+         */
+        size_t frame_single_view(
+            size_t view_size,
+            u32 eye_width, u32 disparity,
+            u32 height,
+            CompressedFrame &output);
+
+        /**
+         * Encode each half of the SBS buffer as its own JPEG on two cores and
+         * pack both into one framed message (FrameType::DUAL_JPEG).
+         */
+        size_t encode_dual_eye(
+            const u8 *stereo,
+            u32 width, u32 height,
+            u32 pitch,
+            u32 quality,
+            CompressedFrame &output);
+
+        /**
+         * Encode only the tiles that differ from the previous frame as small
+         * JPEGs (FrameType::TILES). The tile grid is laid out per region
+         * (per eye for SBS input) so tiles never straddle the eye boundary.
+         * @return Size of the message, or 0 if nothing changed
+         */
+        size_t encode_tiles(
+            const u8 *frame,
+            u32 width, u32 height,
+            u32 pitch, u32 channels,
+            u32 regions,
+            CompressedFrame &output);
+
         EncoderConfig config_;
         std::unique_ptr<AutoStereoProcessor> stereo_processor_;
         std::unique_ptr<class AutoJPEGEncoder> jpeg_encoder_;
+        std::unique_ptr<class ParallelJPEGEncoder> parallel_encoder_;
+        u32 parallel_threads_ = 0; // jpeg_threads the parallel encoder was built for
+
+        // Dual-eye mode: one encode context (TurboJPEG handle and scratch) per eye
+        std::array<JPEGEncodeContext, 2> eye_contexts_;
+        bool eye_contexts_ready_ = false;
+
+        // Tile mode: last sent frame for change detection plus per-frame tables
+        std::unique_ptr<class TurboJPEGEncoder> tile_encoder_;
+        CompressedFrame tile_scratch_;
+        std::vector<u8> previous_frame_;
+        std::vector<TileRect> tile_rects_;
+        std::vector<u32> tile_sizes_;
+        std::vector<u8> tile_payload_;
+        u32 tile_width_ = 0; // Geometry of previous_frame_ (0 = no reference, send keyframe)
+        u32 tile_height_ = 0;
+        u32 tile_channels_ = 0;
+        u32 tile_edge_ = 0;
+        u32 frames_since_keyframe_ = 0;
+        std::atomic<bool> keyframe_requested_{false};
+
+        // Lossless mode (Method::RAW), created on first use
+        std::unique_ptr<class RawEncoder> raw_encoder_;
+
+        // Video mode (Method::H264), created on first use
+        std::unique_ptr<class H264Encoder> h264_encoder_;
+
+        // Centre-weighted quantisation (roi_enabled), created on first use
+        std::unique_ptr<class SimdJPEGEncoder> roi_encoder_;
+
+        // Single-view mode: JPEG before framing
+        CompressedFrame view_frame_;
+
+        // 4:4:4 frames (full_chroma), created on first use
+        std::unique_ptr<class TurboJPEGEncoder> chroma_encoder_;
 
         // Work buffers
         std::vector<u8> stereo_buffer_;
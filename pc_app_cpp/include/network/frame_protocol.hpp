@@ -0,0 +1,155 @@
+#pragma once
+/**
+ * VR Streamer - Frame Wire Protocol
+ * Framing for binary WebSocket messages that carry more than one image
+ * or a non-JPEG payload.
+ *
+ * A plain JPEG message (starts with FF D8) is still sent as-is for the default
+ * side-by-side mode. Framed messages start with the "VR" magic:
+ *
+ *   offset  size  field
+ *   0       2     magic 'V' 'R'
+ *   2       1     version (1)
+ *   3       1     FrameType
+ *   4       2     width   (full output width, little-endian)
+ *   6       2     height  (full output height)
+ *   8       4     frame_id
+ *   12      2     part_count
+ *   14      2     flags (FrameFlags)
+ *   16      4*n   part sizes
+ *   ...     8*n   TILES only: part rects (x, y, w, h as u16) in output pixels
+ *   ...     4     SINGLE_VIEW only: disparity, eye width (u16 view pixels)
+ *   ...           part payloads, back to back
+ *
+ * mobile_app/app.js mirrors this layout in FrameCodec.parse().
+ */
+
+#include "../core/common.hpp"
+
+namespace vrs
+{
+
+    /**
+     * Payload type of a framed message.
+     */
+    enum class FrameType : u8
+    {
+        JPEG = 0,        // Single JPEG (unframed on the wire)
+        DUAL_JPEG = 1,   // Left and right eye as two JPEGs
+        TILES = 2,       // Changed tiles as small JPEGs, composited by the client
+        RAW = 3,         // Lossless RGB (see raw_encoder.hpp), one part
+        H264 = 4,        // One H.264 access unit (Annex-B NAL units), one part
+        SINGLE_VIEW = 5, // One JPEG view wider than an eye; the right eye starts disparity columns in
+    };
+
+    /**
+     * Frame header flags.
+     */
+    enum FrameFlags : u16
+    {
+        FRAME_FLAG_KEYFRAME = 1 << 0, // TILES: parts cover the whole frame, reset the canvas; H264: IDR
+    };
+
+    /**
+     * Placement of one TILES part.
+     */
+    struct TileRect
+    {
+        u16 x;
+        u16 y;
+        u16 w;
+        u16 h;
+    };
+
+    constexpr u8 FRAME_MAGIC_0 = 'V';
+    constexpr u8 FRAME_MAGIC_1 = 'R';
+    constexpr u8 FRAME_VERSION = 1;
+    constexpr size_t FRAME_HEADER_SIZE = 16;
+    constexpr size_t TILE_RECT_SIZE = 8;
+    constexpr size_t VIEW_INFO_SIZE = 4;
+
+    /**
+     * Size of the header plus the part size table.
+     */
+    [[nodiscard]] constexpr size_t frame_prefix_size(size_t part_count) noexcept
+    {
+        return FRAME_HEADER_SIZE + part_count * 4;
+    }
+
+    namespace detail
+    {
+        VRS_FORCEINLINE void store_le16(u8 *dst, u32 v) noexcept
+        {
+            dst[0] = static_cast<u8>(v);
+            dst[1] = static_cast<u8>(v >> 8);
+        }
+
+        VRS_FORCEINLINE void store_le32(u8 *dst, u32 v) noexcept
+        {
+            dst[0] = static_cast<u8>(v);
+            dst[1] = static_cast<u8>(v >> 8);
+            dst[2] = static_cast<u8>(v >> 16);
+            dst[3] = static_cast<u8>(v >> 24);
+        }
+    } // namespace detail
+
+    /**
+     * Write the frame header and part size table.
+     * @return Bytes written (frame_prefix_size(part_sizes.size()))
+     */
+    inline size_t write_frame_prefix(
+        u8 *dst,
+        FrameType type,
+        u32 width, u32 height,
+        u32 frame_id,
+        std::span<const u32> part_sizes,
+        u16 flags = 0) noexcept
+    {
+        dst[0] = FRAME_MAGIC_0;
+        dst[1] = FRAME_MAGIC_1;
+        dst[2] = FRAME_VERSION;
+        dst[3] = static_cast<u8>(type);
+        detail::store_le16(dst + 4, width);
+        detail::store_le16(dst + 6, height);
+        detail::store_le32(dst + 8, frame_id);
+        detail::store_le16(dst + 12, static_cast<u32>(part_sizes.size()));
+        detail::store_le16(dst + 14, flags);
+
+        u8 *sizes = dst + FRAME_HEADER_SIZE;
+        for (u32 size : part_sizes)
+        {
+            detail::store_le32(sizes, size);
+            sizes += 4;
+        }
+        return frame_prefix_size(part_sizes.size());
+    }
+
+    /**
+     * Write the TILES rect table (directly after the part size table).
+     * @return Bytes written
+     */
+    inline size_t write_tile_rects(u8 *dst, std::span<const TileRect> rects) noexcept
+    {
+        for (const TileRect &rect : rects)
+        {
+            detail::store_le16(dst, rect.x);
+            detail::store_le16(dst + 2, rect.y);
+            detail::store_le16(dst + 4, rect.w);
+            detail::store_le16(dst + 6, rect.h);
+            dst += TILE_RECT_SIZE;
+        }
+        return rects.size() * TILE_RECT_SIZE;
+    }
+
+    /**
+     * Write the SINGLE_VIEW eye layout (directly after the part size table).
+     * @return Bytes written (VIEW_INFO_SIZE)
+     */
+    inline size_t write_view_info(u8 *dst, u32 disparity, u32 eye_width) noexcept
+    {
+        detail::store_le16(dst, disparity);
+        detail::store_le16(dst + 2, eye_width);
+        return VIEW_INFO_SIZE;
+    }
+
+} // namespace vrs
@@ -8,6 +8,8 @@
 #include "../core/common.hpp"
 #include "../core/config.hpp"
 #include "../core/spsc_queue.hpp"
+#include "../core/memory_pool.hpp"
+#include "../core/stats_counters.hpp"
 
 #include <boost/asio.hpp>
 #include <boost/beast/core.hpp>
@@ -51,6 +53,7 @@ namespace vrs
     {
         u64 total_frames_sent = 0;
         u64 total_bytes_sent = 0;
+        u64 total_frames_dropped = 0; // Client write queue full
         u32 connected_clients = 0;
         f64 current_fps = 0;
         f64 avg_latency_ms = 0;
@@ -90,7 +93,7 @@ namespace vrs
         /**
          * Send a binary frame.
          */
-        void send_frame(std::shared_ptr<std::vector<u8>> data);
+        void send_frame(CompressedFramePtr frame);
 
         /**
          * Close the connection.
@@ -124,9 +127,13 @@ namespace vrs
         beast::flat_buffer read_buffer_;
 
         // Write queue (lock-free SPSC)
-        SPSCQueue<std::shared_ptr<std::vector<u8>>, 16> write_queue_;
+        SPSCQueue<CompressedFramePtr, 16> write_queue_;
         std::atomic<bool> writing_{false};
-        std::shared_ptr<std::vector<u8>> current_write_;
+        CompressedFramePtr current_write_;
+
+        // Delta frames are skipped until a full frame arrives (new session or after a drop).
+        // Only touched by the thread calling send_frame().
+        bool awaiting_keyframe_ = true;
 
         std::atomic<bool> closing_{false};
     };
@@ -155,16 +162,18 @@ namespace vrs
 
         /**
          * Push a frame to all connected clients.
+         * The bytes are copied into a frame from copy_pool_.
          */
         void push_frame(const u8 *data, size_t size);
 
         /**
-         * Push a frame using shared pointer (zero-copy for multiple clients).
+         * Push a pooled frame (zero-copy for multiple clients).
+         * The frame returns to its pool once every session has sent it.
          */
-        void push_frame(std::shared_ptr<std::vector<u8>> data);
+        void push_frame(CompressedFramePtr frame);
 
         /**
-         * Get server statistics.
+         * Get server statistics (sums the counters; never blocks senders).
          */
         [[nodiscard]] ServerStats stats() const;
 
@@ -198,18 +207,22 @@ namespace vrs
          */
         using ClientCallback = std::function<void(const ClientInfo &)>;
         using StatsCallback = std::function<void(const ServerStats &)>;
+        using KeyframeCallback = std::function<void()>;
 
         void set_on_client_connect(ClientCallback cb) { on_connect_ = std::move(cb); }
         void set_on_client_disconnect(ClientCallback cb) { on_disconnect_ = std::move(cb); }
         void set_on_stats_update(StatsCallback cb) { on_stats_ = std::move(cb); }
+        void set_on_keyframe_request(KeyframeCallback cb) { on_keyframe_request_ = std::move(cb); }
 
         // Internal - called by sessions
         void register_session(std::shared_ptr<WebSocketSession> session);
         void unregister_session(const std::string &id);
         void on_client_connected(const ClientInfo &info);
         void on_client_disconnected(const ClientInfo &info);
-        void add_bytes_sent(u64 bytes);
-        void add_frame_sent();
+        void request_keyframe();
+        void add_bytes_sent(u64 bytes) noexcept { bytes_sent_.add(bytes); }
+        void add_frame_sent() noexcept { frames_sent_.add(); }
+        void add_frame_dropped() noexcept { frames_dropped_.add(); }
 
     private:
         void do_accept();
@@ -227,13 +240,21 @@ namespace vrs
         std::atomic<bool> running_{false};
         std::vector<std::thread> io_threads_;
 
-        ServerStats stats_;
-        mutable std::mutex stats_mutex_;
-        FPSCounter fps_counter_;
+        CompressedFramePool copy_pool_{512 * 1024, 4}; // push_frame(data, size)
+
+        // Statistics: bumped by every IO thread on each write completion
+        ShardedCounter bytes_sent_;
+        ShardedCounter frames_sent_;
+        ShardedCounter frames_dropped_;
+        std::atomic<u32> connected_clients_{0};
+        std::atomic<f64> current_fps_{0};
+        FPSCounter fps_counter_; // push_frame() only
+        TimePoint start_time_;
 
         ClientCallback on_connect_;
         ClientCallback on_disconnect_;
         StatsCallback on_stats_;
+        KeyframeCallback on_keyframe_request_;
 
         std::string server_ip_;
     };
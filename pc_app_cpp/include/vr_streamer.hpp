@@ -5,12 +5,20 @@
  */
 
 #include "core/common.hpp"
+#include "core/allocation_counter.hpp"
 #include "core/config.hpp"
 #include "core/memory_pool.hpp"
+#include "core/snapshot_cell.hpp"
 #include "core/spsc_queue.hpp"
+#include "core/stats_counters.hpp"
+#include "core/thread_placement.hpp"
 #include "capture/dxgi_capture.hpp"
 #include "encoder/stereo_processor.hpp"
 #include "encoder/jpeg_encoder.hpp"
+#include "encoder/parallel_jpeg_encoder.hpp"
+#include "encoder/raw_encoder.hpp"
+#include "encoder/h264_encoder.hpp"
+#include "encoder/encode_workers.hpp"
 #include "network/websocket_server.hpp"
 #include "network/http_server.hpp"
 
@@ -25,12 +33,19 @@ namespace vrs
         // Capture
         f64 capture_fps = 0;
         f64 capture_time_ms = 0;
+        u64 frames_backpressured = 0; // Dropped: every frame or output buffer was in use
+        u64 frame_pool_bytes = 0;     // Capture buffers for the current size class
 
         // Encoding
         f64 encode_fps = 0;
         f64 stereo_time_ms = 0;
         f64 jpeg_time_ms = 0;
         f64 total_encode_time_ms = 0;
+        f64 huffman_table_age_ms = 0; // Learned Huffman tables (0 = Annex K)
+        f64 huffman_gain_percent = 0;
+        u32 encode_workers = 0;     // Workers currently taking frames
+        u64 frames_superseded = 0;  // Encoded, then dropped for a newer frame
+        u64 frames_refined = 0;     // High-quality resends of a static screen
 
         // Network
         f64 stream_fps = 0;
@@ -45,16 +60,22 @@ namespace vrs
         u64 bytes_sent = 0;
         f64 uptime_seconds = 0;
 
+        // Debug (ENABLE_ALLOC_COUNTER builds, else 0)
+        u64 heap_allocations = 0;      // operator new calls since start, all threads
+        f64 allocations_per_frame = 0; // Over the last second, per encoded frame
+
         // Quality
-        u32 current_quality = 0;
-        f32 downscale_factor = 0;
+        u32 current_quality = 0;    // Quality of the last frame (rate control may move it)
+        u32 frame_budget_bytes = 0; // Rate control target (0 = fixed quality)
+        u64 last_frame_bytes = 0;   // Size of the last frame
+        f32 downscale_factor = 0;   // Scale of the last frame (dynamic_resolution may lower it)
         bool gpu_encoding = false;
         bool gpu_stereo = false;
     };
 
     /**
      * VR Streaming Application.
-     * High-performance pipeline: Capture -> Encode -> Stream
+     * High-performance pipeline: Capture -> Encode (N workers, reordered) -> Stream
      */
     class VRStreamerApp
     {
@@ -91,19 +112,27 @@ namespace vrs
         [[nodiscard]] bool streaming() const { return streaming_.load(); }
 
         /**
-         * Get current statistics.
+         * Get current statistics (the last snapshot, refreshed once a second).
          */
         [[nodiscard]] PipelineStats stats() const;
 
         /**
-         * Update configuration.
+         * Update configuration (any thread). Encoder settings and the frame
+         * rate take effect at each stage's next frame; capture, network and
+         * thread settings need a restart.
          */
         void update_config(const Config &config);
 
         /**
          * Get current configuration.
          */
-        [[nodiscard]] const Config &config() const { return config_; }
+        [[nodiscard]] Config config() const { return *config_.load(); }
+
+        /**
+         * Reload a config file whenever it is saved (checked once a second
+         * by the stats thread). Call before start().
+         */
+        void watch_config(const std::string &filepath);
 
         /**
          * Set capture to a specific monitor.
@@ -167,14 +196,35 @@ namespace vrs
 
     private:
         void capture_loop();
-        void encode_loop();
         void stats_loop();
 
-        Config config_;
+        /**
+         * Reorder buffer sink: frames arrive here in capture order.
+         */
+        void on_frame_encoded(CompressedFramePtr frame);
+
+        /**
+         * frame_budget_auto: size frames to what the clients actually receive.
+         * Cuts to the measured throughput while the server is dropping frames,
+         * otherwise probes upwards slowly (stats thread only).
+         */
+        void update_frame_budget(const ServerStats &server_stats, f64 interval_s);
+
+        /**
+         * Publish config after edit() and hand the changes to the running
+         * stages (any thread).
+         */
+        template <typename Edit>
+        void apply_config(Edit &&edit);
+
+        // Published settings; each thread takes up a new snapshot between frames
+        SnapshotCell<Config> config_;
+        std::mutex config_mutex_; // Orders writers, so stages see changes in publish order
+        std::unique_ptr<ConfigWatcher> config_watcher_; // Stats thread only once started
 
         // Components
         std::unique_ptr<CaptureManager> capture_;
-        std::unique_ptr<VRFrameEncoder> encoder_;
+        std::unique_ptr<EncodeWorkerPool> encoders_;
         std::unique_ptr<StreamingServer> server_;
         std::unique_ptr<HTTPServer> http_server_;
 
@@ -182,14 +232,8 @@ namespace vrs
         std::unique_ptr<FrameBufferPool> frame_pool_;
         std::unique_ptr<CompressedFramePool> compressed_pool_;
 
-        // Frame queues (capture -> encode -> stream)
-        static constexpr size_t QUEUE_SIZE = 4;
-        SPSCQueue<FrameBufferPool::BufferPtr, QUEUE_SIZE> capture_queue_;
-        SPSCQueue<CompressedFramePtr, QUEUE_SIZE> encode_queue_;
-
-        // Threads
+        // Threads (encoding runs on the worker pool's threads)
         std::thread capture_thread_;
-        std::thread encode_thread_;
         std::thread stats_thread_;
 
         // State
@@ -197,13 +241,30 @@ namespace vrs
         std::atomic<bool> streaming_{false};
         std::atomic<bool> stop_requested_{false};
 
-        // Statistics
-        PipelineStats stats_;
-        mutable std::mutex stats_mutex_;
-        FPSCounter capture_fps_;
-        FPSCounter encode_fps_;
+        // Statistics: the capture thread and the encode sink each bump their
+        // own cache line; the stats thread reads them and publishes stats_
+        struct alignas(CACHE_LINE_SIZE) StageCounters
+        {
+            std::atomic<u64> frames{0};
+            std::atomic<f64> fps{0};
+            std::atomic<f64> time_ms{0};
+        };
+        StageCounters capture_counters_;
+        StageCounters encode_counters_;
+        SeqLock<PipelineStats> stats_;
+        FPSCounter capture_fps_; // Capture thread only
+        FPSCounter encode_fps_;  // on_frame_encoded() only (serialised by the reorder buffer)
         Timer uptime_timer_;
 
+        // Idle refinement: unchanged captures before a refined frame (0 = off)
+        std::atomic<u32> refine_static_frames_{0};
+        std::atomic<bool> screen_static_{false};
+
+        // Automatic frame budget (stats thread only)
+        u32 auto_frame_budget_ = 0;
+        u64 budget_bytes_sent_ = 0;
+        u64 budget_frames_dropped_ = 0;
+
         // Callbacks
         StatsCallback on_stats_;
         ClientCallback on_client_connect_;
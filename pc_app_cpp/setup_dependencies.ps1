@@ -92,7 +92,8 @@ if (-not $SkipVcpkg) {
         "boost-asio:x64-windows",
         "boost-beast:x64-windows",
         "boost-system:x64-windows",
-        "libjpeg-turbo:x64-windows"
+        "libjpeg-turbo:x64-windows",
+        "x264:x64-windows"
     )
     
     foreach ($pkg in $packages) {
@@ -0,0 +1,75 @@
+/**
+ * VR Streamer - Allocation Counter Implementation
+ * Replaces the global operator new/delete in counting builds. Aligned forms
+ * are left to the runtime (they pair with platform-specific frees), and
+ * only this codebase's make_aligned_array() bypasses operator new.
+ */
+
+#include "core/allocation_counter.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace vrs
+{
+
+#ifdef VRS_COUNT_ALLOCATIONS
+
+    namespace
+    {
+        std::atomic<u64> g_allocations{0};
+
+        void *counted_alloc(size_t size) noexcept
+        {
+            g_allocations.fetch_add(1, std::memory_order_relaxed);
+            return std::malloc(size ? size : 1);
+        }
+    } // namespace
+
+    u64 allocation_count() noexcept
+    {
+        return g_allocations.load(std::memory_order_relaxed);
+    }
+
+#else
+
+    u64 allocation_count() noexcept
+    {
+        return 0;
+    }
+
+#endif
+
+} // namespace vrs
+
+#ifdef VRS_COUNT_ALLOCATIONS
+
+void *operator new(size_t size)
+{
+    if (void *ptr = vrs::counted_alloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return vrs::counted_alloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return vrs::counted_alloc(size);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+
+#endif // VRS_COUNT_ALLOCATIONS
@@ -5,6 +5,7 @@
 
 #include "core/config.hpp"
 #include <fstream>
+#include <iomanip>
 #include <sstream>
 
 namespace vrs
@@ -18,6 +19,12 @@ namespace vrs
             return false;
         }
 
+        save(file);
+        return file.good();
+    }
+
+    void Config::save(std::ostream &file) const
+    {
         file << "# VR Streamer Configuration\n\n";
 
         file << "capture:\n"
@@ -27,6 +34,8 @@ namespace vrs
              << "  use_gpu_capture: " << (capture.use_gpu_capture ? "true" : "false") << "\n"
              << "  frame_buffer_count: " << capture.frame_buffer_count << "\n"
              << "  wait_for_vsync: " << (capture.wait_for_vsync ? "true" : "false") << "\n"
+             << "  huge_pages: " << (capture.huge_pages ? "true" : "false") << "\n"
+             << "  lock_frames: " << (capture.lock_frames ? "true" : "false") << "\n"
              << "\n";
 
         file << "encoder:\n"
@@ -56,8 +65,47 @@ namespace vrs
         }
         file << "\n";
 
-        file << "  vr_enabled: " << (encoder.vr_enabled ? "true" : "false") << "\n"
+        file << "  dynamic_resolution: " << (encoder.dynamic_resolution ? "true" : "false") << "\n"
+             << "  min_downscale: " << encoder.min_downscale << "\n"
+             << "  roi_enabled: " << (encoder.roi_enabled ? "true" : "false") << "\n"
+             << "  roi_inner_radius: " << encoder.roi_inner_radius << "\n"
+             << "  roi_outer_radius: " << encoder.roi_outer_radius << "\n"
+             << "  roi_max_step: " << encoder.roi_max_step << "\n"
+             << "  frame_budget_bytes: " << encoder.frame_budget_bytes << "\n"
+             << "  frame_budget_auto: " << (encoder.frame_budget_auto ? "true" : "false") << "\n"
+             << "  rate_min_quality: " << encoder.rate_min_quality << "\n"
+             << "  rate_max_quality: " << encoder.rate_max_quality << "\n"
+             << "  refine_enabled: " << (encoder.refine_enabled ? "true" : "false") << "\n"
+             << "  refine_static_frames: " << encoder.refine_static_frames << "\n"
+             << "  refine_quality: " << encoder.refine_quality << "\n"
+             << "  refine_full_chroma: " << (encoder.refine_full_chroma ? "true" : "false") << "\n"
+             << "  full_chroma: " << (encoder.full_chroma ? "true" : "false") << "\n"
+             << "  jpeg_threads: " << encoder.jpeg_threads << "\n"
+             << "  huffman_interval_ms: " << encoder.huffman_interval_ms << "\n"
+             << "  encode_workers: " << encoder.encode_workers << "\n"
+             << "  fused_encode: " << (encoder.fused_encode ? "true" : "false") << "\n"
+             << "  vr_enabled: " << (encoder.vr_enabled ? "true" : "false") << "\n"
              << "  eye_separation: " << encoder.eye_separation << "\n"
+             << "  output_mode: ";
+        switch (encoder.output_mode)
+        {
+        case EncoderConfig::OutputMode::SBS:
+            file << "sbs";
+            break;
+        case EncoderConfig::OutputMode::DUAL_EYE:
+            file << "dual_eye";
+            break;
+        case EncoderConfig::OutputMode::TILES:
+            file << "tiles";
+            break;
+        case EncoderConfig::OutputMode::SINGLE_VIEW:
+            file << "single_view";
+            break;
+        }
+        file << "\n";
+
+        file << "  tile_size: " << encoder.tile_size << "\n"
+             << "  tile_keyframe_interval: " << encoder.tile_keyframe_interval << "\n"
              << "  use_gpu: " << (encoder.use_gpu ? "true" : "false") << "\n"
              << "  gpu_device_id: " << encoder.gpu_device_id << "\n"
              << "  use_nvenc: " << (encoder.use_nvenc ? "true" : "false") << "\n"
@@ -76,20 +124,32 @@ namespace vrs
              << "  send_buffer_size: " << network.send_buffer_size << "\n"
              << "  ping_interval: " << network.ping_interval << "\n"
              << "  use_tcp_nodelay: " << (network.use_tcp_nodelay ? "true" : "false") << "\n"
-             << "  use_cork: " << (network.use_cork ? "true" : "false") << "\n";
+             << "  use_cork: " << (network.use_cork ? "true" : "false") << "\n"
+             << "\n";
 
-        return file.good();
+        file << "threads:\n"
+             << "  capture_cores: \"" << threads.capture_cores << "\"\n"
+             << "  encode_cores: \"" << threads.encode_cores << "\"\n"
+             << "  network_cores: \"" << threads.network_cores << "\"\n"
+             << "  background_cores: \"" << threads.background_cores << "\"\n"
+             << "  avoid_smt: " << (threads.avoid_smt ? "true" : "false") << "\n"
+             << "  realtime: " << (threads.realtime ? "true" : "false") << "\n"
+             << "  background_nice: " << threads.background_nice << "\n";
     }
 
     Config Config::load(const std::string &filepath)
     {
-        Config config;
-
         std::ifstream file(filepath);
         if (!file)
         {
             return default_config();
         }
+        return load(file);
+    }
+
+    Config Config::load(std::istream &file)
+    {
+        Config config;
 
         // Simple YAML parser (for our specific format)
         std::string line;
@@ -161,6 +221,14 @@ namespace vrs
                 {
                     config.capture.wait_for_vsync = parse_bool(value);
                 }
+                else if (line.find("huge_pages:") != std::string::npos)
+                {
+                    config.capture.huge_pages = parse_bool(value);
+                }
+                else if (line.find("lock_frames:") != std::string::npos)
+                {
+                    config.capture.lock_frames = parse_bool(value);
+                }
             }
             else if (section == "encoder")
             {
@@ -193,6 +261,82 @@ namespace vrs
                     else if (value == "raw")
                         config.encoder.method = EncoderConfig::Method::RAW;
                 }
+                else if (line.find("dynamic_resolution:") != std::string::npos)
+                {
+                    config.encoder.dynamic_resolution = parse_bool(value);
+                }
+                else if (line.find("min_downscale:") != std::string::npos)
+                {
+                    config.encoder.min_downscale = std::stof(value);
+                }
+                else if (line.find("roi_enabled:") != std::string::npos)
+                {
+                    config.encoder.roi_enabled = parse_bool(value);
+                }
+                else if (line.find("roi_inner_radius:") != std::string::npos)
+                {
+                    config.encoder.roi_inner_radius = std::stof(value);
+                }
+                else if (line.find("roi_outer_radius:") != std::string::npos)
+                {
+                    config.encoder.roi_outer_radius = std::stof(value);
+                }
+                else if (line.find("roi_max_step:") != std::string::npos)
+                {
+                    config.encoder.roi_max_step = std::stoi(value);
+                }
+                else if (line.find("frame_budget_bytes:") != std::string::npos)
+                {
+                    config.encoder.frame_budget_bytes = std::stoi(value);
+                }
+                else if (line.find("frame_budget_auto:") != std::string::npos)
+                {
+                    config.encoder.frame_budget_auto = parse_bool(value);
+                }
+                else if (line.find("rate_min_quality:") != std::string::npos)
+                {
+                    config.encoder.rate_min_quality = std::stoi(value);
+                }
+                else if (line.find("rate_max_quality:") != std::string::npos)
+                {
+                    config.encoder.rate_max_quality = std::stoi(value);
+                }
+                else if (line.find("refine_enabled:") != std::string::npos)
+                {
+                    config.encoder.refine_enabled = parse_bool(value);
+                }
+                else if (line.find("refine_static_frames:") != std::string::npos)
+                {
+                    config.encoder.refine_static_frames = std::stoi(value);
+                }
+                else if (line.find("refine_quality:") != std::string::npos)
+                {
+                    config.encoder.refine_quality = std::stoi(value);
+                }
+                else if (line.find("refine_full_chroma:") != std::string::npos)
+                {
+                    config.encoder.refine_full_chroma = parse_bool(value);
+                }
+                else if (line.find("full_chroma:") != std::string::npos)
+                {
+                    config.encoder.full_chroma = parse_bool(value);
+                }
+                else if (line.find("encode_workers:") != std::string::npos)
+                {
+                    config.encoder.encode_workers = std::stoi(value);
+                }
+                else if (line.find("fused_encode:") != std::string::npos)
+                {
+                    config.encoder.fused_encode = parse_bool(value);
+                }
+                else if (line.find("jpeg_threads:") != std::string::npos)
+                {
+                    config.encoder.jpeg_threads = std::stoi(value);
+                }
+                else if (line.find("huffman_interval_ms:") != std::string::npos)
+                {
+                    config.encoder.huffman_interval_ms = std::stoi(value);
+                }
                 else if (line.find("vr_enabled:") != std::string::npos)
                 {
                     config.encoder.vr_enabled = parse_bool(value);
@@ -201,6 +345,25 @@ namespace vrs
                 {
                     config.encoder.eye_separation = std::stof(value);
                 }
+                else if (line.find("output_mode:") != std::string::npos)
+                {
+                    if (value == "sbs")
+                        config.encoder.output_mode = EncoderConfig::OutputMode::SBS;
+                    else if (value == "dual_eye")
+                        config.encoder.output_mode = EncoderConfig::OutputMode::DUAL_EYE;
+                    else if (value == "tiles")
+                        config.encoder.output_mode = EncoderConfig::OutputMode::TILES;
+                    else if (value == "single_view")
+                        config.encoder.output_mode = EncoderConfig::OutputMode::SINGLE_VIEW;
+                }
+                else if (line.find("tile_keyframe_interval:") != std::string::npos)
+                {
+                    config.encoder.tile_keyframe_interval = std::stoi(value);
+                }
+                else if (line.find("tile_size:") != std::string::npos)
+                {
+                    config.encoder.tile_size = std::stoi(value);
+                }
                 else if (line.find("use_gpu:") != std::string::npos)
                 {
                     config.encoder.use_gpu = parse_bool(value);
@@ -269,9 +432,110 @@ namespace vrs
                     config.network.use_cork = parse_bool(value);
                 }
             }
+            else if (section == "threads")
+            {
+                if (line.find("capture_cores:") != std::string::npos)
+                {
+                    config.threads.capture_cores = value;
+                }
+                else if (line.find("encode_cores:") != std::string::npos)
+                {
+                    config.threads.encode_cores = value;
+                }
+                else if (line.find("network_cores:") != std::string::npos)
+                {
+                    config.threads.network_cores = value;
+                }
+                else if (line.find("background_cores:") != std::string::npos)
+                {
+                    config.threads.background_cores = value;
+                }
+                else if (line.find("avoid_smt:") != std::string::npos)
+                {
+                    config.threads.avoid_smt = parse_bool(value);
+                }
+                else if (line.find("realtime:") != std::string::npos)
+                {
+                    config.threads.realtime = parse_bool(value);
+                }
+                else if (line.find("background_nice:") != std::string::npos)
+                {
+                    config.threads.background_nice = std::stoi(value);
+                }
+            }
         }
 
         return config;
     }
 
+    void Config::apply_changes(const Config &before, const Config &after)
+    {
+        // Line by line over the saved form, so every field the file holds is covered;
+        // full float precision so unchanged values read back exactly
+        auto lines = [](const Config &config)
+        {
+            std::ostringstream out;
+            out << std::setprecision(std::numeric_limits<f32>::max_digits10);
+            config.save(out);
+            std::vector<std::string> result;
+            std::istringstream in(out.str());
+            for (std::string line; std::getline(in, line);)
+            {
+                result.push_back(std::move(line));
+            }
+            return result;
+        };
+
+        std::vector<std::string> merged = lines(*this);
+        const std::vector<std::string> old_lines = lines(before);
+        const std::vector<std::string> new_lines = lines(after);
+
+        std::ostringstream text;
+        for (size_t i = 0; i < merged.size(); ++i)
+        {
+            text << (old_lines[i] != new_lines[i] ? new_lines[i] : merged[i]) << "\n";
+        }
+        std::istringstream in(text.str());
+        *this = load(in);
+    }
+
+    ConfigWatcher::ConfigWatcher(std::string filepath)
+        : filepath_(std::move(filepath))
+    {
+        std::error_code error;
+        last_write_ = std::filesystem::last_write_time(filepath_, error);
+        try
+        {
+            last_read_ = Config::load(filepath_);
+        }
+        catch (const std::exception &)
+        {
+            last_read_ = Config::default_config(); // Unreadable at start: the next good read is compared to the defaults
+        }
+    }
+
+    std::optional<ConfigWatcher::Change> ConfigWatcher::poll()
+    {
+        std::error_code error;
+        const auto write_time = std::filesystem::last_write_time(filepath_, error);
+        if (error || write_time == last_write_)
+        {
+            return std::nullopt; // Missing (mid-save by some editors) or unchanged
+        }
+        last_write_ = write_time;
+
+        try
+        {
+            Change change{last_read_, Config::load(filepath_)};
+            last_read_ = change.after;
+            return change;
+        }
+        catch (const std::exception &e)
+        {
+            // Caught half-written; the rest of the save changes the time again
+            VRS_LOG_WARN(std::format("Could not reload {}: {}", filepath_, e.what()));
+            return std::nullopt;
+        }
+    }
+
 } // namespace vrs
@@ -0,0 +1,211 @@
+/**
+ * VR Streamer - Frame Arena Implementation
+ */
+
+#include "core/frame_arena.hpp"
+
+#ifdef _WIN32
+#include <psapi.h>
+#else
+#include <sys/mman.h>
+#include <sys/resource.h>
+#endif
+
+namespace vrs
+{
+
+    namespace
+    {
+        constexpr size_t round_up(size_t value, size_t multiple) noexcept
+        {
+            return (value + multiple - 1) / multiple * multiple;
+        }
+
+#ifdef _WIN32
+        /**
+         * MEM_LARGE_PAGES needs SeLockMemoryPrivilege granted to the user
+         * and enabled in the process token.
+         */
+        bool enable_lock_memory_privilege()
+        {
+            HANDLE token = nullptr;
+            if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+                return false;
+
+            TOKEN_PRIVILEGES privileges{};
+            privileges.PrivilegeCount = 1;
+            privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+            bool enabled = LookupPrivilegeValueW(nullptr, L"SeLockMemoryPrivilege", &privileges.Privileges[0].Luid) &&
+                           AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+                           GetLastError() == ERROR_SUCCESS; // Succeeds with ERROR_NOT_ALL_ASSIGNED if not granted
+            CloseHandle(token);
+            return enabled;
+        }
+#endif
+    } // namespace
+
+    FrameArena::FrameArena(size_t block_size, size_t block_count, const Options &options)
+        : block_stride_(round_up(std::max<size_t>(block_size, 1), HUGE_PAGE_SIZE)),
+          block_count_(block_count)
+    {
+        map(options.huge_pages);
+        prefault();
+        if (options.lock)
+        {
+            lock();
+        }
+    }
+
+    FrameArena::~FrameArena()
+    {
+        if (!base_)
+            return;
+#ifdef _WIN32
+        if (locked_ && backing_ != Backing::HUGE_PAGES)
+        {
+            VirtualUnlock(base_, size_bytes());
+        }
+        VirtualFree(base_, 0, MEM_RELEASE);
+#else
+        munmap(base_, mapped_size_); // Drops any mlock with it
+#endif
+    }
+
+    const char *FrameArena::backing_name(Backing backing) noexcept
+    {
+        switch (backing)
+        {
+        case Backing::HUGE_PAGES:
+            return "huge pages";
+        case Backing::TRANSPARENT_HUGE_PAGES:
+            return "transparent huge pages";
+        default:
+            return "4 KB pages";
+        }
+    }
+
+    void FrameArena::map(bool huge_pages)
+    {
+        const size_t size = size_bytes();
+
+#ifdef _WIN32
+        if (huge_pages)
+        {
+            const size_t large_page = GetLargePageMinimum();
+            if (large_page > 0 && enable_lock_memory_privilege())
+            {
+                mapped_size_ = round_up(size, large_page);
+                base_ = static_cast<u8 *>(VirtualAlloc(nullptr, mapped_size_,
+                                                       MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE));
+                if (base_)
+                {
+                    // Large pages are physically backed and never paged out
+                    backing_ = Backing::HUGE_PAGES;
+                    locked_ = true;
+                    return;
+                }
+            }
+        }
+
+        mapped_size_ = size;
+        base_ = static_cast<u8 *>(VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+        if (!base_)
+            throw std::bad_alloc();
+        backing_ = Backing::REGULAR_PAGES;
+#else
+        if (huge_pages)
+        {
+#ifdef MAP_HUGETLB
+            void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (mapping != MAP_FAILED)
+            {
+                base_ = static_cast<u8 *>(mapping);
+                mapped_size_ = size;
+                backing_ = Backing::HUGE_PAGES;
+                return;
+            }
+#endif
+        }
+
+        // Over-map by one huge page so the arena can start on a 2 MB boundary
+        const size_t padded = size + HUGE_PAGE_SIZE;
+        void *mapping = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED)
+            throw std::bad_alloc();
+
+        auto *raw = static_cast<u8 *>(mapping);
+        auto *aligned = reinterpret_cast<u8 *>(round_up(reinterpret_cast<uintptr_t>(raw), HUGE_PAGE_SIZE));
+        if (aligned > raw)
+        {
+            munmap(raw, aligned - raw);
+        }
+        if (const size_t tail = padded - (aligned - raw) - size; tail > 0)
+        {
+            munmap(aligned + size, tail);
+        }
+        base_ = aligned;
+        mapped_size_ = size;
+        backing_ = Backing::REGULAR_PAGES;
+
+#ifdef MADV_HUGEPAGE
+        if (huge_pages && madvise(base_, size, MADV_HUGEPAGE) == 0)
+        {
+            backing_ = Backing::TRANSPARENT_HUGE_PAGES;
+        }
+#endif
+#endif
+    }
+
+    void FrameArena::prefault() noexcept
+    {
+        // One write per 4 KB page: commits it now instead of mid-frame
+        volatile u8 *bytes = base_;
+        const size_t size = size_bytes();
+        for (size_t offset = 0; offset < size; offset += PAGE_SIZE)
+        {
+            bytes[offset] = 0;
+        }
+    }
+
+    void FrameArena::lock()
+    {
+        if (locked_)
+            return;
+
+        const size_t size = size_bytes();
+#ifdef _WIN32
+        // VirtualLock is limited by the minimum working set; make room first
+        SIZE_T min_set = 0;
+        SIZE_T max_set = 0;
+        HANDLE process = GetCurrentProcess();
+        if (GetProcessWorkingSetSize(process, &min_set, &max_set))
+        {
+            SetProcessWorkingSetSize(process, min_set + size, max_set + size);
+        }
+        locked_ = VirtualLock(base_, size) != 0;
+#else
+        locked_ = mlock(base_, size) == 0;
+#endif
+        if (!locked_)
+        {
+            VRS_LOG_WARN(std::format("Could not lock {} MB of frame buffers in memory", size >> 20));
+        }
+    }
+
+    u64 page_fault_count() noexcept
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return 0;
+        return counters.PageFaultCount;
+#else
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+        return static_cast<u64>(usage.ru_minflt) + static_cast<u64>(usage.ru_majflt);
+#endif
+    }
+
+} // namespace vrs
@@ -0,0 +1,339 @@
+/**
+ * VR Streamer - Thread Placement Implementation
+ */
+
+#include "core/thread_placement.hpp"
+#include "core/config.hpp"
+#include <charconv>
+#include <fstream>
+#include <mutex>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#endif
+
+namespace vrs
+{
+
+    namespace
+    {
+        constexpr const char *ROLE_NAMES[] = {"capture", "encode", "network", "background"};
+
+        struct Plan
+        {
+            std::array<std::vector<u32>, static_cast<size_t>(ThreadRole::COUNT)> cpus; // Empty = leave as is
+            bool realtime = false;
+            i32 background_nice = 10;
+        };
+
+        std::mutex g_plan_mutex;
+        Plan g_plan;
+
+        [[nodiscard]] bool latency_critical(ThreadRole role) noexcept
+        {
+            return role == ThreadRole::CAPTURE || role == ThreadRole::ENCODE;
+        }
+
+        /**
+         * CPUs this process may run on, as it started.
+         */
+        std::vector<u32> process_cpus()
+        {
+            std::vector<u32> cpus;
+#ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(set), &set) == 0)
+            {
+                for (u32 cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                {
+                    if (CPU_ISSET(cpu, &set))
+                        cpus.push_back(cpu);
+                }
+            }
+#elif defined(_WIN32)
+            DWORD_PTR process_mask = 0;
+            DWORD_PTR system_mask = 0;
+            if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+            {
+                for (u32 cpu = 0; cpu < 64; ++cpu)
+                {
+                    if (process_mask & (DWORD_PTR{1} << cpu))
+                        cpus.push_back(cpu);
+                }
+            }
+#endif
+            return cpus;
+        }
+
+        /**
+         * Lowest-numbered logical CPU of each physical core.
+         */
+        std::vector<u32> primary_cpus(const std::vector<u32> &online)
+        {
+            std::vector<u32> primaries;
+#ifdef __linux__
+            for (u32 cpu : online)
+            {
+                std::ifstream file(std::format("/sys/devices/system/cpu/cpu{}/topology/thread_siblings_list", cpu));
+                std::string siblings;
+                if (!std::getline(file, siblings))
+                {
+                    primaries.push_back(cpu); // Topology unknown: treat as its own core
+                    continue;
+                }
+                const auto list = ThreadPlacement::parse_cpu_list(siblings);
+                if (list.empty() || *std::min_element(list.begin(), list.end()) == cpu)
+                    primaries.push_back(cpu);
+            }
+#elif defined(_WIN32)
+            DWORD length = 0;
+            GetLogicalProcessorInformation(nullptr, &length);
+            std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+            if (info.empty() || !GetLogicalProcessorInformation(info.data(), &length))
+                return online;
+            for (const auto &entry : info)
+            {
+                if (entry.Relationship != RelationProcessorCore || entry.ProcessorMask == 0)
+                    continue;
+                u32 first = 0;
+                while (!(entry.ProcessorMask & (ULONG_PTR{1} << first)))
+                    ++first;
+                if (std::find(online.begin(), online.end(), first) != online.end())
+                    primaries.push_back(first);
+            }
+            std::sort(primaries.begin(), primaries.end());
+#else
+            primaries = online;
+#endif
+            return primaries;
+        }
+
+        void set_name(std::string_view name)
+        {
+#ifdef __linux__
+            const std::string truncated(name.substr(0, 15));
+            pthread_setname_np(pthread_self(), truncated.c_str());
+#elif defined(_WIN32)
+            const std::wstring wide(name.begin(), name.end());
+            SetThreadDescription(GetCurrentThread(), wide.c_str());
+#else
+            (void)name;
+#endif
+        }
+
+        bool set_affinity(const std::vector<u32> &cpus)
+        {
+#ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (u32 cpu : cpus)
+            {
+                if (cpu < CPU_SETSIZE)
+                    CPU_SET(cpu, &set);
+            }
+            return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+            DWORD_PTR mask = 0;
+            for (u32 cpu : cpus)
+            {
+                if (cpu < 64)
+                    mask |= DWORD_PTR{1} << cpu;
+            }
+            return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+            (void)cpus;
+            return false;
+#endif
+        }
+
+        /**
+         * Apply the role's priority; returns a description of what was achieved.
+         */
+        std::string set_priority(ThreadRole role, const Plan &plan)
+        {
+#ifdef __linux__
+            if (latency_critical(role) && plan.realtime)
+            {
+                sched_param param{};
+                param.sched_priority = role == ThreadRole::CAPTURE ? 10 : 5;
+                if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0)
+                    return std::format("SCHED_FIFO {}", param.sched_priority);
+                return "normal priority (SCHED_FIFO denied)";
+            }
+
+            // Threads inherit a real-time creator's policy; drop it
+            int policy = SCHED_OTHER;
+            sched_param param{};
+            if (pthread_getschedparam(pthread_self(), &policy, &param) == 0 && policy != SCHED_OTHER)
+            {
+                param.sched_priority = 0;
+                pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+            }
+
+            // Niceness is per thread on Linux
+            const int nice = role == ThreadRole::BACKGROUND ? plan.background_nice : 0;
+            setpriority(PRIO_PROCESS, 0, nice);
+            return std::format("nice {}", getpriority(PRIO_PROCESS, 0));
+#elif defined(_WIN32)
+            int priority = THREAD_PRIORITY_NORMAL;
+            if (latency_critical(role) && plan.realtime)
+                priority = role == ThreadRole::CAPTURE ? THREAD_PRIORITY_HIGHEST : THREAD_PRIORITY_ABOVE_NORMAL;
+            else if (role == ThreadRole::BACKGROUND && plan.background_nice > 0)
+                priority = THREAD_PRIORITY_BELOW_NORMAL;
+            SetThreadPriority(GetCurrentThread(), priority);
+            return std::format("priority {}", GetThreadPriority(GetCurrentThread()));
+#else
+            (void)role;
+            (void)plan;
+            return "default priority";
+#endif
+        }
+
+        std::string current_affinity(const std::vector<u32> &requested)
+        {
+#ifdef __linux__
+            (void)requested;
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+                return "unknown";
+            std::vector<u32> cpus;
+            for (u32 cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &set))
+                    cpus.push_back(cpu);
+            }
+            return ThreadPlacement::format_cpu_list(cpus);
+#else
+            // No per-thread query on Windows: the mask set (if any) is what holds
+            return requested.empty() ? "any" : ThreadPlacement::format_cpu_list(requested);
+#endif
+        }
+    } // namespace
+
+    std::vector<u32> ThreadPlacement::parse_cpu_list(std::string_view list)
+    {
+        std::vector<u32> cpus;
+        while (!list.empty())
+        {
+            const size_t comma = list.find(',');
+            std::string_view item = list.substr(0, comma);
+            list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+            while (!item.empty() && item.front() == ' ')
+                item.remove_prefix(1);
+            while (!item.empty() && (item.back() == ' ' || item.back() == '\n'))
+                item.remove_suffix(1);
+
+            u32 first = 0;
+            u32 last = 0;
+            const size_t dash = item.find('-');
+            const std::string_view low = item.substr(0, dash);
+            if (std::from_chars(low.data(), low.data() + low.size(), first).ec != std::errc{})
+                continue;
+            last = first;
+            if (dash != std::string_view::npos)
+            {
+                const std::string_view high = item.substr(dash + 1);
+                if (std::from_chars(high.data(), high.data() + high.size(), last).ec != std::errc{} || last < first)
+                    continue;
+            }
+            for (u32 cpu = first; cpu <= last && cpu < 1024; ++cpu)
+                cpus.push_back(cpu);
+        }
+
+        std::sort(cpus.begin(), cpus.end());
+        cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+        return cpus;
+    }
+
+    std::string ThreadPlacement::format_cpu_list(const std::vector<u32> &cpus)
+    {
+        std::string text;
+        for (size_t i = 0; i < cpus.size();)
+        {
+            size_t run = i;
+            while (run + 1 < cpus.size() && cpus[run + 1] == cpus[run] + 1)
+                ++run;
+
+            if (!text.empty())
+                text += ',';
+            text += std::to_string(cpus[i]);
+            if (run > i)
+                text += (run == i + 1 ? "," : "-") + std::to_string(cpus[run]);
+            i = run + 1;
+        }
+        return text.empty() ? "none" : text;
+    }
+
+    void ThreadPlacement::configure(const ThreadConfig &config)
+    {
+        const std::vector<u32> online = process_cpus();
+        const std::vector<u32> primaries = config.avoid_smt ? primary_cpus(online) : online;
+
+        Plan plan;
+        plan.realtime = config.realtime;
+        plan.background_nice = std::clamp(config.background_nice, -20, 19);
+
+        const std::string *lists[] = {&config.capture_cores, &config.encode_cores,
+                                      &config.network_cores, &config.background_cores};
+        std::string summary;
+        for (size_t i = 0; i < plan.cpus.size(); ++i)
+        {
+            const auto role = static_cast<ThreadRole>(i);
+            const bool narrow = config.avoid_smt && latency_critical(role);
+
+            std::vector<u32> cpus;
+            for (u32 cpu : lists[i]->empty() ? online : parse_cpu_list(*lists[i]))
+            {
+                const auto &allowed = narrow ? primaries : online;
+                if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end())
+                    cpus.push_back(cpu);
+            }
+            if (cpus.empty())
+            {
+                if (!lists[i]->empty())
+                    VRS_LOG_WARN(std::format("No usable CPUs in {}_cores \"{}\", using any", ROLE_NAMES[i], *lists[i]));
+                cpus = online;
+            }
+
+            plan.cpus[i] = std::move(cpus);
+            summary += std::format("{}{} {}", summary.empty() ? "" : ", ", ROLE_NAMES[i], format_cpu_list(plan.cpus[i]));
+        }
+
+        {
+            std::lock_guard lock(g_plan_mutex);
+            g_plan = plan;
+        }
+
+        VRS_LOG_INFO(std::format("Thread placement: {}{}{}", summary,
+                                 config.avoid_smt ? std::format(" ({} of {} CPUs are core primaries)", primaries.size(), online.size()) : "",
+                                 config.realtime ? ", real-time capture/encode" : ""));
+    }
+
+    void ThreadPlacement::apply(ThreadRole role, std::string_view name, bool report)
+    {
+        Plan plan;
+        {
+            std::lock_guard lock(g_plan_mutex);
+            plan = g_plan;
+        }
+
+        set_name(name);
+
+        const auto &cpus = plan.cpus[static_cast<size_t>(role)];
+        const bool pinned = !cpus.empty() && set_affinity(cpus);
+        const std::string priority = set_priority(role, plan);
+
+        if (report)
+        {
+            VRS_LOG_INFO(std::format("Thread {} ({}): CPUs {}{}, {}", name, ROLE_NAMES[static_cast<size_t>(role)],
+                                     current_affinity(pinned ? cpus : std::vector<u32>{}),
+                                     !cpus.empty() && !pinned ? " (affinity refused)" : "", priority));
+        }
+    }
+
+} // namespace vrs
@@ -9,11 +9,64 @@
 namespace vrs
 {
 
+    namespace
+    {
+        /**
+         * memcpy that also returns a 64-bit signature of the data, so an
+         * unchanged capture is spotted without a second pass over the frame.
+         * Four independent lanes keep the multiplies off the critical path.
+         */
+        u64 copy_with_signature(u8 *dst, const u8 *src, size_t size) noexcept
+        {
+            constexpr u64 PRIME = 0x9E3779B97F4A7C15ull;
+            std::array<u64, 4> lanes = {1, 2, 3, 4};
+
+            size_t i = 0;
+            for (; i + 32 <= size; i += 32)
+            {
+                for (size_t lane = 0; lane < 4; ++lane)
+                {
+                    u64 value;
+                    std::memcpy(&value, src + i + lane * 8, 8);
+                    std::memcpy(dst + i + lane * 8, &value, 8);
+                    lanes[lane] = (lanes[lane] ^ value) * PRIME;
+                }
+            }
+            for (; i < size; ++i)
+            {
+                dst[i] = src[i];
+                lanes[0] = (lanes[0] ^ src[i]) * PRIME;
+            }
+
+            u64 signature = size;
+            for (u64 lane : lanes)
+            {
+                signature = (signature ^ lane) * PRIME;
+                signature ^= signature >> 29;
+            }
+            return signature;
+        }
+
+        /**
+         * Refinement applies to whole-frame JPEG output only.
+         */
+        u32 refine_threshold(const EncoderConfig &config) noexcept
+        {
+            const bool jpeg = config.method != EncoderConfig::Method::RAW &&
+                              config.method != EncoderConfig::Method::H264 &&
+                              config.output_mode != EncoderConfig::OutputMode::TILES;
+            return (config.refine_enabled && jpeg) ? std::max(1u, config.refine_static_frames) : 0;
+        }
+    } // namespace
+
     VRStreamerApp::VRStreamerApp() = default;
 
     VRStreamerApp::~VRStreamerApp()
     {
         stop();
+
+        // Workers hold references to the pools and the server
+        encoders_.reset();
     }
 
     bool VRStreamerApp::init(const Config &config)
@@ -23,10 +76,13 @@ namespace vrs
             return true;
         }
 
-        config_ = config;
+        config_.publish(config);
 
         try
         {
+            // Before any pipeline thread starts: each places itself on entry
+            ThreadPlacement::configure(config.threads);
+
             // Initialize capture
             capture_ = std::make_unique<CaptureManager>();
             if (!capture_->init())
@@ -41,9 +97,6 @@ namespace vrs
                 capture_->set_monitor(config.capture.monitor_index);
             }
 
-            // Initialize encoder
-            encoder_ = std::make_unique<VRFrameEncoder>(config.encoder);
-
             // Initialize server
             server_ = std::make_unique<StreamingServer>(config.network);
 
@@ -54,15 +107,32 @@ namespace vrs
                 http_server_ = std::make_unique<HTTPServer>(config.network.http_port, web_root);
             }
 
-            // Initialize memory pools
-            // Estimate max frame size: 4K BGRA = 3840 * 2160 * 4 = ~33MB
-            size_t max_frame_size = 3840 * 2160 * 4;
-            frame_pool_ = std::make_unique<FrameBufferPool>(max_frame_size, 6);
-            compressed_pool_ = std::make_unique<CompressedFramePool>(1024 * 1024, 6);
+            // Initialize memory pools (two frames per encode worker, one kept for idle refinement, plus capture slack)
+            // Capture buffers are sized by the first capture and share one pre-faulted mapping, on 2 MB pages where available
+            const size_t pool_frames = std::max<size_t>(6, EncodeWorkerPool::worker_count_for(config.encoder) * 2 + 3);
+            FrameBufferPool::Options pool_options;
+            pool_options.buffers = pool_frames;
+            pool_options.arena.huge_pages = config.capture.huge_pages;
+            pool_options.arena.lock = config.capture.lock_frames;
+            frame_pool_ = std::make_unique<FrameBufferPool>(pool_options);
+            compressed_pool_ = std::make_unique<CompressedFramePool>( // 1080p until the first capture
+                CompressedFramePool::reserve_for(FrameBufferPool::size_class(1920 * 1080 * 4)), pool_frames);
+
+            // Initialize encode workers
+            encoders_ = std::make_unique<EncodeWorkerPool>(
+                config.encoder, *compressed_pool_,
+                [this](CompressedFramePtr frame)
+                { on_frame_encoded(std::move(frame)); });
+            encoders_->set_frame_interval(1000.0 / std::max(1u, config.capture.target_fps));
+            refine_static_frames_.store(refine_threshold(config.encoder));
 
             // Set server callbacks
             server_->set_on_client_connect([this](const ClientInfo &info)
                                            {
+            if (screen_static_.load() && encoders_) {
+                // Nothing new is coming: give the client the refined frame now
+                encoders_->request_refinement();
+            }
             if (on_client_connect_) {
                 on_client_connect_(info);
             } });
@@ -73,6 +143,15 @@ namespace vrs
                 on_client_disconnect_(info);
             } });
 
+            server_->set_on_keyframe_request([this]
+                                             {
+            if (encoders_) {
+                encoders_->request_keyframe();
+                if (screen_static_.load()) {
+                    encoders_->request_refinement();
+                }
+            } });
+
             initialized_.store(true);
             VRS_LOG_INFO("VR Streamer initialized");
 
@@ -119,7 +198,6 @@ namespace vrs
         streaming_.store(true);
 
         capture_thread_ = std::thread(&VRStreamerApp::capture_loop, this);
-        encode_thread_ = std::thread(&VRStreamerApp::encode_loop, this);
         stats_thread_ = std::thread(&VRStreamerApp::stats_loop, this);
 
         VRS_LOG_INFO("Streaming started");
@@ -140,10 +218,6 @@ namespace vrs
         {
             capture_thread_.join();
         }
-        if (encode_thread_.joinable())
-        {
-            encode_thread_.join();
-        }
         if (stats_thread_.joinable())
         {
             stats_thread_.join();
@@ -172,22 +246,49 @@ namespace vrs
 
     void VRStreamerApp::capture_loop()
     {
+        ThreadPlacement::apply(ThreadRole::CAPTURE, "capture");
         VRS_LOG_INFO("Capture thread started");
 
-        const f64 target_frame_time_ms = 1000.0 / config_.capture.target_fps;
+        SnapshotCell<Config>::Snapshot config;
+        u64 config_version = 0;
+        f64 target_frame_time_ms = 0;
         Timer frame_timer;
 
         CapturedFrame frame;
 
+        // Idle refinement: signature of the last frame handed to the encoders
+        u64 last_signature = 0;
+        bool have_signature = false;
+        u32 static_captures = 0;
+
+        size_t pool_class = 0; // Frame buffer size class the compressed pool is reserved for
+
+        // Counts a capture that showed nothing new; requests refinement once
+        auto note_static = [&]
+        {
+            const u32 threshold = refine_static_frames_.load(std::memory_order_relaxed);
+            if (threshold > 0 && have_signature && ++static_captures == threshold)
+            {
+                encoders_->request_refinement();
+                screen_static_.store(true);
+            }
+        };
+
         while (!stop_requested_.load())
         {
             frame_timer.reset();
 
+            // Frame boundary: take up a new frame rate
+            if (config_.refresh(config, config_version))
+            {
+                target_frame_time_ms = 1000.0 / std::max(1u, config->capture.target_fps);
+            }
+
             // Capture frame
             if (!capture_->capture(frame, 16))
             {
-                // No new frame, wait a bit
-                spin_wait(100);
+                // No new frame: capture() already blocked for the 16 ms timeout (static screen)
+                note_static();
                 continue;
             }
 
@@ -198,13 +299,20 @@ namespace vrs
                 continue;
             }
 
-            // Get buffer from pool
-            auto buffer = frame_pool_->acquire();
+            // Get buffer from pool, sized for this capture (re-provisioned when the size class changes)
+            const size_t required_size = static_cast<size_t>(frame.pitch) * frame.height;
+            auto buffer = frame_pool_->acquire(required_size);
             if (!buffer)
             {
+                // Back-pressure: every buffer is still with the encoders
                 capture_->release_frame(frame);
                 continue;
             }
+            if (frame_pool_->buffer_size() != pool_class)
+            {
+                pool_class = frame_pool_->buffer_size();
+                compressed_pool_->set_reserve_size(CompressedFramePool::reserve_for(pool_class));
+            }
 
             // Copy frame data
             buffer->width = frame.width;
@@ -213,34 +321,46 @@ namespace vrs
             buffer->timestamp = frame.timestamp;
             buffer->frame_id = frame.frame_id;
             buffer->format = 0; // BGRA
-
-            // Ensure buffer is large enough
-            size_t required_size = static_cast<size_t>(frame.pitch) * frame.height;
-            buffer->allocate(required_size);
             buffer->size = required_size;
 
             // Copy pixel data
-            std::memcpy(buffer->data.get(), frame.cpu_data, required_size);
+            bool unchanged = false;
+            if (refine_static_frames_.load(std::memory_order_relaxed) > 0)
+            {
+                const u64 signature = copy_with_signature(buffer->data, frame.cpu_data, required_size) ^
+                                      (static_cast<u64>(frame.width) << 32 | frame.height);
+                unchanged = have_signature && signature == last_signature;
+                last_signature = signature;
+            }
+            else
+            {
+                std::memcpy(buffer->data, frame.cpu_data, required_size);
+                have_signature = false;
+            }
 
             // Release capture frame
             capture_->release_frame(frame);
 
-            // Push to encode queue
-            if (!capture_queue_.try_push(std::move(buffer)))
+            if (unchanged)
             {
-                // Queue full, drop frame
-                frame_pool_->release(std::move(buffer));
+                // Same pixels as the frame already sent (window capture repeats them); buffer goes back to the pool
+                note_static();
+            }
+            else
+            {
+                static_captures = 0;
+                screen_static_.store(false);
+
+                // Hand to the next free encode worker
+                // Every worker busy: frame dropped with buffer (the next one is sent even if identical)
+                have_signature = encoders_->submit(buffer);
             }
 
             // Update stats
             capture_fps_.tick();
-
-            {
-                std::lock_guard lock(stats_mutex_);
-                stats_.frames_captured++;
-                stats_.capture_fps = capture_fps_.fps();
-                stats_.capture_time_ms = frame_timer.elapsed_ms();
-            }
+            capture_counters_.frames.fetch_add(1, std::memory_order_relaxed);
+            capture_counters_.fps.store(capture_fps_.fps(), std::memory_order_relaxed);
+            capture_counters_.time_ms.store(frame_timer.elapsed_ms(), std::memory_order_relaxed);
 
             // Frame rate limiting
             f64 elapsed = frame_timer.elapsed_ms();
@@ -258,121 +378,196 @@ namespace vrs
         VRS_LOG_INFO("Capture thread stopped");
     }
 
-    void VRStreamerApp::encode_loop()
+    void VRStreamerApp::on_frame_encoded(CompressedFramePtr frame)
     {
-        VRS_LOG_INFO("Encode thread started");
+        const f64 encode_time_ms = frame->encode_time_ms;
+
+        // Push to server (broadcasts to all clients)
+        server_->push_frame(std::move(frame));
+
+        // Update stats (the encoder's own are read by the stats thread)
+        encode_fps_.tick();
+        encode_counters_.frames.fetch_add(1, std::memory_order_relaxed);
+        encode_counters_.fps.store(encode_fps_.fps(), std::memory_order_relaxed);
+        encode_counters_.time_ms.store(encode_time_ms, std::memory_order_relaxed);
+    }
 
-        std::vector<u8> encoded_buffer;
-        encoded_buffer.reserve(1024 * 1024); // 1MB initial
+    void VRStreamerApp::stats_loop()
+    {
+        ThreadPlacement::apply(ThreadRole::BACKGROUND, "stats");
+        VRS_LOG_INFO("Stats thread started");
+
+        Timer interval_timer;
+        u64 last_allocations = allocation_count();
+        u64 last_frames_encoded = 0;
 
         while (!stop_requested_.load())
         {
-            // Get frame from capture queue
-            FrameBufferPool::BufferPtr buffer;
-            if (!capture_queue_.try_pop(buffer))
-            {
-                spin_wait(50);
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+
+            if (!server_)
                 continue;
-            }
 
-            if (!buffer)
+            if (config_watcher_)
             {
-                continue;
+                if (auto change = config_watcher_->poll())
+                {
+                    // Only what the save changed: command-line and console settings stay
+                    VRS_LOG_INFO(std::format("Reloaded {}", config_watcher_->filepath()));
+                    apply_config([&](Config &current)
+                                 { current.apply_changes(change->before, change->after); });
+                }
             }
+            const auto config = config_.load();
 
-            Timer encode_timer;
-
-            // Encode frame
-            size_t encoded_size = encoder_->encode(
-                buffer->data.get(),
-                buffer->width,
-                buffer->height,
-                buffer->stride,
-                4, // BGRA
-                encoded_buffer);
-
-            // Return buffer to pool
-            frame_pool_->release(std::move(buffer));
+            auto server_stats = server_->stats();
 
-            if (encoded_size == 0)
+            const f64 interval_s = interval_timer.elapsed_s();
+            interval_timer.reset();
+            if (config->encoder.frame_budget_auto && encoders_)
             {
-                continue;
+                update_frame_budget(server_stats, interval_s);
             }
 
-            // Create shared buffer for streaming
-            auto shared_data = std::make_shared<std::vector<u8>>(
-                encoded_buffer.begin(),
-                encoded_buffer.begin() + encoded_size);
-
-            // Push to server (broadcasts to all clients)
-            server_->push_frame(std::move(shared_data));
-
-            // Update stats
-            encode_fps_.tick();
-            auto encoder_stats = encoder_->stats();
+            // Gather everything into one snapshot; readers only ever see whole ones
+            PipelineStats snapshot;
+            snapshot.capture_fps = capture_counters_.fps.load(std::memory_order_relaxed);
+            snapshot.capture_time_ms = capture_counters_.time_ms.load(std::memory_order_relaxed);
+            snapshot.frames_captured = capture_counters_.frames.load(std::memory_order_relaxed);
+            snapshot.frames_backpressured = frame_pool_->exhausted() + compressed_pool_->exhausted();
+            snapshot.frame_pool_bytes = frame_pool_->provisioned_bytes();
+
+            const auto encoder_stats = encoders_->encoder_stats();
+            snapshot.encode_fps = encode_counters_.fps.load(std::memory_order_relaxed);
+            snapshot.total_encode_time_ms = encode_counters_.time_ms.load(std::memory_order_relaxed);
+            snapshot.frames_encoded = encode_counters_.frames.load(std::memory_order_relaxed);
+            snapshot.stereo_time_ms = encoder_stats.stereo_time_ms;
+            snapshot.jpeg_time_ms = encoder_stats.encode_time_ms;
+            snapshot.huffman_table_age_ms = encoder_stats.huffman_table_age_ms;
+            snapshot.huffman_gain_percent = encoder_stats.huffman_gain_percent;
+            snapshot.encode_workers = encoders_->active_workers();
+            snapshot.frames_superseded = encoders_->frames_superseded();
+            snapshot.frames_refined = encoders_->frames_refined();
+            snapshot.current_quality = encoder_stats.quality;
+            snapshot.frame_budget_bytes = encoder_stats.frame_budget_bytes;
+            snapshot.last_frame_bytes = encoder_stats.last_frame_bytes;
+            snapshot.downscale_factor = encoder_stats.downscale_factor;
+
+            snapshot.stream_fps = server_stats.current_fps;
+            snapshot.connected_clients = server_stats.connected_clients;
+            snapshot.bytes_sent = server_stats.total_bytes_sent;
+            snapshot.frames_sent = server_stats.total_frames_sent;
+            snapshot.bitrate_mbps = server_stats.avg_bitrate_mbps();
+            snapshot.avg_latency_ms = server_stats.avg_latency_ms;
+            snapshot.uptime_seconds = uptime_timer_.elapsed_s();
+
+            if (allocation_counting())
+            {
+                // Includes this thread's once-a-second work, so steady state reads just above 0
+                const u64 allocations = allocation_count();
+                const u64 frames = snapshot.frames_encoded - last_frames_encoded;
+                snapshot.heap_allocations = allocations;
+                snapshot.allocations_per_frame = frames ? static_cast<f64>(allocations - last_allocations) / frames : 0;
+                last_allocations = allocations;
+                last_frames_encoded = snapshot.frames_encoded;
+            }
+            if (snapshot.frames_encoded == 0)
+            {
+                snapshot.current_quality = config->encoder.jpeg_quality;
+                snapshot.downscale_factor = config->encoder.downscale_factor;
+            }
+            stats_.store(snapshot);
 
+            if (on_stats_)
             {
-                std::lock_guard lock(stats_mutex_);
-                stats_.frames_encoded++;
-                stats_.encode_fps = encode_fps_.fps();
-                stats_.stereo_time_ms = encoder_stats.stereo_time_ms;
-                stats_.jpeg_time_ms = encoder_stats.encode_time_ms;
-                stats_.total_encode_time_ms = encode_timer.elapsed_ms();
+                on_stats_(snapshot);
             }
         }
 
-        VRS_LOG_INFO("Encode thread stopped");
+        VRS_LOG_INFO("Stats thread stopped");
     }
 
-    void VRStreamerApp::stats_loop()
+    void VRStreamerApp::update_frame_budget(const ServerStats &server_stats, f64 interval_s)
     {
-        VRS_LOG_INFO("Stats thread started");
+        const u64 bytes = server_stats.total_bytes_sent - budget_bytes_sent_;
+        const u64 dropped = server_stats.total_frames_dropped - budget_frames_dropped_;
+        budget_bytes_sent_ = server_stats.total_bytes_sent;
+        budget_frames_dropped_ = server_stats.total_frames_dropped;
 
-        while (!stop_requested_.load())
+        if (server_stats.connected_clients == 0 || interval_s <= 0)
         {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-
-            if (!server_)
-                continue;
+            return;
+        }
 
-            auto server_stats = server_->stats();
+        const u64 last_frame_bytes = encoders_->encoder_stats().last_frame_bytes;
+        const f64 frame_rate = encode_counters_.fps.load(std::memory_order_relaxed);
+        if (last_frame_bytes == 0 || frame_rate < 1.0)
+        {
+            return;
+        }
 
-            {
-                std::lock_guard lock(stats_mutex_);
-                stats_.stream_fps = server_stats.current_fps;
-                stats_.connected_clients = server_stats.connected_clients;
-                stats_.bytes_sent = server_stats.total_bytes_sent;
-                stats_.frames_sent = server_stats.total_frames_sent;
-                stats_.bitrate_mbps = server_stats.avg_bitrate_mbps();
-                stats_.avg_latency_ms = server_stats.avg_latency_ms;
-                stats_.uptime_seconds = uptime_timer_.elapsed_s();
-                stats_.current_quality = config_.encoder.jpeg_quality;
-                stats_.downscale_factor = config_.encoder.downscale_factor;
-            }
+        // Every client gets every frame, so per-client throughput bounds the frame size
+        const f64 client_bytes_per_s = bytes / interval_s / server_stats.connected_clients;
+        const f64 delivered_per_frame = client_bytes_per_s / frame_rate;
 
-            if (on_stats_)
-            {
-                on_stats_(stats());
-            }
+        f64 budget = auto_frame_budget_ > 0 ? auto_frame_budget_ : static_cast<f64>(last_frame_bytes);
+        if (dropped > 0)
+        {
+            // Link saturated: aim a little under what actually got through
+            budget = std::min(budget, 0.85 * delivered_per_frame);
+        }
+        else
+        {
+            // No drops: probe upwards, but not far past what frames actually use
+            budget = std::min(budget * 1.1, 2.0 * last_frame_bytes);
         }
 
-        VRS_LOG_INFO("Stats thread stopped");
+        constexpr f64 MIN_FRAME_BUDGET = 8 * 1024;
+        auto_frame_budget_ = static_cast<u32>(std::max(budget, MIN_FRAME_BUDGET));
+        encoders_->set_frame_budget(auto_frame_budget_);
     }
 
     PipelineStats VRStreamerApp::stats() const
     {
-        std::lock_guard lock(stats_mutex_);
-        return stats_;
+        return stats_.load();
     }
 
-    void VRStreamerApp::update_config(const Config &config)
+    template <typename Edit>
+    void VRStreamerApp::apply_config(Edit &&edit)
     {
-        config_ = config;
+        std::lock_guard lock(config_mutex_);
+        const auto previous = config_.load();
+        const Config current = config_.update(std::forward<Edit>(edit));
 
-        if (encoder_)
+        // Only what changed: the workers compare again before touching their encoders
+        if (encoders_ && current.encoder != previous->encoder)
+        {
+            encoders_->update_config(current.encoder);
+        }
+        if (encoders_ && current.capture.target_fps != previous->capture.target_fps)
         {
-            encoder_->update_config(config.encoder);
+            encoders_->set_frame_interval(1000.0 / std::max(1u, current.capture.target_fps));
         }
+        refine_static_frames_.store(refine_threshold(current.encoder));
+
+        CaptureConfig capture = current.capture;
+        capture.target_fps = previous->capture.target_fps;
+        if (capture != previous->capture || current.network != previous->network || current.threads != previous->threads)
+        {
+            VRS_LOG_WARN("Capture, network and thread settings take effect after a restart");
+        }
+    }
+
+    void VRStreamerApp::update_config(const Config &config)
+    {
+        apply_config([&](Config &current)
+                     { current = config; });
+    }
+
+    void VRStreamerApp::watch_config(const std::string &filepath)
+    {
+        config_watcher_ = std::make_unique<ConfigWatcher>(filepath);
+        VRS_LOG_INFO(std::format("Watching {} for changes", filepath));
     }
 
     bool VRStreamerApp::set_capture_monitor(u32 index)
@@ -432,32 +627,20 @@ namespace vrs
 
     void VRStreamerApp::set_quality_preset(QualityPreset preset)
     {
-        config_.apply_preset(preset);
-
-        if (encoder_)
-        {
-            encoder_->update_config(config_.encoder);
-        }
+        apply_config([preset](Config &current)
+                     { current.apply_preset(preset); });
     }
 
     void VRStreamerApp::set_quality(u32 quality)
     {
-        config_.encoder.jpeg_quality = std::clamp(quality, 1u, 100u);
-
-        if (encoder_)
-        {
-            encoder_->update_config(config_.encoder);
-        }
+        apply_config([quality](Config &current)
+                     { current.encoder.jpeg_quality = std::clamp(quality, 1u, 100u); });
     }
 
     void VRStreamerApp::set_downscale(f32 factor)
     {
-        config_.encoder.downscale_factor = std::clamp(factor, 0.1f, 1.0f);
-
-        if (encoder_)
-        {
-            encoder_->update_config(config_.encoder);
-        }
+        apply_config([factor](Config &current)
+                     { current.encoder.downscale_factor = std::clamp(factor, 0.1f, 1.0f); });
     }
 
 } // namespace vrs
@@ -0,0 +1,434 @@
+/**
+ * VR Streamer - Frame-Parallel Encode Workers Implementation
+ */
+
+#include "encoder/encode_workers.hpp"
+#include "core/thread_placement.hpp"
+
+namespace vrs
+{
+
+    namespace
+    {
+        /**
+         * Modes whose frames reference the encoder's previous frame.
+         */
+        bool sequential_mode(const EncoderConfig &config) noexcept
+        {
+            return config.output_mode == EncoderConfig::OutputMode::TILES ||
+                   config.method == EncoderConfig::Method::H264;
+        }
+
+        u32 hardware_threads() noexcept
+        {
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        /**
+         * Whole-frame JPEG modes, where a single frame can be swapped for a better one.
+         */
+        bool refinable(const EncoderConfig &config) noexcept
+        {
+            return config.refine_enabled && !sequential_mode(config) &&
+                   config.method != EncoderConfig::Method::RAW;
+        }
+    } // namespace
+
+    u32 EncodeWorkerPool::worker_count_for(const EncoderConfig &config)
+    {
+        if (config.encode_workers > 0)
+        {
+            return std::min(config.encode_workers, MAX_WORKERS);
+        }
+
+        // Auto: one worker per four hardware threads, the rest go to strip threads
+        return std::clamp(hardware_threads() / 4, 1u, 4u);
+    }
+
+    EncodeWorkerPool::EncodeWorkerPool(
+        const EncoderConfig &config,
+        CompressedFramePool &compressed_pool,
+        FrameSink sink)
+        : compressed_pool_(compressed_pool),
+          sink_(std::move(sink)),
+          config_(config),
+          rate_controller_(config.jpeg_quality),
+          rate_base_quality_(config.jpeg_quality),
+          reorder_(worker_count_for(config) * QUEUE_SIZE)
+    {
+        const u32 count = worker_count_for(config);
+        workers_.reserve(count);
+        for (u32 i = 0; i < count; ++i)
+        {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+
+        // Encoders start on the first snapshot: workers only re-apply later ones
+        config_.refresh(submit_config_, submit_config_version_);
+        const EncoderConfig per_worker = worker_config(config);
+        for (auto &worker : workers_)
+        {
+            worker->encoder = std::make_unique<VRFrameEncoder>(per_worker);
+            worker->config = submit_config_;
+        }
+        active_.store(sequential_mode(config) ? 1 : count, std::memory_order_relaxed);
+        refine_encoder_ = std::make_unique<VRFrameEncoder>(refine_config(config));
+        refine_active_.store(refinable(config), std::memory_order_relaxed);
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            workers_[i]->thread = std::thread([this, i, &worker = *workers_[i]]
+                                              {
+                ThreadPlacement::apply(ThreadRole::ENCODE, std::format("encode-{}", i));
+                worker_loop(worker); });
+        }
+        refine_thread_ = std::thread(&EncodeWorkerPool::refine_loop, this);
+
+        VRS_LOG_INFO(std::format("{} encode worker(s)", count));
+    }
+
+    EncodeWorkerPool::~EncodeWorkerPool()
+    {
+        {
+            std::lock_guard lock(refine_mutex_);
+            stop_.store(true);
+        }
+        refine_cv_.notify_all();
+        for (auto &worker : workers_)
+        {
+            worker->queue.close();
+        }
+
+        for (auto &worker : workers_)
+        {
+            if (worker->thread.joinable())
+            {
+                worker->thread.join();
+            }
+        }
+        if (refine_thread_.joinable())
+        {
+            refine_thread_.join();
+        }
+
+        // Queued and retained captures go back to their pool with the queues
+    }
+
+    EncoderConfig EncodeWorkerPool::worker_config(const EncoderConfig &config) const
+    {
+        EncoderConfig result = config;
+        const u32 active = sequential_mode(config) ? 1 : static_cast<u32>(workers_.size());
+        if (active > 1 && config.jpeg_threads == 0)
+        {
+            // Same total as one auto-sized strip encoder (half the hardware threads)
+            result.jpeg_threads = std::max(1u, hardware_threads() / (2 * active));
+        }
+        return result;
+    }
+
+    EncoderConfig EncodeWorkerPool::refine_config(const EncoderConfig &config)
+    {
+        EncoderConfig result = config;
+        result.jpeg_quality = config.refine_quality;
+        result.full_chroma = config.full_chroma || config.refine_full_chroma;
+        result.frame_budget_bytes = 0;
+        result.frame_budget_auto = false;
+        result.dynamic_resolution = false;
+        result.roi_enabled = false;
+        result.jpeg_threads = 1; // One core in the background
+        result.huffman_interval_ms = 0;
+        return result;
+    }
+
+    bool EncodeWorkerPool::submit(FrameBufferPool::BufferPtr &buffer)
+    {
+        const u32 active = active_.load(std::memory_order_relaxed);
+
+        // Frame boundary for settings: this frame and all after it use the latest
+        config_.refresh(submit_config_, submit_config_version_);
+        const VRFrameEncoder::FrameControl control = frame_control(*submit_config_);
+
+        // Round-robin, skipping workers whose queue is full
+        for (u32 attempt = 0; attempt < active; ++attempt)
+        {
+            Worker &worker = *workers_[next_worker_ % active];
+            next_worker_ = (next_worker_ + 1) % active;
+
+            if (worker.queue.push_notify(Job{buffer, next_sequence_, submit_config_, control}))
+            {
+                buffer.reset();
+                ++next_sequence_;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    VRFrameEncoder::FrameControl EncodeWorkerPool::frame_control(const EncoderConfig &config)
+    {
+        std::lock_guard lock(control_mutex_);
+        if (rate_base_quality_ != config.jpeg_quality)
+        {
+            // Manual quality change (+/-, presets): restart the controller from there
+            rate_controller_.reset(config.jpeg_quality);
+            rate_base_quality_ = config.jpeg_quality;
+            rate_reset_sequence_ = next_sequence_;
+        }
+
+        rate_budget_ = config.frame_budget_auto ? frame_budget_.load(std::memory_order_relaxed)
+                                                : config.frame_budget_bytes;
+        rate_min_quality_ = config.rate_min_quality;
+        rate_max_quality_ = config.rate_max_quality;
+
+        if (resolution_base_ != config.downscale_factor || resolution_floor_ != config.min_downscale)
+        {
+            // Manual scale change ([/], presets): new top of the ladder
+            resolution_controller_.reset(config.downscale_factor, config.min_downscale);
+            resolution_base_ = config.downscale_factor;
+            resolution_floor_ = config.min_downscale;
+            resolution_reset_sequence_ = next_sequence_;
+        }
+
+        // Every frame of the stream at the same rung, so sizes never alternate between workers
+        resolution_dynamic_ = config.dynamic_resolution && config.vr_enabled &&
+                              frame_interval_ms_.load(std::memory_order_relaxed) > 0 &&
+                              config.output_width == 0 && config.output_height == 0;
+        const f32 downscale = resolution_dynamic_ ? resolution_controller_.scale() : config.downscale_factor;
+
+        return {rate_controller_.quality(), rate_budget_, downscale};
+    }
+
+    void EncodeWorkerPool::emit(Encoded &&encoded)
+    {
+        // Re-encodes carry no timing: they say nothing about live frames
+        if (encoded.frame_time_ms > 0)
+        {
+            std::lock_guard lock(control_mutex_);
+            if (encoded.quality > 0 && encoded.sequence >= rate_reset_sequence_)
+            {
+                rate_controller_.update(encoded.quality, encoded.frame->size(), rate_budget_,
+                                        rate_min_quality_, rate_max_quality_);
+            }
+
+            const f64 interval_ms = frame_interval_ms_.load(std::memory_order_relaxed) *
+                                    active_.load(std::memory_order_relaxed);
+            if (resolution_dynamic_ && encoded.sequence >= resolution_reset_sequence_ &&
+                resolution_controller_.update(encoded.frame_time_ms, interval_ms))
+            {
+                VRS_LOG_INFO(std::format("Dynamic resolution: scale {:.2f} (frames took {:.1f} of {:.1f} ms)",
+                                         resolution_controller_.scale(), resolution_controller_.average_ms(),
+                                         interval_ms));
+            }
+        }
+        sink_(std::move(encoded.frame));
+    }
+
+    void EncodeWorkerPool::update_config(const EncoderConfig &config)
+    {
+        config_.publish(config);
+        active_.store(sequential_mode(config) ? 1 : static_cast<u32>(workers_.size()), std::memory_order_relaxed);
+        refine_active_.store(refinable(config), std::memory_order_relaxed);
+        if (!refinable(config))
+        {
+            FrameBufferPool::BufferPtr released;
+            {
+                std::lock_guard lock(refine_mutex_);
+                released = std::move(retained_);
+            }
+            // Back to the pool here, outside the lock
+        }
+    }
+
+    void EncodeWorkerPool::request_keyframe() noexcept
+    {
+        for (auto &worker : workers_)
+        {
+            worker->encoder->request_keyframe();
+        }
+    }
+
+    void EncodeWorkerPool::request_refinement()
+    {
+        if (!refine_active_.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        {
+            std::lock_guard lock(refine_mutex_);
+            refine_requested_ = true;
+        }
+        refine_cv_.notify_one();
+    }
+
+    void EncodeWorkerPool::set_frame_budget(u32 bytes) noexcept
+    {
+        frame_budget_.store(bytes, std::memory_order_relaxed);
+    }
+
+    void EncodeWorkerPool::set_frame_interval(f64 ms) noexcept
+    {
+        frame_interval_ms_.store(ms, std::memory_order_relaxed);
+    }
+
+    void EncodeWorkerPool::worker_loop(Worker &worker)
+    {
+        while (!stop_.load(std::memory_order_relaxed))
+        {
+            // Sleeps between frames; submit() or shutdown wakes it
+            Job job;
+            if (!worker.queue.pop_wait(job))
+            {
+                continue;
+            }
+
+            // Settings the frame was captured under; changes only between frames
+            if (job.config != worker.config)
+            {
+                worker.config = std::move(job.config);
+                worker.encoder->update_config(worker_config(*worker.config));
+            }
+
+            // Encode straight into a pooled buffer that is handed to the server as-is
+            CompressedFramePtr frame = compressed_pool_.acquire();
+            size_t encoded_size = 0;
+            if (frame)
+            {
+                frame->timestamp = job.buffer->timestamp;
+                frame->frame_id = job.buffer->frame_id;
+
+                encoded_size = worker.encoder->encode(
+                    job.buffer->data,
+                    job.buffer->width,
+                    job.buffer->height,
+                    job.buffer->stride,
+                    4, // BGRA
+                    *frame,
+                    &job.control);
+            }
+            // else sessions hold every output buffer: skip this frame (back-pressure)
+
+            if (refine_active_.load(std::memory_order_relaxed))
+            {
+                retain(std::move(job.buffer), job.sequence);
+            }
+            job.buffer.reset(); // Capture back to its pool before the frame goes out
+
+            Encoded encoded; // Empty still completes the sequence number
+            if (encoded_size > 0)
+            {
+                const VRFrameEncoder::Stats stats = worker.encoder->stats();
+                last_stats_.store(stats);
+                encoded.frame = std::move(frame);
+                encoded.sequence = job.sequence;
+                encoded.quality = stats.frame_budget_bytes > 0 ? stats.quality : 0;
+                encoded.frame_time_ms = stats.stereo_time_ms + stats.encode_time_ms;
+            }
+
+            // Patches depend on every frame before them, so never drop those
+            const bool droppable = encoded && !encoded.frame->delta;
+            const u32 dropped = reorder_.complete(job.sequence, std::move(encoded), droppable,
+                                                  [this](Encoded &&ready)
+                                                  { emit(std::move(ready)); });
+            if (dropped > 0)
+            {
+                superseded_.fetch_add(dropped, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void EncodeWorkerPool::retain(FrameBufferPool::BufferPtr &&buffer, u64 sequence)
+    {
+        FrameBufferPool::BufferPtr released;
+        {
+            std::lock_guard lock(refine_mutex_);
+            if (sequence >= retained_sequence_)
+            {
+                released = std::exchange(retained_, std::move(buffer));
+                retained_sequence_ = sequence;
+            }
+            else
+            {
+                // A later frame finished first on another worker
+                released = std::move(buffer);
+            }
+        }
+        // released goes back to the pool here, outside the lock
+    }
+
+    void EncodeWorkerPool::refine_loop()
+    {
+        // Background: the live encoders win every contended core
+        ThreadPlacement::apply(ThreadRole::BACKGROUND, "refine");
+        // Its row bands queue behind live frames' on the shared pool
+        ThreadPool::set_thread_priority(TaskPriority::REFINE);
+
+        ConfigSnapshot config;
+        u64 config_version = 0; // The first refinement applies whatever is current
+
+        while (true)
+        {
+            FrameBufferPool::BufferPtr buffer;
+            u64 sequence = 0;
+            {
+                std::unique_lock lock(refine_mutex_);
+                refine_cv_.wait(lock, [this]
+                                { return refine_requested_ || stop_.load(std::memory_order_relaxed); });
+                if (stop_.load(std::memory_order_relaxed))
+                {
+                    break;
+                }
+                refine_requested_ = false;
+
+                // Taken out so workers cannot recycle it mid-encode
+                buffer = std::move(retained_);
+                sequence = retained_sequence_;
+            }
+
+            if (!buffer)
+            {
+                continue;
+            }
+
+            if (config_.refresh(config, config_version))
+            {
+                refine_encoder_->update_config(refine_config(*config));
+            }
+
+            CompressedFramePtr frame = compressed_pool_.acquire();
+            size_t encoded_size = 0;
+            if (frame)
+            {
+                frame->timestamp = buffer->timestamp;
+                frame->frame_id = buffer->frame_id;
+
+                encoded_size = refine_encoder_->encode(
+                    buffer->data,
+                    buffer->width,
+                    buffer->height,
+                    buffer->stride,
+                    4, // BGRA
+                    *frame);
+            }
+
+            {
+                std::lock_guard lock(refine_mutex_);
+                if (!retained_)
+                {
+                    // Still the newest: keep it for the next request (new client)
+                    retained_ = std::move(buffer);
+                }
+            }
+            buffer.reset(); // Superseded while encoding: back to the pool
+
+            // Sent only while its original is still the last frame out; not rate-controlled
+            if (encoded_size > 0 &&
+                reorder_.emit_if_current(sequence, Encoded{std::move(frame)}, [this](Encoded &&ready)
+                                         { emit(std::move(ready)); }))
+            {
+                refined_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+} // namespace vrs
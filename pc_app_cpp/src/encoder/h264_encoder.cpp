@@ -0,0 +1,278 @@
+/**
+ * VR Streamer - Software H.264 Encoder Implementation
+ */
+
+#include "encoder/h264_encoder.hpp"
+#include "network/frame_protocol.hpp"
+
+#ifdef HAS_X264
+#include <x264.h>
+#endif
+
+namespace vrs
+{
+
+#ifdef HAS_X264
+
+    namespace
+    {
+        // Rate control assumes this until frame timestamps take over
+        constexpr u32 NOMINAL_FPS = 60;
+
+        /**
+         * BT.601 limited-range luma, 8-bit fixed point.
+         */
+        VRS_FORCEINLINE u8 rgb_to_y(u32 r, u32 g, u32 b) noexcept
+        {
+            return static_cast<u8>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+
+        /**
+         * Pack BGR/BGRA rows into I420: full-resolution Y, chroma from the
+         * average of each 2x2 block. Two rows per pass keep both inputs hot.
+         */
+        void bgr_to_i420(
+            const u8 *input, u32 width, u32 height,
+            u32 pitch, u32 channels,
+            u8 *y_plane, u8 *u_plane, u8 *v_plane)
+        {
+            const u32 chroma_width = width / 2;
+
+            for (u32 y = 0; y < height; y += 2)
+            {
+                const u8 *row0 = input + static_cast<size_t>(y) * pitch;
+                const u8 *row1 = row0 + pitch;
+                u8 *y0 = y_plane + static_cast<size_t>(y) * width;
+                u8 *y1 = y0 + width;
+                u8 *u = u_plane + static_cast<size_t>(y / 2) * chroma_width;
+                u8 *v = v_plane + static_cast<size_t>(y / 2) * chroma_width;
+
+                for (u32 x = 0; x < chroma_width; ++x)
+                {
+                    const u8 *a = row0 + static_cast<size_t>(x) * 2 * channels;
+                    const u8 *b = row1 + static_cast<size_t>(x) * 2 * channels;
+
+                    y0[2 * x] = rgb_to_y(a[2], a[1], a[0]);
+                    y0[2 * x + 1] = rgb_to_y(a[channels + 2], a[channels + 1], a[channels]);
+                    y1[2 * x] = rgb_to_y(b[2], b[1], b[0]);
+                    y1[2 * x + 1] = rgb_to_y(b[channels + 2], b[channels + 1], b[channels]);
+
+                    // Sums of four samples: scale the coefficients down by 4 in the shift
+                    const i32 bs = a[0] + a[channels] + b[0] + b[channels];
+                    const i32 gs = a[1] + a[channels + 1] + b[1] + b[channels + 1];
+                    const i32 rs = a[2] + a[channels + 2] + b[2] + b[channels + 2];
+
+                    u[x] = static_cast<u8>(((-38 * rs - 74 * gs + 112 * bs + 512) >> 10) + 128);
+                    v[x] = static_cast<u8>(((112 * rs - 94 * gs - 18 * bs + 512) >> 10) + 128);
+                }
+            }
+        }
+    } // namespace
+
+    H264Encoder::H264Encoder() = default;
+
+    H264Encoder::~H264Encoder()
+    {
+        shutdown();
+    }
+
+    bool H264Encoder::available() noexcept
+    {
+        return true;
+    }
+
+    bool H264Encoder::open(u32 width, u32 height, const EncoderConfig &config)
+    {
+        shutdown();
+
+        x264_param_t param;
+        const char *preset = config.h264_low_latency ? "ultrafast" : "superfast";
+        if (x264_param_default_preset(&param, preset, "zerolatency") < 0)
+        {
+            VRS_LOG_ERROR("x264: failed to load zerolatency preset");
+            return false;
+        }
+
+        param.i_log_level = X264_LOG_WARNING;
+        param.i_width = static_cast<int>(width);
+        param.i_height = static_cast<int>(height);
+        param.i_csp = X264_CSP_I420;
+
+        // Frames are timed by the wall clock so rate control follows the real frame rate
+        param.i_fps_num = NOMINAL_FPS;
+        param.i_fps_den = 1;
+        param.i_timebase_num = 1;
+        param.i_timebase_den = 1000;
+        param.b_vfr_input = 1;
+
+        // Intra refresh: a column of intra blocks sweeps the frame every gop_length frames
+        param.i_bframe = 0;
+        param.i_frame_reference = 1;
+        param.b_intra_refresh = 1;
+        param.i_keyint_max = static_cast<int>(std::max(config.h264_gop_length, 2u));
+
+        // Constant frame sizes: VBV of about two frames at the nominal rate
+        param.rc.i_rc_method = X264_RC_ABR;
+        param.rc.i_bitrate = static_cast<int>(config.h264_bitrate);
+        param.rc.i_vbv_max_bitrate = static_cast<int>(config.h264_bitrate);
+        param.rc.i_vbv_buffer_size = static_cast<int>(std::max(config.h264_bitrate * 2 / NOMINAL_FPS, 1u));
+
+        // In-band SPS/PPS before every IDR so a new decoder can start there
+        param.b_repeat_headers = 1;
+        param.b_annexb = 1;
+
+        // Matches the BT.601 limited-range conversion above
+        param.vui.b_fullrange = 0;
+        param.vui.i_colorprim = 6;
+        param.vui.i_transfer = 6;
+        param.vui.i_colmatrix = 6;
+
+        if (x264_param_apply_profile(&param, "baseline") < 0)
+        {
+            VRS_LOG_ERROR("x264: baseline profile rejected");
+            return false;
+        }
+
+        x264_t *encoder = x264_encoder_open(&param);
+        if (!encoder)
+        {
+            VRS_LOG_ERROR(std::format("x264: failed to open {}x{} encoder", width, height));
+            return false;
+        }
+
+        encoder_ = encoder;
+        yuv_ = make_aligned_array<u8>(static_cast<size_t>(width) * height * 3 / 2, CACHE_LINE_SIZE);
+        width_ = width;
+        height_ = height;
+        bitrate_ = config.h264_bitrate;
+        gop_length_ = config.h264_gop_length;
+        low_latency_ = config.h264_low_latency;
+        last_pts_ = -1;
+
+        VRS_LOG_INFO(std::format("x264 {}x{} baseline, {} Kbps, intra refresh every {} frames ({})",
+                                 width, height, bitrate_, param.i_keyint_max, preset));
+        return true;
+    }
+
+    void H264Encoder::shutdown()
+    {
+        if (encoder_)
+        {
+            x264_encoder_close(static_cast<x264_t *>(encoder_));
+            encoder_ = nullptr;
+        }
+        width_ = 0;
+        height_ = 0;
+    }
+
+    size_t H264Encoder::encode(
+        const u8 *input,
+        u32 width, u32 height,
+        u32 pitch, u32 channels,
+        const EncoderConfig &config,
+        bool force_idr,
+        CompressedFrame &output)
+    {
+        width &= ~1u;
+        height &= ~1u;
+        if (!input || width == 0 || height == 0 || width > 65535 || height > 65535 ||
+            (channels != 3 && channels != 4))
+        {
+            output.clear();
+            return 0;
+        }
+
+        Timer timer;
+
+        if (!encoder_ || width != width_ || height != height_ ||
+            config.h264_bitrate != bitrate_ || config.h264_gop_length != gop_length_ ||
+            config.h264_low_latency != low_latency_)
+        {
+            if (!open(width, height, config))
+            {
+                output.clear();
+                return 0;
+            }
+        }
+
+        const size_t luma_size = static_cast<size_t>(width) * height;
+        u8 *y_plane = yuv_.get();
+        u8 *u_plane = y_plane + luma_size;
+        u8 *v_plane = u_plane + luma_size / 4;
+        bgr_to_i420(input, width, height, pitch, channels, y_plane, u_plane, v_plane);
+
+        x264_picture_t picture;
+        x264_picture_init(&picture);
+        picture.img.i_csp = X264_CSP_I420;
+        picture.img.i_plane = 3;
+        picture.img.plane[0] = y_plane;
+        picture.img.plane[1] = u_plane;
+        picture.img.plane[2] = v_plane;
+        picture.img.i_stride[0] = static_cast<int>(width);
+        picture.img.i_stride[1] = static_cast<int>(width / 2);
+        picture.img.i_stride[2] = static_cast<int>(width / 2);
+        picture.i_type = force_idr ? X264_TYPE_IDR : X264_TYPE_AUTO;
+
+        // Strictly increasing, as x264 requires
+        last_pts_ = std::max(last_pts_ + 1, static_cast<i64>(clock_.elapsed_ms()));
+        picture.i_pts = last_pts_;
+
+        x264_picture_t encoded;
+        x264_nal_t *nals = nullptr;
+        int nal_count = 0;
+        const int frame_size = x264_encoder_encode(
+            static_cast<x264_t *>(encoder_), &nals, &nal_count, &picture, &encoded);
+
+        if (frame_size <= 0 || nal_count == 0)
+        {
+            // zerolatency never buffers, so no output means an error
+            VRS_LOG_WARN("x264: encode produced no output");
+            output.clear();
+            return 0;
+        }
+
+        // NAL payloads are contiguous, already Annex-B framed
+        const size_t prefix = frame_prefix_size(1);
+        const u32 part_sizes[1] = {static_cast<u32>(frame_size)};
+        output.reserve(prefix + frame_size);
+        std::memcpy(output.ptr() + prefix, nals[0].p_payload, frame_size);
+
+        last_keyframe_ = (encoded.i_type == X264_TYPE_IDR);
+        write_frame_prefix(output.ptr(), FrameType::H264, width, height, output.frame_id, part_sizes,
+                           last_keyframe_ ? FRAME_FLAG_KEYFRAME : 0);
+
+        // Everything but an IDR depends on earlier frames
+        output.delta = !last_keyframe_;
+        output.length = prefix + frame_size;
+        last_encode_time_ = timer.elapsed_ms();
+        return output.length;
+    }
+
+#else // !HAS_X264
+
+    // Stub implementations when x264 is not available
+    H264Encoder::H264Encoder() = default;
+    H264Encoder::~H264Encoder() = default;
+
+    bool H264Encoder::available() noexcept
+    {
+        return false;
+    }
+
+    bool H264Encoder::open(u32, u32, const EncoderConfig &)
+    {
+        return false;
+    }
+
+    void H264Encoder::shutdown() {}
+
+    size_t H264Encoder::encode(
+        const u8 *, u32, u32, u32, u32, const EncoderConfig &, bool, CompressedFrame &output)
+    {
+        output.clear();
+        return 0;
+    }
+
+#endif // HAS_X264
+
+} // namespace vrs
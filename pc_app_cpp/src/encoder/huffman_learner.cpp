@@ -0,0 +1,497 @@
+/**
+ * VR Streamer - Huffman Table Learner Implementation
+ * libjpeg optimize_coding pass on sampled frames, off the encode thread.
+ */
+
+#include "encoder/huffman_learner.hpp"
+#include "core/thread_pool.hpp"
+
+#include <csetjmp>
+#include <cstdio>
+#include <limits>
+#include <jpeglib.h>
+
+namespace vrs
+{
+
+    namespace
+    {
+        // 4:2:0 MCU is 16x16 luma pixels
+        constexpr u32 MCU_SIZE = 16;
+
+        // MCU rows copied per sample, spread evenly over the frame
+        constexpr u32 SAMPLE_MCU_ROWS = 16;
+
+        struct ErrorManager
+        {
+            jpeg_error_mgr pub;
+            std::jmp_buf jump;
+        };
+
+        void on_error_exit(j_common_ptr cinfo)
+        {
+            auto *err = reinterpret_cast<ErrorManager *>(cinfo->err);
+            std::longjmp(err->jump, 1);
+        }
+
+        void on_output_message(j_common_ptr)
+        {
+        }
+
+        /**
+         * Compressor whose destination only counts bytes.
+         */
+        struct CountingCompressor
+        {
+            jpeg_compress_struct cinfo{};
+            ErrorManager err{};
+            jpeg_destination_mgr dest{};
+            std::array<u8, 16384> buffer{};
+            size_t bytes = 0;
+
+            CountingCompressor()
+            {
+                cinfo.err = jpeg_std_error(&err.pub);
+                err.pub.error_exit = on_error_exit;
+                err.pub.output_message = on_output_message;
+                jpeg_create_compress(&cinfo);
+
+                dest.init_destination = [](j_compress_ptr c)
+                {
+                    auto *self = static_cast<CountingCompressor *>(c->client_data);
+                    self->dest.next_output_byte = self->buffer.data();
+                    self->dest.free_in_buffer = self->buffer.size();
+                };
+                dest.empty_output_buffer = [](j_compress_ptr c) -> boolean
+                {
+                    auto *self = static_cast<CountingCompressor *>(c->client_data);
+                    self->bytes += self->buffer.size();
+                    self->dest.next_output_byte = self->buffer.data();
+                    self->dest.free_in_buffer = self->buffer.size();
+                    return TRUE;
+                };
+                dest.term_destination = [](j_compress_ptr c)
+                {
+                    auto *self = static_cast<CountingCompressor *>(c->client_data);
+                    self->bytes += self->buffer.size() - self->dest.free_in_buffer;
+                };
+
+                cinfo.client_data = this;
+                cinfo.dest = &dest;
+            }
+
+            ~CountingCompressor()
+            {
+                jpeg_destroy_compress(&cinfo);
+            }
+
+            CountingCompressor(const CountingCompressor &) = delete;
+            CountingCompressor &operator=(const CountingCompressor &) = delete;
+
+            /**
+             * Compress with the hot path's settings.
+             * @return Compressed size, or 0 on failure
+             */
+            size_t compress(
+                const u8 *input,
+                u32 width, u32 height,
+                u32 channels, u32 quality,
+                bool optimize,
+                const HuffmanTables *tables)
+            {
+                if (setjmp(err.jump))
+                {
+                    jpeg_abort_compress(&cinfo);
+                    return 0;
+                }
+
+                bytes = 0;
+                cinfo.image_width = width;
+                cinfo.image_height = height;
+                cinfo.input_components = static_cast<int>(channels);
+                cinfo.in_color_space = (channels == 4) ? JCS_EXT_BGRA : JCS_EXT_BGR;
+
+                jpeg_set_defaults(&cinfo);
+                jpeg_set_quality(&cinfo, static_cast<int>(quality), TRUE);
+                cinfo.dct_method = JDCT_IFAST;
+                cinfo.optimize_coding = optimize ? TRUE : FALSE;
+                install_huffman_tables(&cinfo, tables ? *tables : annex_k_huffman_tables());
+
+                jpeg_start_compress(&cinfo, TRUE);
+
+                const size_t pitch = static_cast<size_t>(width) * channels;
+                while (cinfo.next_scanline < cinfo.image_height)
+                {
+                    JSAMPROW row = const_cast<JSAMPROW>(input + cinfo.next_scanline * pitch);
+                    jpeg_write_scanlines(&cinfo, &row, 1);
+                }
+
+                jpeg_finish_compress(&cinfo);
+                return bytes;
+            }
+        };
+
+        void extract_table(const JHUFF_TBL *source, HuffmanTable &table)
+        {
+            std::memcpy(table.bits.data(), source->bits, table.bits.size());
+            std::memcpy(table.huffval.data(), source->huffval, table.huffval.size());
+        }
+
+        /**
+         * Length-limited optimal code (JPEG Annex K.2, as in libjpeg's
+         * jpeg_gen_optimal_table) from symbol frequencies.
+         */
+        void build_table(std::array<i64, 257> freq, HuffmanTable &table)
+        {
+            std::array<int, 257> codesize{};
+            std::array<int, 257> others;
+            others.fill(-1);
+            std::array<int, 258> bits{};
+
+            freq[256] = 1; // Reserved symbol so no code is all ones
+
+            for (;;)
+            {
+                int c1 = -1;
+                int c2 = -1;
+                i64 v1 = std::numeric_limits<i64>::max();
+                i64 v2 = std::numeric_limits<i64>::max();
+                for (int i = 0; i <= 256; ++i)
+                {
+                    if (freq[i] == 0)
+                        continue;
+                    if (freq[i] <= v1)
+                    {
+                        c2 = c1;
+                        v2 = v1;
+                        c1 = i;
+                        v1 = freq[i];
+                    }
+                    else if (freq[i] <= v2)
+                    {
+                        c2 = i;
+                        v2 = freq[i];
+                    }
+                }
+                if (c2 < 0)
+                    break;
+
+                freq[c1] += freq[c2];
+                freq[c2] = 0;
+
+                codesize[c1]++;
+                while (others[c1] >= 0)
+                {
+                    c1 = others[c1];
+                    codesize[c1]++;
+                }
+                others[c1] = c2;
+
+                codesize[c2]++;
+                while (others[c2] >= 0)
+                {
+                    c2 = others[c2];
+                    codesize[c2]++;
+                }
+            }
+
+            for (int i = 0; i <= 256; ++i)
+            {
+                if (codesize[i])
+                    bits[codesize[i]]++;
+            }
+
+            // Limit code lengths to 16 bits
+            for (int i = static_cast<int>(bits.size()) - 1; i > 16; --i)
+            {
+                while (bits[i] > 0)
+                {
+                    int j = i - 2;
+                    while (bits[j] == 0)
+                        --j;
+                    bits[i] -= 2;
+                    bits[i - 1]++;
+                    bits[j + 1] += 2;
+                    bits[j]--;
+                }
+            }
+
+            // Drop the reserved code from the longest length
+            int longest = 16;
+            while (bits[longest] == 0)
+                --longest;
+            bits[longest]--;
+
+            table.bits.fill(0);
+            for (int i = 1; i <= 16; ++i)
+            {
+                table.bits[i] = static_cast<u8>(bits[i]);
+            }
+
+            size_t p = 0;
+            for (int length = 1; length < static_cast<int>(bits.size()); ++length)
+            {
+                for (int symbol = 0; symbol < 256; ++symbol)
+                {
+                    if (codesize[symbol] == length)
+                        table.huffval[p++] = static_cast<u8>(symbol);
+                }
+            }
+        }
+
+        /**
+         * Rebuild a learned table so every legal symbol has a code.
+         * Learned symbols keep (roughly) their lengths; unseen ones get long codes.
+         */
+        void widen_table(HuffmanTable &table, bool dc)
+        {
+            std::array<i64, 257> freq{};
+
+            if (dc)
+            {
+                for (int size = 0; size <= 11; ++size)
+                    freq[size] = 1;
+            }
+            else
+            {
+                freq[0x00] = 1; // EOB
+                freq[0xF0] = 1; // ZRL
+                for (int run = 0; run < 16; ++run)
+                {
+                    for (int size = 1; size <= 10; ++size)
+                        freq[(run << 4) | size] = 1;
+                }
+            }
+
+            size_t p = 0;
+            for (int length = 1; length <= 16; ++length)
+            {
+                for (int k = 0; k < table.bits[length]; ++k)
+                {
+                    freq[table.huffval[p++]] = i64{1} << (17 - length);
+                }
+            }
+
+            build_table(freq, table);
+        }
+
+        void install_table(j_compress_ptr cinfo, JHUFF_TBL *&slot, const HuffmanTable &table)
+        {
+            if (!slot)
+            {
+                slot = jpeg_alloc_huff_table(reinterpret_cast<j_common_ptr>(cinfo));
+            }
+            std::memcpy(slot->bits, table.bits.data(), table.bits.size());
+            std::memcpy(slot->huffval, table.huffval.data(), table.huffval.size());
+            slot->sent_table = FALSE;
+        }
+    } // namespace
+
+    const HuffmanTables &annex_k_huffman_tables()
+    {
+        static const HuffmanTables tables = []
+        {
+            jpeg_compress_struct cinfo{};
+            jpeg_error_mgr err{};
+            cinfo.err = jpeg_std_error(&err);
+            jpeg_create_compress(&cinfo);
+            cinfo.input_components = 3;
+            cinfo.in_color_space = JCS_RGB;
+            jpeg_set_defaults(&cinfo);
+
+            HuffmanTables standard;
+            for (int i = 0; i < 2; ++i)
+            {
+                extract_table(cinfo.dc_huff_tbl_ptrs[i], standard.dc[i]);
+                extract_table(cinfo.ac_huff_tbl_ptrs[i], standard.ac[i]);
+            }
+            jpeg_destroy_compress(&cinfo);
+            return standard;
+        }();
+        return tables;
+    }
+
+    void install_huffman_tables(void *cinfo, const HuffmanTables &tables)
+    {
+        auto *c = static_cast<j_compress_ptr>(cinfo);
+        for (int i = 0; i < 2; ++i)
+        {
+            install_table(c, c->dc_huff_tbl_ptrs[i], tables.dc[i]);
+            install_table(c, c->ac_huff_tbl_ptrs[i], tables.ac[i]);
+        }
+    }
+
+    HuffmanLearner::HuffmanLearner(u32 interval_ms)
+        : interval_ms_(interval_ms)
+    {
+        for (auto &slot : table_slots_)
+        {
+            slot = std::make_shared<HuffmanTables>();
+        }
+    }
+
+    HuffmanLearner::~HuffmanLearner()
+    {
+        // learn() runs on the shared pool, so there is no thread to join
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this]
+                   { return !busy_.load(std::memory_order_acquire); });
+    }
+
+    bool HuffmanLearner::sample_due(u32 width, u32 height, u32 quality) const
+    {
+        if (busy_.load(std::memory_order_acquire) || width == 0 || height == 0)
+            return false;
+
+        // Resample right away when the quality (and with it the symbol mix) moves
+        return !sampled_ || quality != sample_quality_ ||
+               sample_timer_.elapsed_ms() >= interval_ms_;
+    }
+
+    void HuffmanLearner::offer(
+        const u8 *input,
+        u32 width, u32 height,
+        u32 pitch, u32 channels,
+        u32 quality)
+    {
+        if (!sample_due(width, height, quality))
+            return;
+
+        // Captures fit std::function's inline storage: no allocation
+        const u32 row_bytes = width * channels;
+        offer(
+            [input, pitch, row_bytes](u32 first_row, u32 rows, u8 *dst, u32 dst_pitch)
+            {
+                for (u32 y = 0; y < rows; ++y)
+                {
+                    std::memcpy(dst + static_cast<size_t>(y) * dst_pitch,
+                                input + static_cast<size_t>(first_row + y) * pitch, row_bytes);
+                }
+            },
+            width, height, channels, quality);
+    }
+
+    void HuffmanLearner::offer(
+        const RowSource &source,
+        u32 width, u32 height,
+        u32 channels,
+        u32 quality)
+    {
+        if (!sample_due(width, height, quality))
+            return;
+
+        // Whole MCU rows so the sample has the same block statistics as the frame
+        const u32 row_bytes = width * channels;
+        const u32 mcu_rows = height / MCU_SIZE;
+        const u32 bands = std::min(mcu_rows, SAMPLE_MCU_ROWS);
+        const u32 sample_height = (bands > 0) ? bands * MCU_SIZE : height;
+
+        sample_.resize(static_cast<size_t>(row_bytes) * sample_height);
+        if (bands == 0)
+        {
+            source(0, height, sample_.data(), row_bytes);
+        }
+        else
+        {
+            for (u32 band = 0; band < bands; ++band)
+            {
+                const u32 source_y = (band * mcu_rows / bands) * MCU_SIZE;
+                source(source_y, MCU_SIZE, sample_.data() + static_cast<size_t>(band) * MCU_SIZE * row_bytes, row_bytes);
+            }
+        }
+
+        sample_width_ = width;
+        sample_height_ = sample_height;
+        sample_channels_ = channels;
+        sample_quality_ = quality;
+        sampled_ = true;
+        sample_timer_.reset();
+
+        busy_.store(true, std::memory_order_release);
+        if (!get_global_thread_pool().submit_detached([this]
+                                                      { learn(); },
+                                                      TaskPriority::BACKGROUND))
+        {
+            busy_.store(false, std::memory_order_release);
+        }
+    }
+
+    void HuffmanLearner::learn()
+    {
+        CountingCompressor compressor;
+
+        // optimize_coding leaves the optimal tables in the compressor
+        HuffmanTables learned;
+        bool ok = compressor.compress(sample_.data(), sample_width_, sample_height_,
+                                      sample_channels_, sample_quality_, true, nullptr) > 0;
+        if (ok)
+        {
+            for (int i = 0; i < 2; ++i)
+            {
+                extract_table(compressor.cinfo.dc_huff_tbl_ptrs[i], learned.dc[i]);
+                extract_table(compressor.cinfo.ac_huff_tbl_ptrs[i], learned.ac[i]);
+                widen_table(learned.dc[i], true);
+                widen_table(learned.ac[i], false);
+            }
+        }
+
+        // Judge against the Annex K tables on the same sample
+        const size_t default_size = ok ? compressor.compress(sample_.data(), sample_width_, sample_height_,
+                                                             sample_channels_, sample_quality_, false, nullptr)
+                                       : 0;
+        const size_t learned_size = (default_size > 0) ? compressor.compress(sample_.data(), sample_width_, sample_height_,
+                                                                             sample_channels_, sample_quality_, false, &learned)
+                                                       : 0;
+
+        if (learned_size > 0)
+        {
+            std::lock_guard lock(mutex_);
+            if (learned_size < default_size)
+            {
+                // Reuse a slot no encoder still reads; all busy only if frames pile up
+                auto slot = std::find_if(table_slots_.begin(), table_slots_.end(), [](const auto &tables)
+                                         { return tables.use_count() == 1; });
+                if (slot != table_slots_.end())
+                {
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    **slot = learned;
+                    tables_ = *slot;
+                }
+                else
+                {
+                    tables_ = std::make_shared<const HuffmanTables>(learned);
+                }
+                gain_percent_ = 100.0 * static_cast<f64>(default_size - learned_size) / default_size;
+                table_timer_.reset();
+                tables_built_++;
+            }
+            else
+            {
+                tables_.reset();
+                gain_percent_ = 0;
+            }
+        }
+
+        // Under the lock: the destructor may free this as soon as it sees busy_ clear
+        std::lock_guard lock(mutex_);
+        busy_.store(false, std::memory_order_release);
+        idle_.notify_all();
+    }
+
+    std::shared_ptr<const HuffmanTables> HuffmanLearner::tables() const
+    {
+        std::lock_guard lock(mutex_);
+        return tables_;
+    }
+
+    HuffmanLearner::Stats HuffmanLearner::stats() const
+    {
+        std::lock_guard lock(mutex_);
+        Stats stats;
+        stats.table_age_ms = tables_ ? table_timer_.elapsed_ms() : 0;
+        stats.gain_percent = gain_percent_;
+        stats.tables_built = tables_built_;
+        return stats;
+    }
+
+} // namespace vrs
@@ -18,85 +18,156 @@ namespace vrs
 {
 
     // ============================================================================
-    // TurboJPEGEncoder Implementation
+    // JPEGEncodeContext / SharedJPEGEncoder Implementation
     // ============================================================================
 
-    TurboJPEGEncoder::TurboJPEGEncoder()
+    JPEGEncodeContext::~JPEGEncodeContext()
     {
-        handle_ = tjInitCompress();
-        if (!handle_)
+        if (handle_)
         {
-            VRS_LOG_WARN("Failed to initialize TurboJPEG");
+            tjDestroy(handle_);
         }
-        else
+    }
+
+    JPEGEncodeContext::JPEGEncodeContext(JPEGEncodeContext &&other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr)),
+          arena_(std::move(other.arena_)),
+          last_encode_time_(other.last_encode_time_)
+    {
+    }
+
+    JPEGEncodeContext &JPEGEncodeContext::operator=(JPEGEncodeContext &&other) noexcept
+    {
+        if (this != &other)
         {
-            VRS_LOG_INFO("TurboJPEG encoder initialized");
+            if (handle_)
+            {
+                tjDestroy(handle_);
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+            arena_ = std::move(other.arena_);
+            last_encode_time_ = other.last_encode_time_;
         }
+        return *this;
     }
 
-    TurboJPEGEncoder::~TurboJPEGEncoder()
+    SharedJPEGEncoder::SharedJPEGEncoder(bool full_chroma)
+        : full_chroma_(full_chroma)
     {
-        if (handle_)
+    }
+
+    JPEGEncodeContext SharedJPEGEncoder::make_context() const
+    {
+        JPEGEncodeContext context;
+        context.handle_ = tjInitCompress();
+        if (!context.handle_)
         {
-            tjDestroy(handle_);
+            VRS_LOG_WARN(std::format("Failed to initialize TurboJPEG: {}", tjGetErrorStr()));
         }
+        return context;
     }
 
-    size_t TurboJPEGEncoder::encode(
+    size_t SharedJPEGEncoder::compress(
+        JPEGEncodeContext &context,
         const u8 *input,
         u32 width, u32 height,
         u32 pitch, u32 channels,
         u32 quality,
-        std::vector<u8> &output)
+        u8 *dst, size_t capacity) const
     {
-        if (!handle_)
-            return 0;
-
-        Timer timer;
-
-        // Determine pixel format
-        int pixel_format = (channels == 4) ? TJPF_BGRA : TJPF_BGR;
-
-        // Estimate output size
-        unsigned long jpeg_size = tjBufSize(width, height, TJSAMP_420);
+        unsigned long actual_size = static_cast<unsigned long>(capacity);
 
-        // Pre-allocate output buffer
-        if (output.capacity() < jpeg_size)
-        {
-            output.reserve(jpeg_size);
-        }
-
-        unsigned char *jpeg_buf = nullptr;
-        unsigned long actual_size = 0;
-
-        // Encode with fastest subsampling (4:2:0) and no flags for maximum speed
-        int result = tjCompress2(
-            handle_,
+        // Fastest subsampling (4:2:0 unless full chroma) and no flags for maximum speed
+        const int result = tjCompress2(
+            context.handle_,
             input,
             width, pitch, height,
-            pixel_format,
-            &jpeg_buf,
+            (channels == 4) ? TJPF_BGRA : TJPF_BGR,
+            &dst,
             &actual_size,
-            TJSAMP_420, // 4:2:0 subsampling for smaller size
+            full_chroma_ ? TJSAMP_444 : TJSAMP_420,
             quality,
-            TJFLAG_FASTDCT // Fast DCT
+            TJFLAG_FASTDCT | TJFLAG_NOREALLOC // Fast DCT, compress in place
         );
 
-        if (result != 0 || jpeg_buf == nullptr)
+        if (result != 0)
         {
-            VRS_LOG_ERROR(std::format("TurboJPEG encode failed: {}", tjGetErrorStr()));
+            VRS_LOG_ERROR(std::format("TurboJPEG encode failed: {}", tjGetErrorStr2(context.handle_)));
             return 0;
         }
+        return actual_size;
+    }
+
+    size_t SharedJPEGEncoder::encode(
+        JPEGEncodeContext &context,
+        const u8 *input,
+        u32 width, u32 height,
+        u32 pitch, u32 channels,
+        u32 quality,
+        CompressedFrame &output) const
+    {
+        if (!context.handle_)
+            return 0;
 
-        // Copy to output vector
-        output.resize(actual_size);
-        std::memcpy(output.data(), jpeg_buf, actual_size);
+        Timer timer;
 
-        // Free TurboJPEG buffer
-        tjFree(jpeg_buf);
+        // Worst-case output size; NOREALLOC makes TurboJPEG write into our buffer
+        const size_t max_size = tjBufSize(width, height, full_chroma_ ? TJSAMP_444 : TJSAMP_420);
+        output.reserve(max_size);
 
-        last_encode_time_ = timer.elapsed_ms();
-        return actual_size;
+        const size_t size = compress(context, input, width, height, pitch, channels, quality, output.ptr(), max_size);
+        if (size == 0)
+        {
+            output.clear();
+            return 0;
+        }
+
+        output.length = size;
+        context.last_encode_time_ = timer.elapsed_ms();
+        return size;
+    }
+
+    std::span<const u8> SharedJPEGEncoder::encode_scratch(
+        JPEGEncodeContext &context,
+        const u8 *input,
+        u32 width, u32 height,
+        u32 pitch, u32 channels,
+        u32 quality) const
+    {
+        if (!context.handle_)
+            return {};
+
+        Timer timer;
+
+        const size_t max_size = tjBufSize(width, height, full_chroma_ ? TJSAMP_444 : TJSAMP_420);
+        u8 *dst = context.arena_.allocate_bytes(max_size);
+
+        const size_t size = compress(context, input, width, height, pitch, channels, quality, dst, max_size);
+        context.last_encode_time_ = timer.elapsed_ms();
+        return {dst, size};
+    }
+
+    // ============================================================================
+    // TurboJPEGEncoder Implementation
+    // ============================================================================
+
+    TurboJPEGEncoder::TurboJPEGEncoder(bool full_chroma)
+        : shared_(full_chroma), context_(shared_.make_context())
+    {
+        if (context_.valid())
+        {
+            VRS_LOG_INFO("TurboJPEG encoder initialized");
+        }
+    }
+
+    size_t TurboJPEGEncoder::encode(
+        const u8 *input,
+        u32 width, u32 height,
+        u32 pitch, u32 channels,
+        u32 quality,
+        CompressedFrame &output)
+    {
+        return shared_.encode(context_, input, width, height, pitch, channels, quality, output);
     }
 
     // ============================================================================
@@ -219,7 +290,7 @@ namespace vrs
         u32 width, u32 height,
         u32 pitch, u32 channels,
         u32 quality,
-        std::vector<u8> &output)
+        CompressedFrame &output)
     {
         if (!initialized_)
         {
@@ -265,7 +336,7 @@ namespace vrs
         u32 width, u32 height,
         u32 pitch,
         u32 quality,
-        std::vector<u8> &output)
+        CompressedFrame &output)
     {
         if (!initialized_)
             return 0;
@@ -312,11 +383,11 @@ namespace vrs
         }
 
         // Retrieve encoded data
-        output.resize(encoded_size);
+        output.reserve(encoded_size);
         status = nvjpegEncodeRetrieveBitstream(
             static_cast<nvjpegHandle_t>(nvjpeg_handle_),
             static_cast<nvjpegEncoderState_t>(encoder_state_),
-            output.data(),
+            output.ptr(),
             &encoded_size,
             static_cast<cudaStream_t>(cuda_stream_));
 
@@ -328,6 +399,7 @@ namespace vrs
             return 0;
         }
 
+        output.length = encoded_size;
         return encoded_size;
     }
 
@@ -346,52 +418,24 @@ namespace vrs
     void NvJPEGEncoder::shutdown() {}
 
     size_t NvJPEGEncoder::encode(
-        const u8 *, u32, u32, u32, u32, u32, std::vector<u8> &)
+        const u8 *, u32, u32, u32, u32, u32, CompressedFrame &)
     {
         return 0;
     }
 
     size_t NvJPEGEncoder::encode_gpu(
-        void *, u32, u32, u32, u32, std::vector<u8> &)
+        void *, u32, u32, u32, u32, CompressedFrame &)
     {
         return 0;
     }
 
 #endif // HAS_CUDA
 
-    // ============================================================================
-    // OpenCVJPEGEncoder Implementation (Fallback)
-    // ============================================================================
-
-    size_t OpenCVJPEGEncoder::encode(
-        const u8 *input,
-        u32 width, u32 height,
-        u32 pitch, u32 channels,
-        u32 quality,
-        std::vector<u8> &output)
-    {
-        Timer timer;
-        (void)input;
-        (void)width;
-        (void)height;
-        (void)pitch;
-        (void)channels;
-        (void)quality;
-        (void)output;
-
-        // This is a minimal fallback - in production, link with OpenCV
-        // The TurboJPEG encoder should be available in all practical cases
-        VRS_LOG_WARN("OpenCV fallback encoder used - consider installing TurboJPEG");
-
-        last_encode_time_ = timer.elapsed_ms();
-        return 0;
-    }
-
     // ============================================================================
     // AutoJPEGEncoder Implementation
     // ============================================================================
 
-    AutoJPEGEncoder::AutoJPEGEncoder()
+    AutoJPEGEncoder::AutoJPEGEncoder(bool prefer_builtin)
     {
 #ifdef HAS_CUDA
         // Try nvJPEG first (GPU)
@@ -404,6 +448,14 @@ namespace vrs
         }
 #endif
 
+        if (prefer_builtin)
+        {
+            builtin_ = std::make_unique<SimdJPEGEncoder>();
+            best_encoder_ = builtin_.get();
+            VRS_LOG_INFO("Selected built-in JPEG encoder");
+            return;
+        }
+
         // Try TurboJPEG (SIMD CPU)
         turbojpeg_ = std::make_unique<TurboJPEGEncoder>();
         if (turbojpeg_->available())
@@ -413,10 +465,10 @@ namespace vrs
             return;
         }
 
-        // Fallback to OpenCV
-        opencv_ = std::make_unique<OpenCVJPEGEncoder>();
-        best_encoder_ = opencv_.get();
-        VRS_LOG_WARN("Fell back to OpenCV encoder");
+        // Fallback to the built-in encoder
+        builtin_ = std::make_unique<SimdJPEGEncoder>();
+        best_encoder_ = builtin_.get();
+        VRS_LOG_WARN("Fell back to built-in JPEG encoder");
     }
 
     size_t AutoJPEGEncoder::encode(
@@ -424,7 +476,7 @@ namespace vrs
         u32 width, u32 height,
         u32 pitch, u32 channels,
         u32 quality,
-        std::vector<u8> &output)
+        CompressedFrame &output)
     {
         if (!best_encoder_)
             return 0;
@@ -0,0 +1,387 @@
+/**
+ * VR Streamer - Parallel JPEG Encoder Implementation
+ * Restart-interval strip encoding on top of the libjpeg API.
+ */
+
+#include "encoder/parallel_jpeg_encoder.hpp"
+
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+
+namespace vrs
+{
+
+    namespace
+    {
+        // 4:2:0 MCU is 16x16 luma pixels
+        constexpr u32 MCU_SIZE = 16;
+
+        // More strips than threads so uneven content still balances
+        constexpr u32 STRIPS_PER_THREAD = 2;
+
+        // DRI stores the restart interval in 16 bits
+        constexpr u32 MAX_RESTART_INTERVAL = 65535;
+
+        constexpr u8 MARKER_SOF0 = 0xC0;
+        constexpr u8 MARKER_RST0 = 0xD0;
+        constexpr u8 MARKER_EOI = 0xD9;
+        constexpr u8 MARKER_SOS = 0xDA;
+
+        struct ErrorManager
+        {
+            jpeg_error_mgr pub;
+            std::jmp_buf jump;
+            char message[JMSG_LENGTH_MAX];
+        };
+
+        void on_error_exit(j_common_ptr cinfo)
+        {
+            auto *err = reinterpret_cast<ErrorManager *>(cinfo->err);
+            (*cinfo->err->format_message)(cinfo, err->message);
+            std::longjmp(err->jump, 1);
+        }
+
+        void on_output_message(j_common_ptr)
+        {
+            // Warnings are not useful per frame
+        }
+
+        /**
+         * Locate the SOF0 marker and the first byte of entropy-coded data.
+         * @return false if the stream does not look like our baseline output
+         */
+        bool find_scan(const u8 *data, size_t size, size_t &sof_pos, size_t &scan_start)
+        {
+            size_t pos = 2; // Skip SOI
+            sof_pos = 0;
+            while (pos + 4 <= size)
+            {
+                if (data[pos] != 0xFF)
+                    return false;
+
+                const u8 marker = data[pos + 1];
+                const size_t length = (static_cast<size_t>(data[pos + 2]) << 8) | data[pos + 3];
+
+                if (marker == MARKER_SOF0)
+                    sof_pos = pos;
+
+                pos += 2 + length;
+                if (marker == MARKER_SOS)
+                {
+                    scan_start = pos;
+                    return sof_pos != 0 && scan_start + 2 <= size;
+                }
+            }
+            return false;
+        }
+    } // namespace
+
+    /**
+     * Per-strip libjpeg compressor with a growable in-memory destination.
+     */
+    struct ParallelJPEGEncoder::StripContext
+    {
+        jpeg_compress_struct cinfo{};
+        ErrorManager err{};
+        jpeg_destination_mgr dest{};
+        std::vector<u8> buffer;
+        size_t used = 0;
+        std::vector<u8> rows; // encode_rows(): one MCU row from the RowSource
+
+        StripContext()
+        {
+            cinfo.err = jpeg_std_error(&err.pub);
+            err.pub.error_exit = on_error_exit;
+            err.pub.output_message = on_output_message;
+            jpeg_create_compress(&cinfo);
+
+            dest.init_destination = [](j_compress_ptr c)
+            {
+                auto *self = static_cast<StripContext *>(c->client_data);
+                self->dest.next_output_byte = self->buffer.data();
+                self->dest.free_in_buffer = self->buffer.size();
+            };
+            dest.empty_output_buffer = [](j_compress_ptr c) -> boolean
+            {
+                // Out of space: double the buffer and keep going (warm-up only)
+                auto *self = static_cast<StripContext *>(c->client_data);
+                const size_t old_size = self->buffer.size();
+                self->buffer.resize(old_size * 2);
+                self->dest.next_output_byte = self->buffer.data() + old_size;
+                self->dest.free_in_buffer = self->buffer.size() - old_size;
+                return TRUE;
+            };
+            dest.term_destination = [](j_compress_ptr c)
+            {
+                auto *self = static_cast<StripContext *>(c->client_data);
+                self->used = self->buffer.size() - self->dest.free_in_buffer;
+            };
+
+            cinfo.client_data = this;
+            cinfo.dest = &dest;
+        }
+
+        ~StripContext()
+        {
+            jpeg_destroy_compress(&cinfo);
+        }
+
+        StripContext(const StripContext &) = delete;
+        StripContext &operator=(const StripContext &) = delete;
+    };
+
+    ParallelJPEGEncoder::ParallelJPEGEncoder(u32 num_threads)
+    {
+        if (num_threads == 0)
+        {
+            num_threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+        }
+        num_threads_ = num_threads;
+
+        strips_.reserve(num_threads_ * STRIPS_PER_THREAD);
+        for (u32 i = 0; i < num_threads_ * STRIPS_PER_THREAD; ++i)
+        {
+            strips_.push_back(std::make_unique<StripContext>());
+        }
+
+        VRS_LOG_INFO(std::format("Parallel JPEG encoder initialized ({} threads)", num_threads_));
+    }
+
+    ParallelJPEGEncoder::~ParallelJPEGEncoder() = default;
+
+    void ParallelJPEGEncoder::set_adaptive_huffman(u32 interval_ms)
+    {
+        if (interval_ms == huffman_interval_ms_)
+            return;
+
+        huffman_interval_ms_ = interval_ms;
+        huffman_learner_ = (interval_ms > 0) ? std::make_unique<HuffmanLearner>(interval_ms) : nullptr;
+    }
+
+    HuffmanLearner::Stats ParallelJPEGEncoder::huffman_stats() const
+    {
+        return huffman_learner_ ? huffman_learner_->stats() : HuffmanLearner::Stats{};
+    }
+
+    bool ParallelJPEGEncoder::encode_strip(
+        StripContext &strip,
+        const u8 *input,
+        const RowSource *source,
+        u32 first_row,
+        u32 width, u32 rows,
+        u32 pitch, u32 channels,
+        u32 quality,
+        u32 restart_interval,
+        const HuffmanTables &tables)
+    {
+        jpeg_compress_struct &cinfo = strip.cinfo;
+
+        // Worst case is roughly the raw size; only grows on geometry change
+        const size_t estimate = static_cast<size_t>(width) * rows * 3 / 2 + 4096;
+        if (strip.buffer.size() < estimate)
+        {
+            strip.buffer.resize(estimate);
+        }
+
+        if (setjmp(strip.err.jump))
+        {
+            jpeg_abort_compress(&cinfo);
+            return false;
+        }
+
+        cinfo.image_width = width;
+        cinfo.image_height = rows;
+        cinfo.input_components = static_cast<int>(channels);
+        cinfo.in_color_space = (channels == 4) ? JCS_EXT_BGRA : JCS_EXT_BGR;
+
+        jpeg_set_defaults(&cinfo);                      // YCbCr 4:2:0, Annex K tables
+        jpeg_set_quality(&cinfo, static_cast<int>(quality), TRUE);
+        cinfo.dct_method = JDCT_IFAST;                  // Same as TJFLAG_FASTDCT
+        cinfo.restart_interval = restart_interval;
+        install_huffman_tables(&cinfo, tables); // Explicit, see install_huffman_tables()
+
+        if (!input && strip.rows.size() < static_cast<size_t>(pitch) * MCU_SIZE)
+        {
+            strip.rows.resize(static_cast<size_t>(pitch) * MCU_SIZE);
+        }
+
+        jpeg_start_compress(&cinfo, TRUE);
+
+        JSAMPROW row_pointers[MCU_SIZE];
+        while (cinfo.next_scanline < cinfo.image_height)
+        {
+            const u32 batch = std::min(MCU_SIZE, cinfo.image_height - cinfo.next_scanline);
+            const u8 *batch_input = strip.rows.data();
+            if (input)
+            {
+                batch_input = input + static_cast<size_t>(cinfo.next_scanline) * pitch;
+            }
+            else
+            {
+                // Produced just before compression, so it is still in cache when read
+                (*source)(first_row + cinfo.next_scanline, batch, strip.rows.data(), pitch);
+            }
+            for (u32 i = 0; i < batch; ++i)
+            {
+                row_pointers[i] = const_cast<JSAMPROW>(batch_input + static_cast<size_t>(i) * pitch);
+            }
+            jpeg_write_scanlines(&cinfo, row_pointers, batch);
+        }
+
+        jpeg_finish_compress(&cinfo);
+        return true;
+    }
+
+    size_t ParallelJPEGEncoder::encode(
+        const u8 *input,
+        u32 width, u32 height,
+        u32 pitch, u32 channels,
+        u32 quality,
+        CompressedFrame &output)
+    {
+        return encode_frame(input, nullptr, width, height, pitch, channels, quality, output);
+    }
+
+    size_t ParallelJPEGEncoder::encode_rows(
+        const RowSource &source,
+        u32 width, u32 height,
+        u32 quality,
+        CompressedFrame &output)
+    {
+        return encode_frame(nullptr, &source, width, height, width * 3, 3, quality, output);
+    }
+
+    size_t ParallelJPEGEncoder::encode_frame(
+        const u8 *input,
+        const RowSource *source,
+        u32 width, u32 height,
+        u32 pitch, u32 channels,
+        u32 quality,
+        CompressedFrame &output)
+    {
+        if (strips_.empty() || width == 0 || height == 0)
+            return 0;
+
+        Timer timer;
+
+        // Split into strips of whole MCU rows
+        const u32 mcus_per_row = (width + MCU_SIZE - 1) / MCU_SIZE;
+        const u32 mcu_rows = (height + MCU_SIZE - 1) / MCU_SIZE;
+        const u32 max_rows_per_strip = std::max(1u, MAX_RESTART_INTERVAL / mcus_per_row);
+
+        u32 strip_count = std::min(num_threads_ * STRIPS_PER_THREAD, mcu_rows);
+        u32 rows_per_strip = std::min((mcu_rows + strip_count - 1) / strip_count, max_rows_per_strip);
+        strip_count = (mcu_rows + rows_per_strip - 1) / rows_per_strip;
+
+        while (strips_.size() < strip_count)
+        {
+            strips_.push_back(std::make_unique<StripContext>());
+        }
+
+        // One snapshot for the whole frame so every strip shares its DHT
+        std::shared_ptr<const HuffmanTables> learned;
+        if (huffman_learner_)
+        {
+            learned = huffman_learner_->tables();
+        }
+        const HuffmanTables &tables = learned ? *learned : annex_k_huffman_tables();
+
+        const u32 strip_height = rows_per_strip * MCU_SIZE;
+        const u32 restart_interval = (strip_count > 1) ? rows_per_strip * mcus_per_row : 0;
+
+        // Workers and the calling thread pull strips until none are left
+        std::atomic<bool> failed{false};
+
+        auto encode_one = [&](size_t i)
+        {
+            const u32 y = static_cast<u32>(i) * strip_height;
+            const u32 rows = std::min(strip_height, height - y);
+            const u8 *strip_input = input ? input + static_cast<size_t>(y) * pitch : nullptr;
+            if (!encode_strip(*strips_[i], strip_input, source, y,
+                              width, rows, pitch, channels, quality, restart_interval, tables))
+            {
+                failed.store(true, std::memory_order_relaxed);
+            }
+        };
+
+        // The calling thread encodes strips too, so it takes num_threads_ - 1 shared workers
+        get_global_thread_pool().run_with_helpers(num_threads_ - 1, strip_count, encode_one);
+
+        if (failed.load())
+        {
+            for (u32 i = 0; i < strip_count; ++i)
+            {
+                if (strips_[i]->err.message[0] != '\0')
+                {
+                    VRS_LOG_ERROR(std::format("Parallel JPEG strip {} failed: {}", i, strips_[i]->err.message));
+                    strips_[i]->err.message[0] = '\0';
+                }
+            }
+            output.clear();
+            return 0;
+        }
+
+        // Stitch: headers of strip 0, then entropy data separated by RSTn, then EOI
+        const StripContext &first = *strips_[0];
+        size_t sof_pos = 0;
+        size_t header_size = 0;
+        if (!find_scan(first.buffer.data(), first.used, sof_pos, header_size))
+        {
+            VRS_LOG_ERROR("Parallel JPEG: malformed strip header");
+            output.clear();
+            return 0;
+        }
+
+        // Strip headers differ only in the SOF height, so the scan starts at the same offset
+        size_t total_size = header_size + 2;
+        for (u32 i = 0; i < strip_count; ++i)
+        {
+            total_size += strips_[i]->used - header_size - 2; // Strip EOI
+            if (i > 0)
+                total_size += 2; // RSTn
+        }
+
+        output.reserve(total_size);
+        u8 *out = output.ptr();
+
+        std::memcpy(out, first.buffer.data(), header_size);
+        out[sof_pos + 5] = static_cast<u8>(height >> 8);
+        out[sof_pos + 6] = static_cast<u8>(height & 0xFF);
+        size_t offset = header_size;
+
+        for (u32 i = 0; i < strip_count; ++i)
+        {
+            const StripContext &strip = *strips_[i];
+            if (i > 0)
+            {
+                out[offset++] = 0xFF;
+                out[offset++] = static_cast<u8>(MARKER_RST0 + ((i - 1) & 7));
+            }
+            const size_t scan_size = strip.used - header_size - 2;
+            std::memcpy(out + offset, strip.buffer.data() + header_size, scan_size);
+            offset += scan_size;
+        }
+
+        out[offset++] = 0xFF;
+        out[offset++] = MARKER_EOI;
+        output.length = offset;
+
+        // Sampling is a strided row copy at most once per interval
+        if (huffman_learner_)
+        {
+            if (input)
+            {
+                huffman_learner_->offer(input, width, height, pitch, channels, quality);
+            }
+            else
+            {
+                huffman_learner_->offer(*source, width, height, channels, quality);
+            }
+        }
+
+        last_encode_time_ = timer.elapsed_ms();
+        return offset;
+    }
+
+} // namespace vrs
@@ -0,0 +1,153 @@
+/**
+ * VR Streamer - JPEG Rate Controller Implementation
+ */
+
+#include "encoder/rate_controller.hpp"
+#include <cmath>
+
+namespace vrs
+{
+
+    namespace
+    {
+        // Fitted on photo and synthetic SBS content with libjpeg (q20..q95)
+        constexpr f64 DEFAULT_EXPONENT = 0.55;
+        constexpr f64 MIN_EXPONENT = 0.25;
+        constexpr f64 MAX_EXPONENT = 1.5;
+
+        constexpr f64 DEAD_BAND = 0.10;     // Keep quality while within +-10% of budget
+        constexpr f64 OVERSHOOT = 1.5;      // Beyond this, cut hard
+        constexpr i32 MAX_RAISE = 3;        // Quality steps per frame
+        constexpr i32 MAX_CUT = 8;
+        constexpr i32 MAX_OVERSHOOT_CUT = 20;
+        constexpr f64 SCENE_CUT = 0.405; // log(1.5): prediction error that restarts the fit
+
+        /**
+         * libjpeg's quality scaling (jpeg_quality_scaling), as a factor.
+         */
+        f64 quality_scale(u32 quality) noexcept
+        {
+            quality = std::clamp(quality, 1u, 100u);
+            const f64 scale = (quality < 50) ? 5000.0 / quality : 200.0 - 2.0 * quality;
+            return std::max(scale, 1.0);
+        }
+
+        /**
+         * Inverse of quality_scale(), rounded.
+         */
+        i32 quality_for_scale(f64 scale) noexcept
+        {
+            const f64 quality = (scale >= 100.0) ? 5000.0 / scale : (200.0 - scale) / 2.0;
+            return static_cast<i32>(std::lround(std::clamp(quality, 1.0, 100.0)));
+        }
+    } // namespace
+
+    void RateController::reset(u32 quality)
+    {
+        quality_ = std::clamp(quality, 1u, 100u);
+        log_content_ = 0;
+        exponent_ = DEFAULT_EXPONENT;
+        primed_ = false;
+        history_count_ = 0;
+        history_next_ = 0;
+    }
+
+    f64 RateController::predict(u32 quality) const noexcept
+    {
+        if (!primed_)
+        {
+            return 0;
+        }
+        return std::exp(log_content_ - exponent_ * std::log(quality_scale(quality)));
+    }
+
+    void RateController::update(u32 quality, size_t bytes, u32 budget, u32 min_quality, u32 max_quality)
+    {
+        if (bytes == 0 || budget == 0)
+        {
+            return;
+        }
+
+        const f64 log_scale = std::log(quality_scale(quality));
+        const f64 log_bytes = std::log(static_cast<f64>(bytes));
+
+        if (primed_ && std::abs(log_bytes - (log_content_ - exponent_ * log_scale)) > SCENE_CUT)
+        {
+            // Far off the prediction: new content, older samples would bend the fit
+            history_count_ = 0;
+            history_next_ = 0;
+        }
+
+        history_[history_next_] = {log_scale, log_bytes};
+        history_next_ = (history_next_ + 1) % HISTORY;
+        history_count_ = std::min(history_count_ + 1, HISTORY);
+        refit_exponent();
+
+        // Content term from this frame alone, so scene cuts are picked up at once
+        log_content_ = log_bytes + exponent_ * log_scale;
+        primed_ = true;
+
+        min_quality = std::clamp(min_quality, 1u, 100u);
+        max_quality = std::clamp(max_quality, min_quality, 100u);
+
+        const f64 ratio = static_cast<f64>(bytes) / budget;
+        if (std::abs(ratio - 1.0) <= DEAD_BAND)
+        {
+            quality_ = std::clamp(quality, min_quality, max_quality);
+            return;
+        }
+
+        // Scale that makes c * S^-a hit the budget
+        const f64 target_scale = std::exp((log_content_ - std::log(static_cast<f64>(budget))) / exponent_);
+        i32 step = quality_for_scale(target_scale) - static_cast<i32>(quality);
+
+        if (step > 0)
+        {
+            step = std::min(step, MAX_RAISE);
+        }
+        else
+        {
+            step = std::max(step, -(ratio > OVERSHOOT ? MAX_OVERSHOOT_CUT : MAX_CUT));
+        }
+
+        quality_ = static_cast<u32>(std::clamp(static_cast<i32>(quality) + step,
+                                               static_cast<i32>(min_quality), static_cast<i32>(max_quality)));
+    }
+
+    void RateController::refit_exponent()
+    {
+        if (history_count_ < 4)
+        {
+            return;
+        }
+
+        f64 mean_x = 0;
+        f64 mean_y = 0;
+        for (u32 i = 0; i < history_count_; ++i)
+        {
+            mean_x += history_[i].log_scale;
+            mean_y += history_[i].log_bytes;
+        }
+        mean_x /= history_count_;
+        mean_y /= history_count_;
+
+        f64 var_x = 0;
+        f64 cov_xy = 0;
+        for (u32 i = 0; i < history_count_; ++i)
+        {
+            const f64 dx = history_[i].log_scale - mean_x;
+            var_x += dx * dx;
+            cov_xy += dx * (history_[i].log_bytes - mean_y);
+        }
+
+        // Needs a spread of qualities; content changes alone say nothing about the slope
+        if (var_x / history_count_ < 0.01)
+        {
+            return;
+        }
+
+        const f64 fitted = std::clamp(-cov_xy / var_x, MIN_EXPONENT, MAX_EXPONENT);
+        exponent_ = 0.7 * exponent_ + 0.3 * fitted;
+    }
+
+} // namespace vrs
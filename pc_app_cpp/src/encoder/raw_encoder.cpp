@@ -0,0 +1,250 @@
+/**
+ * VR Streamer - Lossless RAW Encoder Implementation
+ */
+
+#include "encoder/raw_encoder.hpp"
+#include "network/frame_protocol.hpp"
+
+namespace vrs
+{
+
+    namespace
+    {
+        constexpr u8 PREDICT_NONE = 0;
+        constexpr u8 PREDICT_UP = 1;
+
+        constexpr u8 OP_INDEX = 0x00;
+        constexpr u8 OP_DIFF = 0x40;
+        constexpr u8 OP_LUMA = 0x80;
+        constexpr u8 OP_RUN = 0xC0;
+        constexpr u8 OP_RGB = 0xFE;
+        constexpr u32 MAX_RUN = 62;
+
+        // Worst case per row: predictor byte plus an RGB op per value
+        constexpr size_t MAX_BYTES_PER_VALUE = 4;
+
+        /**
+         * Load one pixel as 0x00RRGGBB (memory order B, G, R).
+         */
+        VRS_FORCEINLINE u32 load_pixel(const u8 *p) noexcept
+        {
+            return static_cast<u32>(p[0]) | (static_cast<u32>(p[1]) << 8) | (static_cast<u32>(p[2]) << 16);
+        }
+
+        /**
+         * Per-channel a - b mod 256 on packed pixels.
+         */
+        VRS_FORCEINLINE u32 sub_bytes(u32 a, u32 b) noexcept
+        {
+            constexpr u32 H = 0x80808080u;
+            return (((a | H) - (b & ~H)) ^ ((a ^ ~b) & H)) & 0x00FFFFFFu;
+        }
+
+        /**
+         * QOI-style op writer; state persists across rows.
+         */
+        class OpWriter
+        {
+        public:
+            explicit OpWriter(u8 *out) noexcept : out_(out) {}
+
+            VRS_FORCEINLINE void put(u32 value) noexcept
+            {
+                if (value == prev_)
+                {
+                    if (++run_ == MAX_RUN)
+                    {
+                        *out_++ = static_cast<u8>(OP_RUN | (MAX_RUN - 1));
+                        run_ = 0;
+                    }
+                    return;
+                }
+                flush_run();
+
+                const u32 b = value & 0xFF;
+                const u32 g = (value >> 8) & 0xFF;
+                const u32 r = value >> 16;
+                const u32 hash = (r * 3 + g * 5 + b * 7) & 63;
+
+                if (index_[hash] == value)
+                {
+                    *out_++ = static_cast<u8>(OP_INDEX | hash);
+                }
+                else
+                {
+                    index_[hash] = value;
+
+                    const i32 dr = static_cast<i8>(r - (prev_ >> 16));
+                    const i32 dg = static_cast<i8>(g - ((prev_ >> 8) & 0xFF));
+                    const i32 db = static_cast<i8>(b - (prev_ & 0xFF));
+                    const i32 dr_dg = dr - dg;
+                    const i32 db_dg = db - dg;
+
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                    {
+                        *out_++ = static_cast<u8>(OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+                    }
+                    else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7)
+                    {
+                        out_[0] = static_cast<u8>(OP_LUMA | (dg + 32));
+                        out_[1] = static_cast<u8>(((dr_dg + 8) << 4) | (db_dg + 8));
+                        out_ += 2;
+                    }
+                    else
+                    {
+                        out_[0] = OP_RGB;
+                        out_[1] = static_cast<u8>(r);
+                        out_[2] = static_cast<u8>(g);
+                        out_[3] = static_cast<u8>(b);
+                        out_ += 4;
+                    }
+                }
+                prev_ = value;
+            }
+
+            /**
+             * Emit value count times (count >= 1).
+             */
+            VRS_FORCEINLINE void put_repeated(u32 value, u32 count) noexcept
+            {
+                put(value);
+                run_ += count - 1;
+                while (run_ >= MAX_RUN)
+                {
+                    *out_++ = static_cast<u8>(OP_RUN | (MAX_RUN - 1));
+                    run_ -= MAX_RUN;
+                }
+            }
+
+            VRS_FORCEINLINE void flush_run() noexcept
+            {
+                if (run_ > 0)
+                {
+                    *out_++ = static_cast<u8>(OP_RUN | (run_ - 1));
+                    run_ = 0;
+                }
+            }
+
+            VRS_FORCEINLINE void put_byte(u8 byte) noexcept { *out_++ = byte; }
+
+            [[nodiscard]] u8 *position() const noexcept { return out_; }
+            void rebase(u8 *out) noexcept { out_ = out; }
+
+        private:
+            u8 *out_;
+            u32 prev_ = 0;
+            u32 run_ = 0;
+            std::array<u32, 64> index_{};
+        };
+
+        /**
+         * Code one row. Identical rows become a single run of zero residuals;
+         * otherwise "up" is used when more pixels match the row above than
+         * their left neighbour (cheap proxy for which residuals run better).
+         */
+        template <u32 C>
+        void encode_row(OpWriter &writer, const u8 *row, const u8 *above, u32 width, u32 &up_rows)
+        {
+            if (above && std::memcmp(row, above, static_cast<size_t>(width) * C) == 0)
+            {
+                writer.put_byte(PREDICT_UP);
+                writer.put_repeated(0, width);
+                writer.flush_run();
+                ++up_rows;
+                return;
+            }
+
+            bool up = false;
+            if (above)
+            {
+                u32 left_hits = 0;
+                u32 up_hits = 0;
+                u32 left = load_pixel(row);
+                up_hits += (left == load_pixel(above));
+                for (u32 x = 1; x < width; ++x)
+                {
+                    const u32 pixel = load_pixel(row + x * C);
+                    left_hits += (pixel == left);
+                    up_hits += (pixel == load_pixel(above + x * C));
+                    left = pixel;
+                }
+                up = up_hits > left_hits;
+            }
+
+            if (up)
+            {
+                writer.put_byte(PREDICT_UP);
+                for (u32 x = 0; x < width; ++x)
+                {
+                    writer.put(sub_bytes(load_pixel(row + x * C), load_pixel(above + x * C)));
+                }
+                ++up_rows;
+            }
+            else
+            {
+                writer.put_byte(PREDICT_NONE);
+                for (u32 x = 0; x < width; ++x)
+                {
+                    writer.put(load_pixel(row + x * C));
+                }
+            }
+            writer.flush_run();
+        }
+    } // namespace
+
+    size_t RawEncoder::encode(
+        const u8 *input,
+        u32 width, u32 height,
+        u32 pitch, u32 channels,
+        CompressedFrame &output)
+    {
+        if (!input || width == 0 || height == 0 || width > 65535 || height > 65535 ||
+            (channels != 3 && channels != 4))
+        {
+            output.clear();
+            return 0;
+        }
+
+        Timer timer;
+
+        const size_t prefix = frame_prefix_size(1);
+        const size_t max_row = 1 + static_cast<size_t>(width) * MAX_BYTES_PER_VALUE;
+
+        // Desktop content usually lands far below raw size; grow only if a frame doesn't
+        output.reserve(prefix + static_cast<size_t>(width) * height * 3 / 2 + max_row);
+
+        OpWriter writer(output.ptr() + prefix);
+        u32 up_rows = 0;
+
+        for (u32 y = 0; y < height; ++y)
+        {
+            const size_t used = static_cast<size_t>(writer.position() - output.ptr());
+            if (used + max_row > output.capacity)
+            {
+                const size_t grown_capacity = (used + max_row) * 2;
+                auto grown = make_aligned_array<u8>(grown_capacity, CACHE_LINE_SIZE);
+                std::memcpy(grown.get(), output.ptr(), used);
+                output.data = std::move(grown);
+                output.capacity = grown_capacity;
+                writer.rebase(output.ptr() + used);
+            }
+
+            const u8 *row = input + static_cast<size_t>(y) * pitch;
+            const u8 *above = (y > 0) ? row - pitch : nullptr;
+            if (channels == 4)
+                encode_row<4>(writer, row, above, width, up_rows);
+            else
+                encode_row<3>(writer, row, above, width, up_rows);
+        }
+
+        const size_t payload = static_cast<size_t>(writer.position() - output.ptr()) - prefix;
+        const u32 part_sizes[1] = {static_cast<u32>(payload)};
+        write_frame_prefix(output.ptr(), FrameType::RAW, width, height, output.frame_id, part_sizes);
+
+        output.length = prefix + payload;
+        up_row_ratio_ = static_cast<f64>(up_rows) / height;
+        last_encode_time_ = timer.elapsed_ms();
+        return output.length;
+    }
+
+} // namespace vrs
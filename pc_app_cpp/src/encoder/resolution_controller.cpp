@@ -0,0 +1,113 @@
+/**
+ * VR Streamer - Dynamic Resolution Controller Implementation
+ */
+
+#include "encoder/resolution_controller.hpp"
+#include <cmath>
+
+namespace vrs
+{
+
+    namespace
+    {
+        constexpr std::array<f32, 7> LADDER = {1.0f, 0.75f, 2.0f / 3.0f, 0.5f, 0.4f, 1.0f / 3.0f, 0.25f};
+
+        constexpr f64 SMOOTHING = 0.2;    // Moving average weight of the newest frame
+        constexpr f64 OVERLOAD = 0.9;     // Step down once the average exceeds this share of the budget
+        constexpr u32 SETTLE_FRAMES = 8;  // Frames before a new rung's timing is trusted
+        constexpr u32 HOLD_FRAMES = 90;   // Frames at a rung before trying the one above
+
+        /**
+         * Whether 1/scale is a whole number: every output pixel then maps to
+         * a fixed source stride on both axes.
+         */
+        bool integer_ratio(f32 scale) noexcept
+        {
+            const f32 ratio = 1.0f / scale;
+            return std::abs(ratio - std::round(ratio)) < 1e-3f;
+        }
+    } // namespace
+
+    void ResolutionController::reset(f32 max_scale, f32 min_scale)
+    {
+        max_scale = std::clamp(max_scale, 0.1f, 1.0f);
+        min_scale = std::clamp(min_scale, 0.1f, max_scale);
+
+        rungs_.clear();
+        rungs_.push_back(max_scale);
+        for (f32 rung : LADDER)
+        {
+            if (rung < max_scale - 0.01f && rung >= min_scale - 0.001f)
+            {
+                rungs_.push_back(rung);
+            }
+        }
+
+        rung_ = 0;
+        average_ms_ = 0;
+        frames_at_rung_ = 0;
+    }
+
+    f64 ResolutionController::headroom(size_t rung, bool stepping_up) const noexcept
+    {
+        const bool cheap = integer_ratio(rungs_[rung]);
+        if (stepping_up)
+        {
+            return cheap ? 0.65 : 0.55;
+        }
+        return cheap ? 0.85 : 0.75;
+    }
+
+    f64 ResolutionController::predicted_ms(size_t rung) const noexcept
+    {
+        const f64 ratio = static_cast<f64>(rungs_[rung]) / rungs_[rung_];
+        return average_ms_ * ratio * ratio;
+    }
+
+    bool ResolutionController::update(f64 frame_time_ms, f64 budget_ms)
+    {
+        if (frame_time_ms <= 0 || budget_ms <= 0 || rungs_.size() < 2)
+        {
+            return false;
+        }
+
+        ++frames_at_rung_;
+        if (frames_at_rung_ <= SETTLE_FRAMES)
+        {
+            // First frames after a change rebuild plans and buffers; seed from the last one
+            average_ms_ = frame_time_ms;
+            return false;
+        }
+        average_ms_ += SMOOTHING * (frame_time_ms - average_ms_);
+
+        size_t next = rung_;
+        if (average_ms_ > OVERLOAD * budget_ms)
+        {
+            // Largest smaller rung predicted to fit, else the smallest
+            next = rungs_.size() - 1;
+            for (size_t i = rung_ + 1; i < rungs_.size(); ++i)
+            {
+                if (predicted_ms(i) <= headroom(i, false) * budget_ms)
+                {
+                    next = i;
+                    break;
+                }
+            }
+        }
+        else if (rung_ > 0 && frames_at_rung_ > HOLD_FRAMES &&
+                 predicted_ms(rung_ - 1) <= headroom(rung_ - 1, true) * budget_ms)
+        {
+            next = rung_ - 1;
+        }
+
+        if (next == rung_)
+        {
+            return false;
+        }
+
+        rung_ = next;
+        frames_at_rung_ = 0;
+        return true;
+    }
+
+} // namespace vrs
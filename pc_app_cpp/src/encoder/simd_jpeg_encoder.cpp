@@ -0,0 +1,1147 @@
+/**
+ * VR Streamer - Built-in JPEG Encoder Implementation
+ * Dependency-free baseline 4:2:0 encoder with AVX2/NEON kernels.
+ */
+
+#include "encoder/jpeg_encoder.hpp"
+
+#include <cmath>
+
+#if VRS_HAS_AVX2
+#define VRS_JPEG_AVX2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define VRS_JPEG_NEON 1
+#endif
+
+namespace vrs
+{
+
+    namespace
+    {
+        // 4:2:0 MCU is 16x16 luma pixels: four Y blocks, one Cb, one Cr
+        constexpr u32 MCU_SIZE = 16;
+
+        // Worst case for one MCU: 6 blocks x 64 symbols x 27 bits, doubled for 0xFF stuffing
+        constexpr size_t MAX_MCU_BYTES = 6 * 64 * 27 / 8 * 2;
+
+        constexpr u8 NATURAL_ORDER[64] = {
+            0, 1, 8, 16, 9, 2, 3, 10,
+            17, 24, 32, 25, 18, 11, 4, 5,
+            12, 19, 26, 33, 40, 48, 41, 34,
+            27, 20, 13, 6, 7, 14, 21, 28,
+            35, 42, 49, 56, 57, 50, 43, 36,
+            29, 22, 15, 23, 30, 37, 44, 51,
+            58, 59, 52, 45, 38, 31, 39, 46,
+            53, 60, 61, 54, 47, 55, 62, 63};
+
+        // Inverse of NATURAL_ORDER: zig-zag position of each natural-order coefficient
+        constexpr std::array<u8, 64> ZIGZAG_INDEX = []
+        {
+            std::array<u8, 64> index{};
+            for (u8 k = 0; k < 64; ++k)
+                index[NATURAL_ORDER[k]] = k;
+            return index;
+        }();
+
+        // JPEG Annex K quantisation tables (natural order)
+        constexpr u8 LUMA_QUANT[64] = {
+            16, 11, 10, 16, 24, 40, 51, 61,
+            12, 12, 14, 19, 26, 58, 60, 55,
+            14, 13, 16, 24, 40, 57, 69, 56,
+            14, 17, 22, 29, 51, 87, 80, 62,
+            18, 22, 37, 56, 68, 109, 103, 77,
+            24, 35, 55, 64, 81, 104, 113, 92,
+            49, 64, 78, 87, 103, 121, 120, 101,
+            72, 92, 95, 98, 112, 100, 103, 99};
+
+        constexpr u8 CHROMA_QUANT[64] = {
+            17, 18, 24, 47, 99, 99, 99, 99,
+            18, 21, 26, 66, 99, 99, 99, 99,
+            24, 26, 56, 99, 99, 99, 99, 99,
+            47, 66, 99, 99, 99, 99, 99, 99,
+            99, 99, 99, 99, 99, 99, 99, 99,
+            99, 99, 99, 99, 99, 99, 99, 99,
+            99, 99, 99, 99, 99, 99, 99, 99,
+            99, 99, 99, 99, 99, 99, 99, 99};
+
+        // JPEG Annex K Huffman tables (code counts for lengths 1..16, then symbols)
+        constexpr u8 DC_LUMA_BITS[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+        constexpr u8 DC_CHROMA_BITS[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+        constexpr u8 DC_VALUES[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+        constexpr u8 AC_LUMA_BITS[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+        constexpr u8 AC_LUMA_VALUES[162] = {
+            0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+            0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+            0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+            0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+            0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+            0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+            0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+            0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+            0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+            0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+            0xf9, 0xfa};
+
+        constexpr u8 AC_CHROMA_BITS[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+        constexpr u8 AC_CHROMA_VALUES[162] = {
+            0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+            0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+            0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+            0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+            0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+            0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+            0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+            0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+            0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+            0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+            0xf9, 0xfa};
+
+        // AAN output scale per frequency: 1 for k = 0, cos(k*pi/16) * sqrt(2) otherwise
+        constexpr f64 AAN_SCALE[8] = {
+            1.0, 1.387039845, 1.306562965, 1.175875602,
+            1.0, 0.785694958, 0.541196100, 0.275899379};
+
+        // Fixed-point AAN constants (8 fractional bits, as libjpeg's jfdctfst)
+        constexpr i32 FIX_0_382683433 = 98;
+        constexpr i32 FIX_0_541196100 = 139;
+        constexpr i32 FIX_0_707106781 = 181;
+        constexpr i32 FIX_1_306562965 = 334;
+
+        /**
+         * Code/length lookup for one Huffman table, indexed by symbol.
+         */
+        struct HuffmanCodes
+        {
+            std::array<u16, 256> code{};
+            std::array<u8, 256> size{};
+        };
+
+        HuffmanCodes build_codes(const u8 *bits, const u8 *values)
+        {
+            HuffmanCodes codes;
+            u32 code = 0;
+            size_t k = 0;
+            for (u32 length = 1; length <= 16; ++length)
+            {
+                for (u32 i = 0; i < bits[length - 1]; ++i)
+                {
+                    codes.code[values[k]] = static_cast<u16>(code);
+                    codes.size[values[k]] = static_cast<u8>(length);
+                    ++code;
+                    ++k;
+                }
+                code <<= 1;
+            }
+            return codes;
+        }
+
+        const HuffmanCodes &dc_luma_codes()
+        {
+            static const HuffmanCodes codes = build_codes(DC_LUMA_BITS, DC_VALUES);
+            return codes;
+        }
+
+        const HuffmanCodes &dc_chroma_codes()
+        {
+            static const HuffmanCodes codes = build_codes(DC_CHROMA_BITS, DC_VALUES);
+            return codes;
+        }
+
+        const HuffmanCodes &ac_luma_codes()
+        {
+            static const HuffmanCodes codes = build_codes(AC_LUMA_BITS, AC_LUMA_VALUES);
+            return codes;
+        }
+
+        const HuffmanCodes &ac_chroma_codes()
+        {
+            static const HuffmanCodes codes = build_codes(AC_CHROMA_BITS, AC_CHROMA_VALUES);
+            return codes;
+        }
+
+        /**
+         * Big-endian entropy bit writer with 0xFF byte stuffing.
+         */
+        class BitWriter
+        {
+        public:
+            explicit BitWriter(u8 *out) noexcept : out_(out) {}
+
+            VRS_FORCEINLINE void put(u32 value, u32 size) noexcept
+            {
+                acc_ = (acc_ << size) | value;
+                bits_ += size;
+                if (bits_ >= 32)
+                {
+                    bits_ -= 32;
+                    emit32(static_cast<u32>(acc_ >> bits_));
+                }
+            }
+
+            /**
+             * Pad the last byte with 1 bits and write out what is left.
+             */
+            void flush() noexcept
+            {
+                if (bits_ & 7)
+                {
+                    const u32 pad = 8 - (bits_ & 7);
+                    put((1u << pad) - 1, pad);
+                }
+                while (bits_ > 0)
+                {
+                    bits_ -= 8;
+                    emit8(static_cast<u8>(acc_ >> bits_));
+                }
+            }
+
+            [[nodiscard]] u8 *position() const noexcept { return out_; }
+            void rebase(u8 *out) noexcept { out_ = out; }
+
+        private:
+            VRS_FORCEINLINE void emit8(u8 byte) noexcept
+            {
+                *out_++ = byte;
+                if (byte == 0xFF)
+                    *out_++ = 0x00;
+            }
+
+            VRS_FORCEINLINE void emit32(u32 word) noexcept
+            {
+                // Fast path: no 0xFF byte in the word
+                const u32 inverted = ~word;
+                if (((inverted - 0x01010101u) & ~inverted & 0x80808080u) == 0)
+                {
+                    const u8 bytes[4] = {static_cast<u8>(word >> 24), static_cast<u8>(word >> 16),
+                                         static_cast<u8>(word >> 8), static_cast<u8>(word)};
+                    std::memcpy(out_, bytes, 4);
+                    out_ += 4;
+                    return;
+                }
+                emit8(static_cast<u8>(word >> 24));
+                emit8(static_cast<u8>(word >> 16));
+                emit8(static_cast<u8>(word >> 8));
+                emit8(static_cast<u8>(word));
+            }
+
+            u8 *out_;
+            u64 acc_ = 0;
+            u32 bits_ = 0;
+        };
+
+        /**
+         * Huffman-code one quantised block.
+         * @param coefs Natural-order coefficients
+         * @param nonzero Bit k set when the k-th coefficient in zig-zag order is nonzero
+         */
+        VRS_FORCEINLINE void encode_block(
+            BitWriter &writer,
+            const i16 *coefs, u64 nonzero,
+            i16 &last_dc,
+            const HuffmanCodes &dc, const HuffmanCodes &ac)
+        {
+            const i32 diff = coefs[0] - last_dc;
+            last_dc = coefs[0];
+
+            const u32 magnitude = static_cast<u32>(diff < 0 ? -diff : diff);
+            const u32 dc_bits = static_cast<u32>(std::bit_width(magnitude));
+            const u32 dc_value = static_cast<u32>(diff < 0 ? diff - 1 : diff) & ((1u << dc_bits) - 1);
+            writer.put((static_cast<u32>(dc.code[dc_bits]) << dc_bits) | dc_value, dc.size[dc_bits] + dc_bits);
+
+            // Walk the set bits only: runs of zeros cost nothing to skip
+            u64 mask = nonzero & ~u64{1};
+            u32 last = 0;
+            while (mask)
+            {
+                const u32 k = static_cast<u32>(std::countr_zero(mask));
+                mask &= mask - 1;
+
+                u32 run = k - last - 1;
+                while (run >= 16)
+                {
+                    writer.put(ac.code[0xF0], ac.size[0xF0]); // ZRL
+                    run -= 16;
+                }
+
+                const i32 v = coefs[NATURAL_ORDER[k]];
+                const u32 size = static_cast<u32>(std::bit_width(static_cast<u32>(v < 0 ? -v : v)));
+                const u32 value = static_cast<u32>(v < 0 ? v - 1 : v) & ((1u << size) - 1);
+                const u32 symbol = (run << 4) | size;
+                writer.put((static_cast<u32>(ac.code[symbol]) << size) | value, ac.size[symbol] + size);
+                last = k;
+            }
+
+            if (last != 63)
+            {
+                writer.put(ac.code[0x00], ac.size[0x00]); // EOB
+            }
+        }
+
+        // ------------------------------------------------------------------
+        // Forward DCT (AAN, fixed point, in place on 64 level-shifted samples)
+        // ------------------------------------------------------------------
+
+#if VRS_JPEG_AVX2
+
+        // Two blocks at once: block A in the low 128-bit lane, block B in the high one.
+        // AVX2 unpacks stay within lanes, so each lane is transposed on its own.
+
+        VRS_FORCEINLINE void transpose_8x8x2(__m256i r[8]) noexcept
+        {
+            const __m256i a0 = _mm256_unpacklo_epi16(r[0], r[1]);
+            const __m256i a1 = _mm256_unpackhi_epi16(r[0], r[1]);
+            const __m256i a2 = _mm256_unpacklo_epi16(r[2], r[3]);
+            const __m256i a3 = _mm256_unpackhi_epi16(r[2], r[3]);
+            const __m256i a4 = _mm256_unpacklo_epi16(r[4], r[5]);
+            const __m256i a5 = _mm256_unpackhi_epi16(r[4], r[5]);
+            const __m256i a6 = _mm256_unpacklo_epi16(r[6], r[7]);
+            const __m256i a7 = _mm256_unpackhi_epi16(r[6], r[7]);
+
+            const __m256i b0 = _mm256_unpacklo_epi32(a0, a2);
+            const __m256i b1 = _mm256_unpackhi_epi32(a0, a2);
+            const __m256i b2 = _mm256_unpacklo_epi32(a1, a3);
+            const __m256i b3 = _mm256_unpackhi_epi32(a1, a3);
+            const __m256i b4 = _mm256_unpacklo_epi32(a4, a6);
+            const __m256i b5 = _mm256_unpackhi_epi32(a4, a6);
+            const __m256i b6 = _mm256_unpacklo_epi32(a5, a7);
+            const __m256i b7 = _mm256_unpackhi_epi32(a5, a7);
+
+            r[0] = _mm256_unpacklo_epi64(b0, b4);
+            r[1] = _mm256_unpackhi_epi64(b0, b4);
+            r[2] = _mm256_unpacklo_epi64(b1, b5);
+            r[3] = _mm256_unpackhi_epi64(b1, b5);
+            r[4] = _mm256_unpacklo_epi64(b2, b6);
+            r[5] = _mm256_unpackhi_epi64(b2, b6);
+            r[6] = _mm256_unpacklo_epi64(b3, b7);
+            r[7] = _mm256_unpackhi_epi64(b3, b7);
+        }
+
+        /**
+         * One 1-D AAN pass across the eight registers (every lane is a line).
+         * Products use mulhi on operands pre-scaled by 4 against constants
+         * scaled by 64, i.e. (x * c) >> 8 with 16-bit lanes.
+         */
+        VRS_FORCEINLINE void fdct_pass(__m256i d[8]) noexcept
+        {
+            const __m256i k0382 = _mm256_set1_epi16(static_cast<i16>(FIX_0_382683433 << 6));
+            const __m256i k0541 = _mm256_set1_epi16(static_cast<i16>(FIX_0_541196100 << 6));
+            const __m256i k0707 = _mm256_set1_epi16(static_cast<i16>(FIX_0_707106781 << 6));
+            const __m256i k1306 = _mm256_set1_epi16(static_cast<i16>(FIX_1_306562965 << 6));
+
+            const __m256i tmp0 = _mm256_add_epi16(d[0], d[7]);
+            const __m256i tmp7 = _mm256_sub_epi16(d[0], d[7]);
+            const __m256i tmp1 = _mm256_add_epi16(d[1], d[6]);
+            const __m256i tmp6 = _mm256_sub_epi16(d[1], d[6]);
+            const __m256i tmp2 = _mm256_add_epi16(d[2], d[5]);
+            const __m256i tmp5 = _mm256_sub_epi16(d[2], d[5]);
+            const __m256i tmp3 = _mm256_add_epi16(d[3], d[4]);
+            const __m256i tmp4 = _mm256_sub_epi16(d[3], d[4]);
+
+            // Even part
+            const __m256i tmp10 = _mm256_add_epi16(tmp0, tmp3);
+            const __m256i tmp13 = _mm256_sub_epi16(tmp0, tmp3);
+            const __m256i tmp11 = _mm256_add_epi16(tmp1, tmp2);
+            const __m256i tmp12 = _mm256_sub_epi16(tmp1, tmp2);
+
+            d[0] = _mm256_add_epi16(tmp10, tmp11);
+            d[4] = _mm256_sub_epi16(tmp10, tmp11);
+
+            const __m256i z1 = _mm256_mulhi_epi16(_mm256_slli_epi16(_mm256_add_epi16(tmp12, tmp13), 2), k0707);
+            d[2] = _mm256_add_epi16(tmp13, z1);
+            d[6] = _mm256_sub_epi16(tmp13, z1);
+
+            // Odd part
+            const __m256i o10 = _mm256_slli_epi16(_mm256_add_epi16(tmp4, tmp5), 2);
+            const __m256i o11 = _mm256_slli_epi16(_mm256_add_epi16(tmp5, tmp6), 2);
+            const __m256i o12 = _mm256_slli_epi16(_mm256_add_epi16(tmp6, tmp7), 2);
+
+            const __m256i z5 = _mm256_mulhi_epi16(_mm256_sub_epi16(o10, o12), k0382);
+            const __m256i z2 = _mm256_add_epi16(_mm256_mulhi_epi16(o10, k0541), z5);
+            const __m256i z4 = _mm256_add_epi16(_mm256_mulhi_epi16(o12, k1306), z5);
+            const __m256i z3 = _mm256_mulhi_epi16(o11, k0707);
+
+            const __m256i z11 = _mm256_add_epi16(tmp7, z3);
+            const __m256i z13 = _mm256_sub_epi16(tmp7, z3);
+
+            d[5] = _mm256_add_epi16(z13, z2);
+            d[3] = _mm256_sub_epi16(z13, z2);
+            d[1] = _mm256_add_epi16(z11, z4);
+            d[7] = _mm256_sub_epi16(z11, z4);
+        }
+
+        /**
+         * DCT and quantise two blocks, leaving natural-order coefficients in qa/qb
+         * and their nonzero bitmaps (bit n set when coefficient n != 0) in ma/mb.
+         * Rows are loaded straight from the sample band and never touch memory
+         * between the transform and quantisation.
+         */
+        VRS_FORCEINLINE void transform_pair(
+            const i16 *a, size_t a_stride,
+            const i16 *b, size_t b_stride,
+            const f32 *scale,
+            i16 *qa, i16 *qb,
+            u64 &ma, u64 &mb) noexcept
+        {
+            __m256i r[8];
+            for (int i = 0; i < 8; ++i)
+            {
+                r[i] = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i * a_stride))),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i * b_stride)), 1);
+            }
+
+            transpose_8x8x2(r);
+            fdct_pass(r); // Rows
+            transpose_8x8x2(r);
+            fdct_pass(r); // Columns
+
+            __m256i zero_rows[8];
+            for (int i = 0; i < 8; ++i)
+            {
+                // round(coef * scale) for row i of both blocks
+                const __m256 row_scale = _mm256_loadu_ps(scale + i * 8);
+                const __m256i lo = _mm256_cvtps_epi32(_mm256_mul_ps(
+                    _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(r[i]))), row_scale));
+                const __m256i hi = _mm256_cvtps_epi32(_mm256_mul_ps(
+                    _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(r[i], 1))), row_scale));
+                const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+                _mm_store_si128(reinterpret_cast<__m128i *>(qa + i * 8), _mm256_castsi256_si128(packed));
+                _mm_store_si128(reinterpret_cast<__m128i *>(qb + i * 8), _mm256_extracti128_si256(packed, 1));
+                zero_rows[i] = _mm256_cmpeq_epi16(packed, _mm256_setzero_si256());
+            }
+
+            // Rows i and i + 1 pack into one byte mask: A in the low 16 bits, B in the high 16
+            ma = 0;
+            mb = 0;
+            for (int i = 0; i < 8; i += 2)
+            {
+                const u32 zeros = static_cast<u32>(_mm256_movemask_epi8(_mm256_packs_epi16(zero_rows[i], zero_rows[i + 1])));
+                ma |= static_cast<u64>(~zeros & 0xFFFF) << (i * 8);
+                mb |= static_cast<u64>(~zeros >> 16) << (i * 8);
+            }
+        }
+
+#elif VRS_JPEG_NEON
+
+        VRS_FORCEINLINE void transpose_8x8(int16x8_t r[8]) noexcept
+        {
+            const int16x8x2_t t01 = vtrnq_s16(r[0], r[1]);
+            const int16x8x2_t t23 = vtrnq_s16(r[2], r[3]);
+            const int16x8x2_t t45 = vtrnq_s16(r[4], r[5]);
+            const int16x8x2_t t67 = vtrnq_s16(r[6], r[7]);
+
+            const int32x4x2_t u02 = vtrnq_s32(vreinterpretq_s32_s16(t01.val[0]), vreinterpretq_s32_s16(t23.val[0]));
+            const int32x4x2_t u13 = vtrnq_s32(vreinterpretq_s32_s16(t01.val[1]), vreinterpretq_s32_s16(t23.val[1]));
+            const int32x4x2_t u46 = vtrnq_s32(vreinterpretq_s32_s16(t45.val[0]), vreinterpretq_s32_s16(t67.val[0]));
+            const int32x4x2_t u57 = vtrnq_s32(vreinterpretq_s32_s16(t45.val[1]), vreinterpretq_s32_s16(t67.val[1]));
+
+            r[0] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u02.val[0]), vget_low_s32(u46.val[0])));
+            r[1] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u13.val[0]), vget_low_s32(u57.val[0])));
+            r[2] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u02.val[1]), vget_low_s32(u46.val[1])));
+            r[3] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u13.val[1]), vget_low_s32(u57.val[1])));
+            r[4] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u02.val[0]), vget_high_s32(u46.val[0])));
+            r[5] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u13.val[0]), vget_high_s32(u57.val[0])));
+            r[6] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u02.val[1]), vget_high_s32(u46.val[1])));
+            r[7] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u13.val[1]), vget_high_s32(u57.val[1])));
+        }
+
+        /**
+         * One 1-D AAN pass; vqdmulh doubles, so constants are scaled by 32.
+         */
+        VRS_FORCEINLINE void fdct_pass(int16x8_t d[8]) noexcept
+        {
+            const int16x8_t tmp0 = vaddq_s16(d[0], d[7]);
+            const int16x8_t tmp7 = vsubq_s16(d[0], d[7]);
+            const int16x8_t tmp1 = vaddq_s16(d[1], d[6]);
+            const int16x8_t tmp6 = vsubq_s16(d[1], d[6]);
+            const int16x8_t tmp2 = vaddq_s16(d[2], d[5]);
+            const int16x8_t tmp5 = vsubq_s16(d[2], d[5]);
+            const int16x8_t tmp3 = vaddq_s16(d[3], d[4]);
+            const int16x8_t tmp4 = vsubq_s16(d[3], d[4]);
+
+            const int16x8_t tmp10 = vaddq_s16(tmp0, tmp3);
+            const int16x8_t tmp13 = vsubq_s16(tmp0, tmp3);
+            const int16x8_t tmp11 = vaddq_s16(tmp1, tmp2);
+            const int16x8_t tmp12 = vsubq_s16(tmp1, tmp2);
+
+            d[0] = vaddq_s16(tmp10, tmp11);
+            d[4] = vsubq_s16(tmp10, tmp11);
+
+            const int16x8_t z1 = vqdmulhq_n_s16(vshlq_n_s16(vaddq_s16(tmp12, tmp13), 2), FIX_0_707106781 << 5);
+            d[2] = vaddq_s16(tmp13, z1);
+            d[6] = vsubq_s16(tmp13, z1);
+
+            const int16x8_t o10 = vshlq_n_s16(vaddq_s16(tmp4, tmp5), 2);
+            const int16x8_t o11 = vshlq_n_s16(vaddq_s16(tmp5, tmp6), 2);
+            const int16x8_t o12 = vshlq_n_s16(vaddq_s16(tmp6, tmp7), 2);
+
+            const int16x8_t z5 = vqdmulhq_n_s16(vsubq_s16(o10, o12), FIX_0_382683433 << 5);
+            const int16x8_t z2 = vaddq_s16(vqdmulhq_n_s16(o10, FIX_0_541196100 << 5), z5);
+            const int16x8_t z4 = vaddq_s16(vqdmulhq_n_s16(o12, FIX_1_306562965 << 5), z5);
+            const int16x8_t z3 = vqdmulhq_n_s16(o11, FIX_0_707106781 << 5);
+
+            const int16x8_t z11 = vaddq_s16(tmp7, z3);
+            const int16x8_t z13 = vsubq_s16(tmp7, z3);
+
+            d[5] = vaddq_s16(z13, z2);
+            d[3] = vsubq_s16(z13, z2);
+            d[1] = vaddq_s16(z11, z4);
+            d[7] = vsubq_s16(z11, z4);
+        }
+
+        void fdct_8x8(i16 *block) noexcept
+        {
+            int16x8_t r[8];
+            for (int i = 0; i < 8; ++i)
+                r[i] = vld1q_s16(block + i * 8);
+
+            transpose_8x8(r);
+            fdct_pass(r);
+            transpose_8x8(r);
+            fdct_pass(r);
+
+            for (int i = 0; i < 8; ++i)
+                vst1q_s16(block + i * 8, r[i]);
+        }
+
+        void quantize(const i16 *block, const f32 *scale, i16 *out) noexcept
+        {
+            for (int i = 0; i < 64; i += 8)
+            {
+                const int16x8_t coefs = vld1q_s16(block + i);
+                const float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(coefs)));
+                const float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(coefs)));
+                const int32x4_t qlo = vcvtnq_s32_f32(vmulq_f32(lo, vld1q_f32(scale + i)));
+                const int32x4_t qhi = vcvtnq_s32_f32(vmulq_f32(hi, vld1q_f32(scale + i + 4)));
+                vst1q_s16(out + i, vcombine_s16(vqmovn_s32(qlo), vqmovn_s32(qhi)));
+            }
+        }
+
+#else
+
+        void fdct_8x8(i16 *block) noexcept
+        {
+            auto pass = [](i16 *data, int stride, int step)
+            {
+                for (int line = 0; line < 8; ++line)
+                {
+                    i16 *p = data + line * step;
+                    const i32 tmp0 = p[0] + p[7 * stride];
+                    const i32 tmp7 = p[0] - p[7 * stride];
+                    const i32 tmp1 = p[stride] + p[6 * stride];
+                    const i32 tmp6 = p[stride] - p[6 * stride];
+                    const i32 tmp2 = p[2 * stride] + p[5 * stride];
+                    const i32 tmp5 = p[2 * stride] - p[5 * stride];
+                    const i32 tmp3 = p[3 * stride] + p[4 * stride];
+                    const i32 tmp4 = p[3 * stride] - p[4 * stride];
+
+                    const i32 tmp10 = tmp0 + tmp3;
+                    const i32 tmp13 = tmp0 - tmp3;
+                    const i32 tmp11 = tmp1 + tmp2;
+                    const i32 tmp12 = tmp1 - tmp2;
+
+                    p[0] = static_cast<i16>(tmp10 + tmp11);
+                    p[4 * stride] = static_cast<i16>(tmp10 - tmp11);
+
+                    const i32 z1 = ((tmp12 + tmp13) * FIX_0_707106781) >> 8;
+                    p[2 * stride] = static_cast<i16>(tmp13 + z1);
+                    p[6 * stride] = static_cast<i16>(tmp13 - z1);
+
+                    const i32 o10 = tmp4 + tmp5;
+                    const i32 o11 = tmp5 + tmp6;
+                    const i32 o12 = tmp6 + tmp7;
+
+                    const i32 z5 = ((o10 - o12) * FIX_0_382683433) >> 8;
+                    const i32 z2 = ((o10 * FIX_0_541196100) >> 8) + z5;
+                    const i32 z4 = ((o12 * FIX_1_306562965) >> 8) + z5;
+                    const i32 z3 = (o11 * FIX_0_707106781) >> 8;
+
+                    const i32 z11 = tmp7 + z3;
+                    const i32 z13 = tmp7 - z3;
+
+                    p[5 * stride] = static_cast<i16>(z13 + z2);
+                    p[3 * stride] = static_cast<i16>(z13 - z2);
+                    p[stride] = static_cast<i16>(z11 + z4);
+                    p[7 * stride] = static_cast<i16>(z11 - z4);
+                }
+            };
+
+            pass(block, 1, 8); // Rows
+            pass(block, 8, 1); // Columns
+        }
+
+        void quantize(const i16 *block, const f32 *scale, i16 *out) noexcept
+        {
+            for (int i = 0; i < 64; ++i)
+            {
+                out[i] = static_cast<i16>(std::lrintf(block[i] * scale[i]));
+            }
+        }
+
+#endif
+
+#if !VRS_JPEG_AVX2
+        VRS_FORCEINLINE u64 nonzero_mask(const i16 *coefs) noexcept
+        {
+            u64 mask = 0;
+            for (int n = 0; n < 64; ++n)
+                mask |= static_cast<u64>(coefs[n] != 0) << n;
+            return mask;
+        }
+
+        /**
+         * DCT and quantise two blocks, leaving natural-order coefficients in qa/qb
+         * and their nonzero bitmaps (bit n set when coefficient n != 0) in ma/mb.
+         */
+        VRS_FORCEINLINE void transform_pair(
+            const i16 *a, size_t a_stride,
+            const i16 *b, size_t b_stride,
+            const f32 *scale,
+            i16 *qa, i16 *qb,
+            u64 &ma, u64 &mb) noexcept
+        {
+            alignas(32) i16 block[64];
+            for (int row = 0; row < 8; ++row)
+                std::memcpy(block + row * 8, a + row * a_stride, 8 * sizeof(i16));
+            fdct_8x8(block);
+            quantize(block, scale, qa);
+            ma = nonzero_mask(qa);
+
+            for (int row = 0; row < 8; ++row)
+                std::memcpy(block + row * 8, b + row * b_stride, 8 * sizeof(i16));
+            fdct_8x8(block);
+            quantize(block, scale, qb);
+            mb = nonzero_mask(qb);
+        }
+#endif
+
+        /**
+         * Entropy-code one quantised block.
+         * Only the nonzero coefficients are moved to zig-zag positions, so
+         * sparse blocks (the common case) cost a handful of operations.
+         */
+        VRS_FORCEINLINE void code_block(
+            BitWriter &writer,
+            const i16 *coefs, u64 natural_mask,
+            i16 &last_dc,
+            const HuffmanCodes &dc, const HuffmanCodes &ac)
+        {
+            u64 nonzero = 0;
+            while (natural_mask)
+            {
+                nonzero |= u64{1} << ZIGZAG_INDEX[std::countr_zero(natural_mask)];
+                natural_mask &= natural_mask - 1;
+            }
+
+            encode_block(writer, coefs, nonzero, last_dc, dc, ac);
+        }
+
+        // Fixed-point BT.601 full-range (JFIF) coefficients, 16 fractional bits
+        constexpr i32 Y_R = 19595;
+        constexpr i32 Y_G = 38470;
+        constexpr i32 Y_B = 7471;
+        constexpr i32 CB_R = -11059;
+        constexpr i32 CB_G = -21709;
+        constexpr i32 CB_B = 32768;
+        constexpr i32 CR_R = 32768;
+        constexpr i32 CR_G = -27439;
+        constexpr i32 CR_B = -5329;
+
+        /**
+         * Scalar colour conversion of pixel pairs [x_begin, x_end) (in 2-pixel units)
+         * of a row pair, clamping source x to the image width.
+         */
+        void convert_pairs_scalar(
+            const u8 *row0, const u8 *row1,
+            u32 x_begin, u32 x_end,
+            u32 width, u32 channels,
+            i16 *y0, i16 *y1, i16 *cb, i16 *cr)
+        {
+            for (u32 pair = x_begin; pair < x_end; ++pair)
+            {
+                i32 r_sum = 0;
+                i32 g_sum = 0;
+                i32 b_sum = 0;
+
+                for (u32 i = 0; i < 2; ++i)
+                {
+                    const u32 x = std::min(pair * 2 + i, width - 1);
+                    const u8 *p0 = row0 + x * channels;
+                    const u8 *p1 = row1 + x * channels;
+
+                    y0[pair * 2 + i] = static_cast<i16>(((Y_R * p0[2] + Y_G * p0[1] + Y_B * p0[0] + 32768) >> 16) - 128);
+                    y1[pair * 2 + i] = static_cast<i16>(((Y_R * p1[2] + Y_G * p1[1] + Y_B * p1[0] + 32768) >> 16) - 128);
+
+                    r_sum += p0[2] + p1[2];
+                    g_sum += p0[1] + p1[1];
+                    b_sum += p0[0] + p1[0];
+                }
+
+                // Sums of four pixels: one more 2 bits of shift; level shift cancels the +128 offset
+                cb[pair] = static_cast<i16>((CB_R * r_sum + CB_G * g_sum + CB_B * b_sum + (1 << 17)) >> 18);
+                cr[pair] = static_cast<i16>((CR_R * r_sum + CR_G * g_sum + CR_B * b_sum + (1 << 17)) >> 18);
+            }
+        }
+
+#if VRS_JPEG_AVX2
+
+        /**
+         * Load 8 BGR or BGRA pixels as BGRX in 32-bit lanes.
+         */
+        VRS_FORCEINLINE __m256i load_pixels(const u8 *p, u32 channels) noexcept
+        {
+            if (channels == 4)
+            {
+                return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            }
+
+            // Pixels 0-3 from p, 4-7 from p + 12; spread 3 bytes into 4 per lane
+            const __m256i raw = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 12)), 1);
+            const __m256i spread = _mm256_setr_epi8(
+                0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            return _mm256_shuffle_epi8(raw, spread);
+        }
+
+        struct Channels
+        {
+            __m256i r;
+            __m256i g;
+            __m256i b;
+        };
+
+        VRS_FORCEINLINE Channels split(__m256i pixels) noexcept
+        {
+            const __m256i mask = _mm256_set1_epi32(0xFF);
+            return {_mm256_and_si256(_mm256_srli_epi32(pixels, 16), mask),
+                    _mm256_and_si256(_mm256_srli_epi32(pixels, 8), mask),
+                    _mm256_and_si256(pixels, mask)};
+        }
+
+        VRS_FORCEINLINE __m256i luma(const Channels &c) noexcept
+        {
+            const __m256i sum = _mm256_add_epi32(
+                _mm256_add_epi32(_mm256_mullo_epi32(c.r, _mm256_set1_epi32(Y_R)),
+                                 _mm256_mullo_epi32(c.g, _mm256_set1_epi32(Y_G))),
+                _mm256_add_epi32(_mm256_mullo_epi32(c.b, _mm256_set1_epi32(Y_B)),
+                                 _mm256_set1_epi32(32768)));
+            return _mm256_sub_epi32(_mm256_srai_epi32(sum, 16), _mm256_set1_epi32(128));
+        }
+
+        /**
+         * Pack two vectors of eight 32-bit values into 16 consecutive i16.
+         */
+        VRS_FORCEINLINE __m256i pack16(__m256i a, __m256i b) noexcept
+        {
+            return _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        }
+
+        /**
+         * Add horizontal pixel pairs of a (pixels 0-7) and b (pixels 8-15).
+         */
+        VRS_FORCEINLINE __m256i pair_sums(__m256i a, __m256i b) noexcept
+        {
+            return _mm256_permute4x64_epi64(_mm256_hadd_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        }
+
+        /**
+         * Convert 16 pixels of a row pair.
+         */
+        VRS_FORCEINLINE void convert16_avx2(
+            const u8 *row0, const u8 *row1, u32 channels,
+            i16 *y0, i16 *y1, i16 *cb, i16 *cr) noexcept
+        {
+            const Channels a0 = split(load_pixels(row0, channels));
+            const Channels b0 = split(load_pixels(row0 + 8 * channels, channels));
+            const Channels a1 = split(load_pixels(row1, channels));
+            const Channels b1 = split(load_pixels(row1 + 8 * channels, channels));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(y0), pack16(luma(a0), luma(b0)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(y1), pack16(luma(a1), luma(b1)));
+
+            const __m256i r = pair_sums(_mm256_add_epi32(a0.r, a1.r), _mm256_add_epi32(b0.r, b1.r));
+            const __m256i g = pair_sums(_mm256_add_epi32(a0.g, a1.g), _mm256_add_epi32(b0.g, b1.g));
+            const __m256i b = pair_sums(_mm256_add_epi32(a0.b, a1.b), _mm256_add_epi32(b0.b, b1.b));
+            const __m256i round = _mm256_set1_epi32(1 << 17);
+
+            const __m256i cb32 = _mm256_srai_epi32(
+                _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(r, _mm256_set1_epi32(CB_R)),
+                                                  _mm256_mullo_epi32(g, _mm256_set1_epi32(CB_G))),
+                                 _mm256_add_epi32(_mm256_slli_epi32(b, 15), round)),
+                18);
+            const __m256i cr32 = _mm256_srai_epi32(
+                _mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(r, 15),
+                                                  _mm256_mullo_epi32(g, _mm256_set1_epi32(CR_G))),
+                                 _mm256_add_epi32(_mm256_mullo_epi32(b, _mm256_set1_epi32(CR_B)), round)),
+                18);
+
+            const __m256i chroma = pack16(cb32, cr32);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(cb), _mm256_castsi256_si128(chroma));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(cr), _mm256_extracti128_si256(chroma, 1));
+        }
+
+#elif VRS_JPEG_NEON
+
+        VRS_FORCEINLINE int16x8_t luma8(uint16x8_t r, uint16x8_t g, uint16x8_t b) noexcept
+        {
+            uint32x4_t lo = vmull_n_u16(vget_low_u16(r), Y_R);
+            lo = vmlal_n_u16(lo, vget_low_u16(g), Y_G);
+            lo = vmlal_n_u16(lo, vget_low_u16(b), Y_B);
+            uint32x4_t hi = vmull_n_u16(vget_high_u16(r), Y_R);
+            hi = vmlal_n_u16(hi, vget_high_u16(g), Y_G);
+            hi = vmlal_n_u16(hi, vget_high_u16(b), Y_B);
+            const uint16x8_t y = vcombine_u16(vrshrn_n_u32(lo, 16), vrshrn_n_u32(hi, 16));
+            return vsubq_s16(vreinterpretq_s16_u16(y), vdupq_n_s16(128));
+        }
+
+        VRS_FORCEINLINE int16x4_t chroma4(int16x4_t r, int16x4_t g, int16x4_t b,
+                                          i16 kr, i16 kg, i16 kb, bool r_is_half) noexcept
+        {
+            int32x4_t sum = vdupq_n_s32(1 << 17);
+            if (r_is_half)
+            {
+                sum = vaddq_s32(sum, vshll_n_s16(r, 15));
+                sum = vmlal_n_s16(sum, g, kg);
+                sum = vmlal_n_s16(sum, b, kb);
+            }
+            else
+            {
+                sum = vmlal_n_s16(sum, r, kr);
+                sum = vmlal_n_s16(sum, g, kg);
+                sum = vaddq_s32(sum, vshll_n_s16(b, 15));
+            }
+            return vmovn_s32(vshrq_n_s32(sum, 18));
+        }
+
+        /**
+         * Convert 16 pixels of a row pair.
+         */
+        VRS_FORCEINLINE void convert16_neon(
+            const u8 *row0, const u8 *row1, u32 channels,
+            i16 *y0, i16 *y1, i16 *cb, i16 *cr) noexcept
+        {
+            uint8x16_t b0, g0, r0, b1, g1, r1;
+            if (channels == 4)
+            {
+                const uint8x16x4_t p0 = vld4q_u8(row0);
+                const uint8x16x4_t p1 = vld4q_u8(row1);
+                b0 = p0.val[0], g0 = p0.val[1], r0 = p0.val[2];
+                b1 = p1.val[0], g1 = p1.val[1], r1 = p1.val[2];
+            }
+            else
+            {
+                const uint8x16x3_t p0 = vld3q_u8(row0);
+                const uint8x16x3_t p1 = vld3q_u8(row1);
+                b0 = p0.val[0], g0 = p0.val[1], r0 = p0.val[2];
+                b1 = p1.val[0], g1 = p1.val[1], r1 = p1.val[2];
+            }
+
+            vst1q_s16(y0, luma8(vmovl_u8(vget_low_u8(r0)), vmovl_u8(vget_low_u8(g0)), vmovl_u8(vget_low_u8(b0))));
+            vst1q_s16(y0 + 8, luma8(vmovl_u8(vget_high_u8(r0)), vmovl_u8(vget_high_u8(g0)), vmovl_u8(vget_high_u8(b0))));
+            vst1q_s16(y1, luma8(vmovl_u8(vget_low_u8(r1)), vmovl_u8(vget_low_u8(g1)), vmovl_u8(vget_low_u8(b1))));
+            vst1q_s16(y1 + 8, luma8(vmovl_u8(vget_high_u8(r1)), vmovl_u8(vget_high_u8(g1)), vmovl_u8(vget_high_u8(b1))));
+
+            // 2x2 sums: pairwise add within each row, then add the rows
+            const int16x8_t r = vreinterpretq_s16_u16(vaddq_u16(vpaddlq_u8(r0), vpaddlq_u8(r1)));
+            const int16x8_t g = vreinterpretq_s16_u16(vaddq_u16(vpaddlq_u8(g0), vpaddlq_u8(g1)));
+            const int16x8_t b = vreinterpretq_s16_u16(vaddq_u16(vpaddlq_u8(b0), vpaddlq_u8(b1)));
+
+            vst1q_s16(cb, vcombine_s16(
+                              chroma4(vget_low_s16(r), vget_low_s16(g), vget_low_s16(b), CB_R, CB_G, 0, false),
+                              chroma4(vget_high_s16(r), vget_high_s16(g), vget_high_s16(b), CB_R, CB_G, 0, false)));
+            vst1q_s16(cr, vcombine_s16(
+                              chroma4(vget_low_s16(r), vget_low_s16(g), vget_low_s16(b), 0, CR_G, CR_B, true),
+                              chroma4(vget_high_s16(r), vget_high_s16(g), vget_high_s16(b), 0, CR_G, CR_B, true)));
+        }
+
+#endif
+
+        void write_marker(std::vector<u8> &out, u8 marker, u16 length)
+        {
+            out.push_back(0xFF);
+            out.push_back(marker);
+            out.push_back(static_cast<u8>(length >> 8));
+            out.push_back(static_cast<u8>(length));
+        }
+
+        void write_huffman_table(std::vector<u8> &out, u8 id, const u8 *bits, const u8 *values, size_t count)
+        {
+            out.push_back(id);
+            out.insert(out.end(), bits, bits + 16);
+            out.insert(out.end(), values, values + count);
+        }
+    } // namespace
+
+    SimdJPEGEncoder::SimdJPEGEncoder()
+    {
+        VRS_LOG_INFO(std::format("Built-in JPEG encoder initialized ({})", simd_path()));
+    }
+
+    SimdJPEGEncoder::~SimdJPEGEncoder() = default;
+
+    std::string_view SimdJPEGEncoder::simd_path() noexcept
+    {
+#if VRS_JPEG_AVX2
+        return "AVX2";
+#elif VRS_JPEG_NEON
+        return "NEON";
+#else
+        return "scalar";
+#endif
+    }
+
+    void SimdJPEGEncoder::set_quality(u32 quality)
+    {
+        quality = std::clamp(quality, 1u, 100u);
+        if (quality == quality_)
+            return;
+        quality_ = quality;
+
+        // IJG quality scaling, clamped to baseline (8-bit) tables
+        const u32 scale = (quality < 50) ? 5000 / quality : 200 - quality * 2;
+        for (int i = 0; i < 64; ++i)
+        {
+            luma_quant_[i] = static_cast<u8>(std::clamp<u32>((LUMA_QUANT[i] * scale + 50) / 100, 1, 255));
+            chroma_quant_[i] = static_cast<u8>(std::clamp<u32>((CHROMA_QUANT[i] * scale + 50) / 100, 1, 255));
+
+            // The AAN DCT leaves every coefficient scaled by 8 * aan[row] * aan[col]
+            const f64 aan = 8.0 * AAN_SCALE[i / 8] * AAN_SCALE[i % 8];
+            luma_scale_[i] = static_cast<f32>(1.0 / (luma_quant_[i] * aan));
+            chroma_scale_[i] = static_cast<f32>(1.0 / (chroma_quant_[i] * aan));
+        }
+
+        // SOI .. SOS only depend on quality (dimensions are patched per frame)
+        header_.assign({0xFF, 0xD8});
+
+        static constexpr u8 JFIF[] = {'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0};
+        write_marker(header_, 0xE0, 2 + sizeof(JFIF));
+        header_.insert(header_.end(), std::begin(JFIF), std::end(JFIF));
+
+        write_marker(header_, 0xDB, 2 + 2 * 65);
+        header_.push_back(0x00);
+        for (int k = 0; k < 64; ++k)
+            header_.push_back(luma_quant_[NATURAL_ORDER[k]]);
+        header_.push_back(0x01);
+        for (int k = 0; k < 64; ++k)
+            header_.push_back(chroma_quant_[NATURAL_ORDER[k]]);
+
+        // SOF0: height/width at offsets +5..+8, patched in encode()
+        write_marker(header_, 0xC0, 17);
+        header_.insert(header_.end(), {8, 0, 0, 0, 0, 3,
+                                       1, 0x22, 0,
+                                       2, 0x11, 1,
+                                       3, 0x11, 1});
+
+        write_marker(header_, 0xC4, 2 + 4 * 17 + 12 + 12 + 162 + 162);
+        write_huffman_table(header_, 0x00, DC_LUMA_BITS, DC_VALUES, 12);
+        write_huffman_table(header_, 0x10, AC_LUMA_BITS, AC_LUMA_VALUES, 162);
+        write_huffman_table(header_, 0x01, DC_CHROMA_BITS, DC_VALUES, 12);
+        write_huffman_table(header_, 0x11, AC_CHROMA_BITS, AC_CHROMA_VALUES, 162);
+
+        write_marker(header_, 0xDA, 12);
+        header_.insert(header_.end(), {3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0});
+    }
+
+    void SimdJPEGEncoder::set_roi(u32 regions, f32 inner_radius, f32 outer_radius, u32 max_step) noexcept
+    {
+        roi_regions_ = regions;
+        roi_inner_ = std::max(inner_radius, 0.0f);
+        roi_outer_ = std::max(outer_radius, roi_inner_ + 0.01f);
+        roi_max_step_ = std::clamp(max_step, 1u, MAX_ROI_STEP);
+    }
+
+    void SimdJPEGEncoder::convert_band(const u8 *const *rows, u32 width, u32 channels)
+    {
+        const u32 pairs = padded_width_ / 2;
+        const size_t chroma_stride = pairs;
+
+        for (u32 row = 0; row < MCU_SIZE; row += 2)
+        {
+            const u8 *row0 = rows[row];
+            const u8 *row1 = rows[row + 1];
+            i16 *y0 = y_band_.data() + static_cast<size_t>(row) * padded_width_;
+            i16 *y1 = y0 + padded_width_;
+            i16 *cb = cb_band_.data() + (row / 2) * chroma_stride;
+            i16 *cr = cr_band_.data() + (row / 2) * chroma_stride;
+
+            u32 x = 0;
+#if VRS_JPEG_AVX2
+            // The BGR loader reads 4 bytes past the last pixel it uses
+            const u32 simd_limit = (channels == 4) ? width : (width >= 2 ? width - 2 : 0);
+            for (; x + 16 <= simd_limit; x += 16)
+            {
+                convert16_avx2(row0 + x * channels, row1 + x * channels, channels,
+                               y0 + x, y1 + x, cb + x / 2, cr + x / 2);
+            }
+#elif VRS_JPEG_NEON
+            for (; x + 16 <= width; x += 16)
+            {
+                convert16_neon(row0 + x * channels, row1 + x * channels, channels,
+                               y0 + x, y1 + x, cb + x / 2, cr + x / 2);
+            }
+#endif
+            // Tail and right-edge padding (replicates the last column)
+            convert_pairs_scalar(row0, row1, x / 2, pairs, width, channels, y0, y1, cb, cr);
+        }
+    }
+
+    size_t SimdJPEGEncoder::encode(
+        const u8 *input,
+        u32 width, u32 height,
+        u32 pitch, u32 channels,
+        u32 quality,
+        CompressedFrame &output)
+    {
+        if (!input || width == 0 || height == 0 || width > 65535 || height > 65535 ||
+            (channels != 3 && channels != 4))
+        {
+            output.clear();
+            return 0;
+        }
+
+        Timer timer;
+        set_quality(quality);
+
+        const u32 mcus_per_row = (width + MCU_SIZE - 1) / MCU_SIZE;
+        const u32 mcu_rows = (height + MCU_SIZE - 1) / MCU_SIZE;
+        padded_width_ = mcus_per_row * MCU_SIZE;
+
+        const size_t y_size = static_cast<size_t>(padded_width_) * MCU_SIZE;
+        if (y_band_.size() < y_size)
+        {
+            y_band_.resize(y_size);
+            cb_band_.resize(y_size / 4);
+            cr_band_.resize(y_size / 4);
+        }
+
+        // Same bound as tjBufSize() for 4:2:0; grown per MCU row if content is pathological
+        output.reserve(header_.size() + static_cast<size_t>(padded_width_) * mcu_rows * MCU_SIZE * 3 + 2048);
+
+        u8 *out = output.ptr();
+        std::memcpy(out, header_.data(), header_.size());
+
+        // Patch the SOF0 dimensions (header_ is SOI, APP0, DQT, SOF0, ...)
+        const size_t sof = 2 + (2 + 16) + (2 + 2 + 130);
+        out[sof + 5] = static_cast<u8>(height >> 8);
+        out[sof + 6] = static_cast<u8>(height);
+        out[sof + 7] = static_cast<u8>(width >> 8);
+        out[sof + 8] = static_cast<u8>(width);
+
+        BitWriter writer(out + header_.size());
+        i16 last_dc[3] = {0, 0, 0};
+
+        const HuffmanCodes &dc_luma = dc_luma_codes();
+        const HuffmanCodes &ac_luma = ac_luma_codes();
+        const HuffmanCodes &dc_chroma = dc_chroma_codes();
+        const HuffmanCodes &ac_chroma = ac_chroma_codes();
+
+        const size_t chroma_stride = padded_width_ / 2;
+        const u8 *rows[MCU_SIZE];
+        alignas(32) i16 coefs[6][64]; // Y00, Y01, Y10, Y11, Cb, Cr
+        u64 masks[6];
+
+        const bool roi = roi_regions_ > 0 && roi_max_step_ > 1;
+        if (roi)
+        {
+            // Step k divides the AC reciprocals by k; DC is left alone
+            for (u32 k = 1; k <= roi_max_step_; ++k)
+            {
+                for (int i = 0; i < 64; ++i)
+                {
+                    roi_luma_scale_[k - 1][i] = (i == 0) ? luma_scale_[i] : luma_scale_[i] / k;
+                    roi_chroma_scale_[k - 1][i] = (i == 0) ? chroma_scale_[i] : chroma_scale_[i] / k;
+                }
+            }
+
+            const f32 region_width = static_cast<f32>(width) / roi_regions_;
+            roi_dx2_.resize(mcus_per_row);
+            for (u32 mcu = 0; mcu < mcus_per_row; ++mcu)
+            {
+                const f32 x = std::min(mcu * MCU_SIZE + MCU_SIZE / 2.0f, static_cast<f32>(width - 1));
+                const f32 region = std::min(std::floor(x / region_width), static_cast<f32>(roi_regions_ - 1));
+                const f32 dx = (x - (region + 0.5f) * region_width) / (region_width / 2);
+                roi_dx2_[mcu] = dx * dx;
+            }
+        }
+
+        for (u32 mcu_row = 0; mcu_row < mcu_rows; ++mcu_row)
+        {
+            // Keep room for a worst-case MCU row; growing copies what is written so far
+            const size_t used = static_cast<size_t>(writer.position() - output.ptr());
+            const size_t needed = used + mcus_per_row * MAX_MCU_BYTES + 16;
+            if (needed > output.capacity)
+            {
+                auto grown = make_aligned_array<u8>(needed * 2, CACHE_LINE_SIZE);
+                std::memcpy(grown.get(), output.ptr(), used);
+                output.data = std::move(grown);
+                output.capacity = needed * 2;
+                writer.rebase(output.ptr() + used);
+            }
+
+            // Bottom edge replicates the last row
+            for (u32 i = 0; i < MCU_SIZE; ++i)
+            {
+                const u32 y = std::min(mcu_row * MCU_SIZE + i, height - 1);
+                rows[i] = input + static_cast<size_t>(y) * pitch;
+            }
+            convert_band(rows, width, channels);
+
+            f32 dy2 = 0;
+            if (roi)
+            {
+                const f32 y = std::min(mcu_row * MCU_SIZE + MCU_SIZE / 2.0f, static_cast<f32>(height - 1));
+                const f32 dy = (y - height / 2.0f) / (height / 2.0f);
+                dy2 = dy * dy;
+            }
+
+            for (u32 mcu = 0; mcu < mcus_per_row; ++mcu)
+            {
+                u32 step = 1;
+                if (roi)
+                {
+                    const f32 t = (std::sqrt(roi_dx2_[mcu] + dy2) - roi_inner_) / (roi_outer_ - roi_inner_);
+                    step = 1 + static_cast<u32>(std::lround(std::clamp(t, 0.0f, 1.0f) * (roi_max_step_ - 1)));
+                }
+                const f32 *luma_scale = (step > 1) ? roi_luma_scale_[step - 1].data() : luma_scale_.data();
+                const f32 *chroma_scale = (step > 1) ? roi_chroma_scale_[step - 1].data() : chroma_scale_.data();
+
+                const i16 *y = y_band_.data() + mcu * MCU_SIZE;
+                transform_pair(y, padded_width_, y + 8, padded_width_,
+                               luma_scale, coefs[0], coefs[1], masks[0], masks[1]);
+                transform_pair(y + 8 * padded_width_, padded_width_, y + 8 * padded_width_ + 8, padded_width_,
+                               luma_scale, coefs[2], coefs[3], masks[2], masks[3]);
+                transform_pair(cb_band_.data() + mcu * 8, chroma_stride, cr_band_.data() + mcu * 8, chroma_stride,
+                               chroma_scale, coefs[4], coefs[5], masks[4], masks[5]);
+
+                if (step > 1)
+                {
+                    // Back to multiples of the table step; zeros (and so the masks) are unchanged
+                    for (auto &block : coefs)
+                    {
+                        for (int i = 1; i < 64; ++i)
+                            block[i] = static_cast<i16>(block[i] * static_cast<i32>(step));
+                    }
+                }
+
+                for (int block = 0; block < 4; ++block)
+                    code_block(writer, coefs[block], masks[block], last_dc[0], dc_luma, ac_luma);
+                code_block(writer, coefs[4], masks[4], last_dc[1], dc_chroma, ac_chroma);
+                code_block(writer, coefs[5], masks[5], last_dc[2], dc_chroma, ac_chroma);
+            }
+        }
+
+        writer.flush();
+        u8 *end = writer.position();
+        *end++ = 0xFF;
+        *end++ = 0xD9; // EOI
+
+        output.length = static_cast<size_t>(end - output.ptr());
+        last_encode_time_ = timer.elapsed_ms();
+        return output.length;
+    }
+
+} // namespace vrs
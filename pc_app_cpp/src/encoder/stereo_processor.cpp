@@ -5,6 +5,10 @@
 
 #include "encoder/stereo_processor.hpp"
 #include "encoder/jpeg_encoder.hpp"
+#include "encoder/parallel_jpeg_encoder.hpp"
+#include "encoder/raw_encoder.hpp"
+#include "encoder/h264_encoder.hpp"
+#include <cmath>
 
 #if VRS_HAS_AVX2
 #include <immintrin.h>
@@ -40,57 +44,83 @@ namespace vrs
         f32 downscale_factor,
         f32 eye_separation)
     {
-        Timer timer;
+        prepare_sbs(input_width, input_height, input_pitch, input_channels,
+                    output_width, output_height, eye_separation);
+        return sample(input, output);
+    }
 
-        const u32 half_width = output_width / 2;
-        const u32 output_pitch = output_width * 3; // Output is always BGR
+    u32 CPUStereoProcessor::prepare_sbs(
+        u32 input_width, u32 input_height,
+        u32 input_pitch, u32 input_channels,
+        u32 output_width, u32 output_height,
+        f32 eye_separation)
+    {
         const u32 separation_pixels = static_cast<u32>(input_width * eye_separation);
+        return static_cast<u32>(sampling_plan(
+                                    input_width, input_height, input_pitch, input_channels,
+                                    output_width, output_height, separation_pixels, false)
+                                    .columns.size());
+    }
 
-        // Calculate scaled dimensions
-        const u32 scaled_height = output_height;
-        const f32 x_scale = static_cast<f32>(input_width) / half_width;
-        const f32 y_scale = static_cast<f32>(input_height) / scaled_height;
+    u32 CPUStereoProcessor::prepare_view(
+        u32 input_width, u32 input_height,
+        u32 input_pitch, u32 input_channels,
+        u32 eye_width, u32 output_height,
+        u32 disparity)
+    {
+        return static_cast<u32>(sampling_plan(
+                                    input_width, input_height, input_pitch, input_channels,
+                                    eye_width, output_height, disparity, true)
+                                    .columns.size());
+    }
 
-// Process each row
-#pragma omp parallel for schedule(dynamic, 16)
-        for (i32 y = 0; y < static_cast<i32>(output_height); ++y)
+    void CPUStereoProcessor::sample_rows(const u8 *input, u32 first_row, u32 rows, u8 *output, u32 output_pitch) const
+    {
+        const u32 *columns = plan_.columns.data();
+        const u32 column_count = static_cast<u32>(plan_.columns.size());
+
+        for (u32 y = 0; y < rows; ++y)
         {
-            const u32 src_y = static_cast<u32>(y * y_scale);
-            const u8 *src_row = input + src_y * input_pitch;
-            u8 *dst_row = output + y * output_pitch;
+            const u8 *src_row = input + plan_.rows[first_row + y];
+            u8 *dst_pixel = output + static_cast<size_t>(y) * output_pitch;
 
-            // Left eye (original or shifted right)
-            for (u32 x = 0; x < half_width; ++x)
+            // Both eyes in one pass; the plan already holds the per-eye shift
+            for (u32 x = 0; x < column_count; ++x, dst_pixel += 3)
             {
-                u32 src_x = static_cast<u32>(x * x_scale);
-                // For left eye, sample from left part of image
-                if (src_x + separation_pixels < input_width)
-                {
-                    src_x = std::min(src_x, input_width - separation_pixels - 1);
-                }
-
-                const u8 *src_pixel = src_row + src_x * input_channels;
-                u8 *dst_pixel = dst_row + x * 3;
-
+                const u8 *src_pixel = src_row + columns[x];
                 dst_pixel[0] = src_pixel[0]; // B
                 dst_pixel[1] = src_pixel[1]; // G
                 dst_pixel[2] = src_pixel[2]; // R
             }
+        }
+    }
 
-            // Right eye (original or shifted left)
-            for (u32 x = 0; x < half_width; ++x)
-            {
-                u32 src_x = static_cast<u32>(x * x_scale) + separation_pixels;
-                src_x = std::min(src_x, input_width - 1);
+    u32 CPUStereoProcessor::process_view(
+        const u8 *input,
+        u32 input_width, u32 input_height,
+        u32 input_pitch, u32 input_channels,
+        u8 *output,
+        u32 eye_width, u32 output_height,
+        u32 disparity)
+    {
+        prepare_view(input_width, input_height, input_pitch, input_channels,
+                     eye_width, output_height, disparity);
+        return sample(input, output);
+    }
 
-                const u8 *src_pixel = src_row + src_x * input_channels;
-                u8 *dst_pixel = dst_row + (half_width + x) * 3;
+    u32 CPUStereoProcessor::sample(const u8 *input, u8 *output)
+    {
+        Timer timer;
 
-                dst_pixel[0] = src_pixel[0]; // B
-                dst_pixel[1] = src_pixel[1]; // G
-                dst_pixel[2] = src_pixel[2]; // R
-            }
-        }
+        const u32 column_count = static_cast<u32>(plan_.columns.size());
+        const u32 output_pitch = (plan_.single_view ? column_count : plan_.output_width) * 3; // Output is always BGR
+
+        // Bands of 16 rows across the shared pool
+        auto sample_band = [&](u32 first, u32 last)
+        {
+            sample_rows(input, first, last - first, output + static_cast<size_t>(first) * output_pitch, output_pitch);
+        };
+        get_global_thread_pool().parallel_for(0, plan_.output_height, 16, sample_band);
 
         stats_.frames_processed++;
         stats_.last_process_time_ms = timer.elapsed_ms();
@@ -101,6 +131,69 @@ namespace vrs
         return output_pitch;
     }
 
+    const CPUStereoProcessor::SamplingPlan &CPUStereoProcessor::sampling_plan(
+        u32 input_width, u32 input_height,
+        u32 input_pitch, u32 input_channels,
+        u32 output_width, u32 output_height,
+        u32 separation, bool single_view)
+    {
+        if (plan_.input_width == input_width && plan_.input_height == input_height &&
+            plan_.input_pitch == input_pitch && plan_.input_channels == input_channels &&
+            plan_.output_width == output_width && plan_.output_height == output_height &&
+            plan_.separation == separation && plan_.single_view == single_view)
+        {
+            return plan_;
+        }
+
+        const u32 half_width = single_view ? output_width : output_width / 2;
+        const f32 x_scale = static_cast<f32>(input_width) / half_width;
+        const f32 y_scale = static_cast<f32>(input_height) / output_height;
+
+        if (single_view)
+        {
+            // Left eye columns carried on past the eye's edge; the right eye starts separation in
+            plan_.columns.resize(half_width + separation);
+            for (u32 x = 0; x < half_width + separation; ++x)
+            {
+                plan_.columns[x] = std::min(static_cast<u32>(x * x_scale), input_width - 1) * input_channels;
+            }
+        }
+        else
+        {
+            plan_.columns.resize(half_width * 2);
+            for (u32 x = 0; x < half_width; ++x)
+            {
+                // Left eye samples from the left part of the image, right eye shifted by the separation
+                u32 left_x = static_cast<u32>(x * x_scale);
+                if (left_x + separation < input_width)
+                {
+                    left_x = std::min(left_x, input_width - separation - 1);
+                }
+                const u32 right_x = std::min(static_cast<u32>(x * x_scale) + separation, input_width - 1);
+
+                plan_.columns[x] = left_x * input_channels;
+                plan_.columns[half_width + x] = right_x * input_channels;
+            }
+        }
+
+        plan_.rows.resize(output_height);
+        for (u32 y = 0; y < output_height; ++y)
+        {
+            plan_.rows[y] = static_cast<u32>(y * y_scale) * input_pitch;
+        }
+
+        plan_.input_width = input_width;
+        plan_.input_height = input_height;
+        plan_.input_pitch = input_pitch;
+        plan_.input_channels = input_channels;
+        plan_.output_width = output_width;
+        plan_.output_height = output_height;
+        plan_.separation = separation;
+        plan_.single_view = single_view;
+        stats_.plan_rebuilds++;
+        return plan_;
+    }
+
     void CPUStereoProcessor::resize_nearest_simd(
         const u8 *src, u32 src_width, u32 src_height, u32 src_pitch,
         u8 *dst, u32 dst_width, u32 dst_height, u32 dst_pitch,
@@ -113,70 +206,76 @@ namespace vrs
         // AVX2 optimized path for 3-channel images
         if (channels == 3 && dst_width >= 32)
         {
-#pragma omp parallel for schedule(dynamic, 8)
-            for (i32 y = 0; y < static_cast<i32>(dst_height); ++y)
+            auto resize_rows = [&](u32 first, u32 last)
             {
-                const u32 src_y = static_cast<u32>(y * y_scale);
-                const u8 *src_row = src + src_y * src_pitch;
-                u8 *dst_row = dst + y * dst_pitch;
-
-                // Process 8 pixels at a time using AVX2
-                u32 x = 0;
-                for (; x + 8 <= dst_width; x += 8)
+                for (u32 y = first; y < last; ++y)
                 {
-                    // Calculate source X coordinates
-                    u32 src_x[8];
-                    for (u32 i = 0; i < 8; ++i)
+                    const u32 src_y = static_cast<u32>(y * y_scale);
+                    const u8 *src_row = src + src_y * src_pitch;
+                    u8 *dst_row = dst + y * dst_pitch;
+
+                    // Process 8 pixels at a time using AVX2
+                    u32 x = 0;
+                    for (; x + 8 <= dst_width; x += 8)
                     {
-                        src_x[i] = static_cast<u32>((x + i) * x_scale);
+                        // Calculate source X coordinates
+                        u32 src_x[8];
+                        for (u32 i = 0; i < 8; ++i)
+                        {
+                            src_x[i] = static_cast<u32>((x + i) * x_scale);
+                        }
+
+                        // Gather pixels (can't use gather for 3-byte pixels, do manually)
+                        for (u32 i = 0; i < 8; ++i)
+                        {
+                            const u8 *sp = src_row + src_x[i] * 3;
+                            u8 *dp = dst_row + (x + i) * 3;
+                            dp[0] = sp[0];
+                            dp[1] = sp[1];
+                            dp[2] = sp[2];
+                        }
                     }
 
-                    // Gather pixels (can't use gather for 3-byte pixels, do manually)
-                    for (u32 i = 0; i < 8; ++i)
+                    // Handle remaining pixels
+                    for (; x < dst_width; ++x)
                     {
-                        const u8 *sp = src_row + src_x[i] * 3;
-                        u8 *dp = dst_row + (x + i) * 3;
+                        u32 src_x = static_cast<u32>(x * x_scale);
+                        const u8 *sp = src_row + src_x * 3;
+                        u8 *dp = dst_row + x * 3;
                         dp[0] = sp[0];
                         dp[1] = sp[1];
                         dp[2] = sp[2];
                     }
                 }
-
-                // Handle remaining pixels
-                for (; x < dst_width; ++x)
-                {
-                    u32 src_x = static_cast<u32>(x * x_scale);
-                    const u8 *sp = src_row + src_x * 3;
-                    u8 *dp = dst_row + x * 3;
-                    dp[0] = sp[0];
-                    dp[1] = sp[1];
-                    dp[2] = sp[2];
-                }
-            }
+            };
+            get_global_thread_pool().parallel_for(0, dst_height, 8, resize_rows);
             return;
         }
 #endif
 
-// Scalar fallback
-#pragma omp parallel for schedule(dynamic, 16)
-        for (i32 y = 0; y < static_cast<i32>(dst_height); ++y)
+        // Scalar fallback
+        auto resize_rows = [&](u32 first, u32 last)
         {
-            const u32 src_y = static_cast<u32>(y * y_scale);
-            const u8 *src_row = src + src_y * src_pitch;
-            u8 *dst_row = dst + y * dst_pitch;
-
-            for (u32 x = 0; x < dst_width; ++x)
+            for (u32 y = first; y < last; ++y)
             {
-                u32 src_x = static_cast<u32>(x * x_scale);
-                const u8 *sp = src_row + src_x * channels;
-                u8 *dp = dst_row + x * channels;
+                const u32 src_y = static_cast<u32>(y * y_scale);
+                const u8 *src_row = src + src_y * src_pitch;
+                u8 *dst_row = dst + y * dst_pitch;
 
-                for (u32 c = 0; c < channels; ++c)
+                for (u32 x = 0; x < dst_width; ++x)
                 {
-                    dp[c] = sp[c];
+                    u32 src_x = static_cast<u32>(x * x_scale);
+                    const u8 *sp = src_row + src_x * channels;
+                    u8 *dp = dst_row + x * channels;
+
+                    for (u32 c = 0; c < channels; ++c)
+                    {
+                        dp[c] = sp[c];
+                    }
                 }
             }
-        }
+        };
+        get_global_thread_pool().parallel_for(0, dst_height, 16, resize_rows);
     }
 
     void CPUStereoProcessor::resize_bilinear_simd(
@@ -187,43 +286,46 @@ namespace vrs
         const f32 x_scale = static_cast<f32>(src_width - 1) / (dst_width - 1);
         const f32 y_scale = static_cast<f32>(src_height - 1) / (dst_height - 1);
 
-#pragma omp parallel for schedule(dynamic, 8)
-        for (i32 y = 0; y < static_cast<i32>(dst_height); ++y)
+        auto resize_rows = [&](u32 first, u32 last)
         {
-            const f32 src_y = y * y_scale;
-            const u32 y0 = static_cast<u32>(src_y);
-            const u32 y1 = std::min(y0 + 1, src_height - 1);
-            const f32 y_frac = src_y - y0;
-            const f32 y_frac_inv = 1.0f - y_frac;
-
-            const u8 *src_row0 = src + y0 * src_pitch;
-            const u8 *src_row1 = src + y1 * src_pitch;
-            u8 *dst_row = dst + y * dst_pitch;
-
-            for (u32 x = 0; x < dst_width; ++x)
+            for (u32 y = first; y < last; ++y)
             {
-                const f32 src_x = x * x_scale;
-                const u32 x0 = static_cast<u32>(src_x);
-                const u32 x1 = std::min(x0 + 1, src_width - 1);
-                const f32 x_frac = src_x - x0;
-                const f32 x_frac_inv = 1.0f - x_frac;
-
-                const u8 *p00 = src_row0 + x0 * channels;
-                const u8 *p01 = src_row0 + x1 * channels;
-                const u8 *p10 = src_row1 + x0 * channels;
-                const u8 *p11 = src_row1 + x1 * channels;
-                u8 *dp = dst_row + x * channels;
-
-                for (u32 c = 0; c < channels; ++c)
+                const f32 src_y = y * y_scale;
+                const u32 y0 = static_cast<u32>(src_y);
+                const u32 y1 = std::min(y0 + 1, src_height - 1);
+                const f32 y_frac = src_y - y0;
+                const f32 y_frac_inv = 1.0f - y_frac;
+
+                const u8 *src_row0 = src + y0 * src_pitch;
+                const u8 *src_row1 = src + y1 * src_pitch;
+                u8 *dst_row = dst + y * dst_pitch;
+
+                for (u32 x = 0; x < dst_width; ++x)
                 {
-                    f32 v = p00[c] * x_frac_inv * y_frac_inv +
-                            p01[c] * x_frac * y_frac_inv +
-                            p10[c] * x_frac_inv * y_frac +
-                            p11[c] * x_frac * y_frac;
-                    dp[c] = static_cast<u8>(v + 0.5f);
+                    const f32 src_x = x * x_scale;
+                    const u32 x0 = static_cast<u32>(src_x);
+                    const u32 x1 = std::min(x0 + 1, src_width - 1);
+                    const f32 x_frac = src_x - x0;
+                    const f32 x_frac_inv = 1.0f - x_frac;
+
+                    const u8 *p00 = src_row0 + x0 * channels;
+                    const u8 *p01 = src_row0 + x1 * channels;
+                    const u8 *p10 = src_row1 + x0 * channels;
+                    const u8 *p11 = src_row1 + x1 * channels;
+                    u8 *dp = dst_row + x * channels;
+
+                    for (u32 c = 0; c < channels; ++c)
+                    {
+                        f32 v = p00[c] * x_frac_inv * y_frac_inv +
+                                p01[c] * x_frac * y_frac_inv +
+                                p10[c] * x_frac_inv * y_frac +
+                                p11[c] * x_frac * y_frac;
+                        dp[c] = static_cast<u8>(v + 0.5f);
+                    }
                 }
             }
-        }
+        };
+        get_global_thread_pool().parallel_for(0, dst_height, 8, resize_rows);
     }
 
     // ============================================================================
@@ -343,6 +445,28 @@ namespace vrs
             output, output_width, output_height, downscale_factor, eye_separation);
     }
 
+    u32 AutoStereoProcessor::process_view(
+        const u8 *input,
+        u32 input_width, u32 input_height,
+        u32 input_pitch, u32 input_channels,
+        u8 *output,
+        u32 eye_width, u32 output_height,
+        u32 disparity)
+    {
+        return cpu().process_view(
+            input, input_width, input_height, input_pitch, input_channels,
+            output, eye_width, output_height, disparity);
+    }
+
+    CPUStereoProcessor &AutoStereoProcessor::cpu()
+    {
+        if (!cpu_)
+        {
+            cpu_ = std::make_unique<CPUStereoProcessor>();
+        }
+        return *cpu_;
+    }
+
     std::string_view AutoStereoProcessor::name() const
     {
         if (best_)
@@ -365,7 +489,8 @@ namespace vrs
         : config_(config)
     {
         stereo_processor_ = std::make_unique<AutoStereoProcessor>();
-        jpeg_encoder_ = std::make_unique<AutoJPEGEncoder>();
+        jpeg_encoder_ = std::make_unique<AutoJPEGEncoder>(config.method == EncoderConfig::Method::JPEG);
+        warn_if_h264_unavailable();
 
         // Pre-allocate stereo buffer for typical 1080p
         stereo_buffer_.reserve(1920 * 1080 * 3);
@@ -377,18 +502,21 @@ namespace vrs
         const u8 *input,
         u32 width, u32 height,
         u32 pitch, u32 channels,
-        std::vector<u8> &output)
+        CompressedFrame &output,
+        const FrameControl *control)
     {
         Timer total_timer;
 
+        const f32 downscale = control ? control->downscale : config_.downscale_factor;
+
         // Calculate output dimensions
         u32 output_width = width;
         u32 output_height = height;
 
-        if (config_.downscale_factor < 1.0f)
+        if (downscale < 1.0f)
         {
-            output_width = static_cast<u32>(width * config_.downscale_factor);
-            output_height = static_cast<u32>(height * config_.downscale_factor);
+            output_width = static_cast<u32>(width * downscale);
+            output_height = static_cast<u32>(height * downscale);
         }
 
         if (config_.output_width > 0 && config_.output_height > 0)
@@ -404,8 +532,26 @@ namespace vrs
         const u32 output_pitch = output_width * 3;
         const size_t stereo_size = output_pitch * output_height;
 
+        const bool video = (config_.method == EncoderConfig::Method::H264 && H264Encoder::available());
+
+        // One view for both eyes: whole-frame JPEG output only
+        const bool single_view = config_.output_mode == EncoderConfig::OutputMode::SINGLE_VIEW &&
+                                 config_.method != EncoderConfig::Method::RAW && !video;
+
+        // Same shift as process_scaled() applies, in eye pixels
+        const u32 disparity = single_view ? std::min(static_cast<u32>(std::lround(output_width / 2 * config_.eye_separation)),
+                                                     output_width / 2)
+                                          : 0;
+
+        // Whole-frame JPEG of CPU-sampled stereo: stream rows into the strip encoders
+        const bool fusable = config_.vr_enabled && !config_.roi_enabled &&
+                             (single_view || (config_.output_mode == EncoderConfig::OutputMode::SBS &&
+                                              config_.method != EncoderConfig::Method::RAW && !video &&
+                                              !stereo_processor_->gpu()));
+        ParallelJPEGEncoder *fused = fusable ? fused_encoder() : nullptr;
+
         // Resize stereo buffer if needed
-        if (stereo_buffer_.size() < stereo_size)
+        if (!fused && stereo_buffer_.size() < stereo_size)
         {
             stereo_buffer_.resize(stereo_size);
         }
@@ -418,51 +564,516 @@ namespace vrs
         u32 encode_height = height;
         u32 encode_pitch = pitch;
         u32 encode_channels = channels;
+        CPUStereoProcessor *sampler = nullptr;
 
-        if (config_.vr_enabled)
+        if (fused)
+        {
+            // Geometry only; the strips sample their rows while encoding
+            sampler = &stereo_processor_->cpu();
+            encode_width = single_view ? sampler->prepare_view(width, height, pitch, channels,
+                                                               output_width / 2, output_height, disparity)
+                                       : sampler->prepare_sbs(width, height, pitch, channels,
+                                                              output_width, output_height, config_.eye_separation);
+            encode_height = output_height;
+            encode_pitch = encode_width * 3;
+            encode_channels = 3;
+        }
+        else if (config_.vr_enabled)
         {
-            u32 result_pitch = stereo_processor_->process_scaled(
-                input, width, height, pitch, channels,
-                stereo_buffer_.data(), output_width, output_height,
-                config_.downscale_factor, config_.eye_separation);
+            u32 result_pitch = 0;
+            if (single_view)
+            {
+                result_pitch = stereo_processor_->process_view(
+                    input, width, height, pitch, channels,
+                    stereo_buffer_.data(), output_width / 2, output_height, disparity);
+            }
+            else
+            {
+                result_pitch = stereo_processor_->process_scaled(
+                    input, width, height, pitch, channels,
+                    stereo_buffer_.data(), output_width, output_height,
+                    downscale, config_.eye_separation);
+            }
 
             if (result_pitch > 0)
             {
                 encode_input = stereo_buffer_.data();
-                encode_width = output_width;
+                encode_width = single_view ? result_pitch / 3 : output_width;
                 encode_height = output_height;
-                encode_pitch = output_pitch;
+                encode_pitch = single_view ? result_pitch : output_pitch;
                 encode_channels = 3;
             }
         }
 
         stats_.stereo_time_ms = stereo_timer.elapsed_ms();
 
-        // Encode to JPEG
         Timer encode_timer;
 
-        size_t encoded_size = jpeg_encoder_->encode(
-            encode_input,
-            encode_width, encode_height,
-            encode_pitch, encode_channels,
-            config_.jpeg_quality,
-            output);
+        const bool stereo = fused || encode_input == stereo_buffer_.data();
+        size_t encoded_size = 0;
+
+        // Rate control drives whole-frame JPEGs only; tiles, video and RAW size themselves
+        const u32 budget = control ? control->frame_budget : 0;
+        const bool rate_controlled = budget > 0 && !video &&
+                                     config_.method != EncoderConfig::Method::RAW &&
+                                     config_.output_mode != EncoderConfig::OutputMode::TILES;
+        const u32 quality = rate_controlled ? control->quality : config_.jpeg_quality;
+
+        if (config_.method == EncoderConfig::Method::RAW)
+        {
+            // Lossless: one framed message whatever the output mode
+            if (!raw_encoder_)
+            {
+                raw_encoder_ = std::make_unique<RawEncoder>();
+            }
+            encoded_size = raw_encoder_->encode(
+                encode_input,
+                encode_width, encode_height,
+                encode_pitch, encode_channels,
+                output);
+        }
+        else if (video)
+        {
+            // One access unit per frame whatever the output mode; IDR only on request
+            if (!h264_encoder_)
+            {
+                h264_encoder_ = std::make_unique<H264Encoder>();
+            }
+            encoded_size = h264_encoder_->encode(
+                encode_input,
+                encode_width, encode_height,
+                encode_pitch, encode_channels,
+                config_,
+                keyframe_requested_.exchange(false, std::memory_order_relaxed),
+                output);
+
+            if (encoded_size > 0 && h264_encoder_->last_keyframe())
+            {
+                stats_.keyframes++;
+            }
+        }
+        else if (config_.output_mode == EncoderConfig::OutputMode::TILES)
+        {
+            // Changed tiles only; the grid is per eye for SBS output
+            encoded_size = encode_tiles(
+                encode_input,
+                encode_width, encode_height,
+                encode_pitch, encode_channels,
+                stereo ? 2 : 1,
+                output);
+        }
+        else if (fused)
+        {
+            // Each strip samples one MCU row into a cache-sized buffer and compresses it at once
+            const RowSource source = [sampler, input](u32 first_row, u32 rows, u8 *dst, u32 dst_pitch)
+            { sampler->sample_rows(input, first_row, rows, dst, dst_pitch); };
+
+            if (single_view)
+            {
+                const size_t view_size = fused->encode_rows(source, encode_width, encode_height, quality, view_frame_);
+                encoded_size = frame_single_view(view_size, output_width / 2, disparity, encode_height, output);
+            }
+            else
+            {
+                encoded_size = fused->encode_rows(source, encode_width, encode_height, quality, output);
+            }
+        }
+        else if (single_view && stereo)
+        {
+            // Framed so the client knows where the right eye starts
+            const size_t view_size = frame_encoder()->encode(
+                encode_input, encode_width, encode_height, encode_pitch, 3, quality, view_frame_);
+            encoded_size = frame_single_view(view_size, output_width / 2, disparity, encode_height, output);
+        }
+        else if (config_.output_mode == EncoderConfig::OutputMode::DUAL_EYE && stereo)
+        {
+            // Per-eye mode: two JPEGs in one framed message
+            encoded_size = encode_dual_eye(encode_input, encode_width, encode_height, encode_pitch, quality, output);
+        }
+        else
+        {
+            IJPEGEncoder *encoder = config_.roi_enabled ? roi_encoder(stereo ? 2 : 1) : frame_encoder();
+            encoded_size = encoder->encode(
+                encode_input,
+                encode_width, encode_height,
+                encode_pitch, encode_channels,
+                quality,
+                output);
+        }
+
+        if (config_.output_mode != EncoderConfig::OutputMode::TILES || config_.method == EncoderConfig::Method::RAW || video)
+        {
+            // Full frames in between invalidate the tile reference
+            tile_width_ = 0;
+        }
+
+        if (!video && h264_encoder_)
+        {
+            // The client drops its decoder on other frames; restart the stream with an IDR
+            h264_encoder_.reset();
+        }
 
         stats_.encode_time_ms = encode_timer.elapsed_ms();
         stats_.total_time_ms = total_timer.elapsed_ms();
+
+        output.width = encode_width;
+        output.height = encode_height;
+        output.encode_time_ms = static_cast<f32>(stats_.total_time_ms);
         stats_.frames_encoded++;
         stats_.bytes_encoded += encoded_size;
+        stats_.quality = quality;
+        stats_.frame_budget_bytes = rate_controlled ? budget : 0;
+        stats_.last_frame_bytes = encoded_size;
+        stats_.downscale_factor = stereo ? downscale : 1.0f;
+
+        if (parallel_encoder_)
+        {
+            const auto huffman = parallel_encoder_->huffman_stats();
+            stats_.huffman_table_age_ms = huffman.table_age_ms;
+            stats_.huffman_gain_percent = huffman.gain_percent;
+        }
 
-        // Calculate compression ratio
-        size_t raw_size = encode_width * encode_height * encode_channels;
-        stats_.compression_ratio = static_cast<f64>(raw_size) / encoded_size;
+        // Calculate compression ratio (an unchanged TILES frame sends nothing)
+        if (encoded_size > 0)
+        {
+            size_t raw_size = encode_width * encode_height * encode_channels;
+            stats_.compression_ratio = static_cast<f64>(raw_size) / encoded_size;
+        }
 
         return encoded_size;
     }
 
+    IJPEGEncoder *VRFrameEncoder::frame_encoder()
+    {
+        if (config_.full_chroma)
+        {
+            // The nvJPEG, strip and built-in encoders are set up for 4:2:0
+            if (!chroma_encoder_)
+            {
+                chroma_encoder_ = std::make_unique<TurboJPEGEncoder>(true);
+            }
+            return chroma_encoder_.get();
+        }
+
+        // Learned Huffman tables need the libjpeg path, even single-threaded
+        if ((config_.jpeg_threads == 1 && config_.huffman_interval_ms == 0) ||
+            jpeg_encoder_->gpu() || jpeg_encoder_->builtin())
+        {
+            return jpeg_encoder_.get();
+        }
+
+        return &strip_encoder();
+    }
+
+    ParallelJPEGEncoder *VRFrameEncoder::fused_encoder()
+    {
+        // Only the libjpeg strip encoder takes rows; 4:4:4 and the GPU/built-in encoders need a frame
+        if (!config_.fused_encode || config_.full_chroma || jpeg_encoder_->gpu() || jpeg_encoder_->builtin())
+        {
+            return nullptr;
+        }
+        return &strip_encoder();
+    }
+
+    ParallelJPEGEncoder &VRFrameEncoder::strip_encoder()
+    {
+        if (!parallel_encoder_ || parallel_threads_ != config_.jpeg_threads)
+        {
+            parallel_encoder_ = std::make_unique<ParallelJPEGEncoder>(config_.jpeg_threads);
+            parallel_threads_ = config_.jpeg_threads;
+        }
+        parallel_encoder_->set_adaptive_huffman(config_.huffman_interval_ms);
+        return *parallel_encoder_;
+    }
+
+    IJPEGEncoder *VRFrameEncoder::roi_encoder(u32 regions)
+    {
+        // Per-block quantisation needs coefficient-level access, which only the built-in encoder has
+        if (!roi_encoder_)
+        {
+            roi_encoder_ = std::make_unique<SimdJPEGEncoder>();
+        }
+        roi_encoder_->set_roi(regions, config_.roi_inner_radius, config_.roi_outer_radius, config_.roi_max_step);
+        return roi_encoder_.get();
+    }
+
+    size_t VRFrameEncoder::frame_single_view(
+        size_t view_size,
+        u32 eye_width, u32 disparity,
+        u32 height,
+        CompressedFrame &output)
+    {
+        if (view_size == 0)
+        {
+            output.clear();
+            return 0;
+        }
+
+        const std::array<u32, 1> part_sizes = {static_cast<u32>(view_size)};
+        const size_t prefix_size = frame_prefix_size(part_sizes.size()) + VIEW_INFO_SIZE;
+        output.reserve(prefix_size + view_size);
+
+        u8 *out = output.ptr();
+        const size_t header_size = write_frame_prefix(out, FrameType::SINGLE_VIEW, eye_width * 2, height,
+                                                      output.frame_id, part_sizes);
+        write_view_info(out + header_size, disparity, eye_width);
+        std::memcpy(out + prefix_size, view_frame_.ptr(), view_size);
+
+        output.length = prefix_size + view_size;
+        return output.length;
+    }
+
+    size_t VRFrameEncoder::encode_dual_eye(
+        const u8 *stereo,
+        u32 width, u32 height,
+        u32 pitch,
+        u32 quality,
+        CompressedFrame &output)
+    {
+        // Settings are shared by both eyes; all mutable state lives in each eye's context
+        const SharedJPEGEncoder eye_encoder(config_.full_chroma);
+        if (!eye_contexts_ready_)
+        {
+            for (auto &context : eye_contexts_)
+            {
+                context = eye_encoder.make_context();
+            }
+            eye_contexts_ready_ = true;
+        }
+        for (auto &context : eye_contexts_)
+        {
+            context.reset();
+        }
+
+        const u32 eye_width = width / 2;
+
+        // One eye on a pool worker, the other here; both read the shared SBS buffer
+        std::array<std::span<const u8>, 2> jpegs;
+        auto encode_eye = [&](size_t eye)
+        {
+            jpegs[eye] = eye_encoder.encode_scratch(eye_contexts_[eye], stereo + eye * eye_width * 3,
+                                                    eye_width, height, pitch, 3, quality);
+        };
+        get_global_thread_pool().run_with_helpers(1, 2, encode_eye);
+
+        const std::span<const u8> left_jpeg = jpegs[0];
+        const std::span<const u8> right_jpeg = jpegs[1];
+        const size_t left_size = left_jpeg.size();
+        const size_t right_size = right_jpeg.size();
+
+        if (left_size == 0 || right_size == 0)
+        {
+            output.clear();
+            return 0;
+        }
+
+        const std::array<u32, 2> part_sizes = {static_cast<u32>(left_size), static_cast<u32>(right_size)};
+        const size_t prefix_size = frame_prefix_size(part_sizes.size());
+        output.reserve(prefix_size + left_size + right_size);
+
+        u8 *out = output.ptr();
+        write_frame_prefix(out, FrameType::DUAL_JPEG, width, height, output.frame_id, part_sizes);
+        std::memcpy(out + prefix_size, left_jpeg.data(), left_size);
+        std::memcpy(out + prefix_size + left_size, right_jpeg.data(), right_size);
+
+        output.length = prefix_size + left_size + right_size;
+        return output.length;
+    }
+
+    size_t VRFrameEncoder::encode_tiles(
+        const u8 *frame,
+        u32 width, u32 height,
+        u32 pitch, u32 channels,
+        u32 regions,
+        CompressedFrame &output)
+    {
+        if (!tile_encoder_)
+        {
+            tile_encoder_ = std::make_unique<TurboJPEGEncoder>();
+        }
+
+        // Multiples of the 4:2:0 MCU keep tile edges free of chroma bleed
+        const u32 tile = std::max(16u, (config_.tile_size / 16) * 16);
+        const u32 region_width = width / regions;
+        const size_t row_bytes = static_cast<size_t>(width) * channels;
+        const u32 tiles_x = (region_width + tile - 1) / tile;
+        const u32 tiles_y = (height + tile - 1) / tile;
+        const u32 tiles_total = tiles_x * tiles_y * regions;
+
+        bool keyframe = keyframe_requested_.exchange(false, std::memory_order_relaxed);
+
+        if (width != tile_width_ || height != tile_height_ || channels != tile_channels_ || tile != tile_edge_)
+        {
+            previous_frame_.resize(row_bytes * height);
+            tile_width_ = width;
+            tile_height_ = height;
+            tile_channels_ = channels;
+            tile_edge_ = tile;
+            keyframe = true;
+        }
+
+        if (config_.tile_keyframe_interval > 0 && frames_since_keyframe_ >= config_.tile_keyframe_interval)
+        {
+            keyframe = true;
+        }
+
+        tile_rects_.clear();
+        tile_sizes_.clear();
+        tile_payload_.clear();
+
+        if (!keyframe)
+        {
+            // Row-wise compare against the last sent frame; stops at the first differing row
+            for (u32 y = 0; y < height; y += tile)
+            {
+                const u32 th = std::min(tile, height - y);
+                for (u32 region = 0; region < regions; ++region)
+                {
+                    for (u32 rx = 0; rx < region_width; rx += tile)
+                    {
+                        const u32 x = region * region_width + rx;
+                        const u32 tw = std::min(tile, region_width - rx);
+                        const size_t offset = static_cast<size_t>(x) * channels;
+                        const size_t span = static_cast<size_t>(tw) * channels;
+
+                        for (u32 row = y; row < y + th; ++row)
+                        {
+                            const u8 *current = frame + static_cast<size_t>(row) * pitch + offset;
+                            const u8 *previous = previous_frame_.data() + row * row_bytes + offset;
+                            if (std::memcmp(current, previous, span) != 0)
+                            {
+                                tile_rects_.push_back({static_cast<u16>(x), static_cast<u16>(y),
+                                                       static_cast<u16>(tw), static_cast<u16>(th)});
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (tile_rects_.empty())
+            {
+                stats_.tiles_changed = 0;
+                stats_.tiles_total = tiles_total;
+                frames_since_keyframe_++;
+                output.clear();
+                return 0;
+            }
+
+            // Mostly-changed frames (scrolling, scene cuts) are cheaper as one JPEG
+            if (tile_rects_.size() * 4 > static_cast<size_t>(tiles_total) * 3)
+            {
+                tile_rects_.clear();
+                keyframe = true;
+            }
+        }
+
+        if (keyframe)
+        {
+            if (frame_encoder()->encode(frame, width, height, pitch, channels,
+                                        config_.jpeg_quality, tile_scratch_) == 0)
+            {
+                tile_width_ = 0;
+                output.clear();
+                return 0;
+            }
+
+            tile_rects_.push_back({0, 0, static_cast<u16>(width), static_cast<u16>(height)});
+            tile_sizes_.push_back(static_cast<u32>(tile_scratch_.size()));
+            tile_payload_.insert(tile_payload_.end(), tile_scratch_.ptr(), tile_scratch_.ptr() + tile_scratch_.size());
+
+            for (u32 row = 0; row < height; ++row)
+            {
+                std::memcpy(previous_frame_.data() + row * row_bytes, frame + static_cast<size_t>(row) * pitch, row_bytes);
+            }
+        }
+        else
+        {
+            for (const TileRect &rect : tile_rects_)
+            {
+                const size_t offset = static_cast<size_t>(rect.y) * pitch + static_cast<size_t>(rect.x) * channels;
+                if (tile_encoder_->encode(frame + offset, rect.w, rect.h, pitch, channels,
+                                          config_.jpeg_quality, tile_scratch_) == 0)
+                {
+                    // Reference is now partly updated; resync with a keyframe
+                    tile_width_ = 0;
+                    output.clear();
+                    return 0;
+                }
+
+                tile_sizes_.push_back(static_cast<u32>(tile_scratch_.size()));
+                tile_payload_.insert(tile_payload_.end(), tile_scratch_.ptr(), tile_scratch_.ptr() + tile_scratch_.size());
+
+                const size_t span = static_cast<size_t>(rect.w) * channels;
+                const size_t reference_offset = static_cast<size_t>(rect.x) * channels;
+                for (u32 row = rect.y; row < static_cast<u32>(rect.y + rect.h); ++row)
+                {
+                    std::memcpy(previous_frame_.data() + row * row_bytes + reference_offset,
+                                frame + static_cast<size_t>(row) * pitch + reference_offset, span);
+                }
+            }
+        }
+
+        // Prefix, rect table, then the tile JPEGs back to back
+        const size_t prefix_size = frame_prefix_size(tile_sizes_.size());
+        const size_t header_size = prefix_size + tile_rects_.size() * TILE_RECT_SIZE;
+        output.reserve(header_size + tile_payload_.size());
+
+        u8 *out = output.ptr();
+        write_frame_prefix(out, FrameType::TILES, width, height, output.frame_id, tile_sizes_,
+                           keyframe ? FRAME_FLAG_KEYFRAME : 0);
+        write_tile_rects(out + prefix_size, tile_rects_);
+        std::memcpy(out + header_size, tile_payload_.data(), tile_payload_.size());
+
+        output.length = header_size + tile_payload_.size();
+        output.delta = !keyframe;
+
+        stats_.tiles_changed = keyframe ? tiles_total : static_cast<u32>(tile_rects_.size());
+        stats_.tiles_total = tiles_total;
+        if (keyframe)
+        {
+            stats_.keyframes++;
+            frames_since_keyframe_ = 0;
+        }
+        else
+        {
+            frames_since_keyframe_++;
+        }
+
+        return output.length;
+    }
+
     void VRFrameEncoder::update_config(const EncoderConfig &config)
     {
+        if (config == config_)
+        {
+            return;
+        }
+
+        const bool method_changed = (config.method != config_.method);
+        const bool builtin_changed = (config.method == EncoderConfig::Method::JPEG) !=
+                                     (config_.method == EncoderConfig::Method::JPEG);
+
         config_ = config;
+        if (builtin_changed)
+        {
+            // Built-in vs TurboJPEG is picked when the encoder is made; the cached ones follow it
+            jpeg_encoder_ = std::make_unique<AutoJPEGEncoder>(config_.method == EncoderConfig::Method::JPEG);
+            parallel_encoder_.reset();
+            chroma_encoder_.reset();
+        }
+        if (method_changed)
+        {
+            warn_if_h264_unavailable();
+        }
+    }
+
+    void VRFrameEncoder::warn_if_h264_unavailable() const
+    {
+        if (config_.method == EncoderConfig::Method::H264 && !H264Encoder::available())
+        {
+            VRS_LOG_WARN("H.264 not available (built without x264), sending JPEG instead");
+        }
     }
 
 } // namespace vrs
@@ -5,6 +5,7 @@
 
 #include "vr_streamer.hpp"
 #include <iostream>
+#include <iomanip>
 #include <csignal>
 #include <cstdio>
 #include <conio.h>
@@ -51,15 +52,49 @@ Usage: vr_streamer [options]
 
 Options:
   -h, --help          Show this help message
+  --config <file>     Configuration file (default: config.yaml); encoder
+                      settings and FPS edited in it apply whenever it is
+                      saved, other options keep their values
   -p, --port <port>   WebSocket port (default: 8765)
   -q, --quality <q>   JPEG quality 1-100 (default: 65)
   -f, --fps <fps>     Target FPS (default: 60)
   -s, --scale <s>     Downscale factor 0.1-1.0 (default: 0.65)
   -m, --monitor <n>   Monitor index (default: 0)
+  --capture-cores <list>, --encode-cores <list>,
+  --network-cores <list>, --background-cores <list>
+                      CPUs for each thread role, e.g. 2 or 4-7,12
+                      (default: any)
+  --avoid-smt         One logical CPU per core for capture/encode threads
+  --realtime          Real-time priority for capture/encode threads
+  --no-huge-pages     Back capture buffers with 4 KB pages
+  --lock-frames       Pin capture buffers in RAM
+  --roi               Centre-weighted quantisation: coarser AC steps away from
+                      each lens centre (built-in encoder, SBS/mono)
+  --roi-step <n>      AC quantiser multiple at the edge (2-8, default: 4)
+  --dynamic-resolution
+                      Scale below --scale (down to 0.25) while encoding
+                      cannot keep up with --fps
+  --refine            Resend a screen that stopped changing once, at high
+                      quality with full chroma (JPEG SBS/dual-eye)
+  -j, --jpeg-threads <n>
+                      Parallel JPEG threads (0 = auto, 1 = off)
+  --huffman-interval <ms>
+                      Learn Huffman tables every <ms> (0 = off, default: 1000)
+  --encoder <name>    Encoder: turbojpeg (default), builtin (JPEG), raw or h264
+                      (lossless, for wired/localhost links)
+  --encode-workers <n>
+                      Frame-parallel encode workers (0 = auto, default: 1)
+  --frame-budget <KB|auto>
+                      Adjust JPEG quality per frame to hit a frame size;
+                      auto follows client throughput (default: off)
   --hwnd <handle>     Capture specific window by handle
   --preset <name>     Quality preset: ultra_performance, low_latency,
                       balanced, quality, maximum_quality
   --no-vr             Disable VR stereo mode
+  --output <mode>     Frame layout: sbs (one JPEG), dual_eye (per-eye JPEGs),
+                      tiles (changed tiles only) or single_view (one view
+                      plus disparity, about half the pixels of sbs)
+  --tile-size <px>    Tile edge for --output tiles (default: 128)
   --no-gpu            Disable GPU acceleration
 
 Controls (during streaming):
@@ -81,8 +116,26 @@ int main(int argc, char *argv[])
     
     print_banner();
 
-    // Parse command line arguments
+    // Config file first, so command line options override it
+    std::string config_path = "config.yaml";
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::string_view(argv[i]) == "--config")
+        {
+            config_path = argv[i + 1];
+        }
+    }
     Config config = Config::default_config();
+    try
+    {
+        config = Config::load(config_path);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Ignoring " << config_path << ": " << e.what() << std::endl;
+    }
+
+    // Parse command line arguments
     bool show_help = false;
     HWND target_hwnd = nullptr; // Window handle for window capture
 
@@ -94,6 +147,10 @@ int main(int argc, char *argv[])
         {
             show_help = true;
         }
+        else if (arg == "--config" && i + 1 < argc)
+        {
+            ++i; // Loaded above
+        }
         else if ((arg == "-p" || arg == "--port") && i + 1 < argc)
         {
             config.network.port = static_cast<u16>(std::stoi(argv[++i]));
@@ -110,10 +167,92 @@ int main(int argc, char *argv[])
         {
             config.encoder.downscale_factor = std::clamp(std::stof(argv[++i]), 0.1f, 1.0f);
         }
+        else if (arg == "--roi")
+        {
+            config.encoder.roi_enabled = true;
+        }
+        else if (arg == "--roi-step" && i + 1 < argc)
+        {
+            config.encoder.roi_enabled = true;
+            config.encoder.roi_max_step = static_cast<u32>(std::clamp(std::stoi(argv[++i]), 1, 8));
+        }
+        else if (arg == "--dynamic-resolution")
+        {
+            config.encoder.dynamic_resolution = true;
+        }
+        else if (arg == "--refine")
+        {
+            config.encoder.refine_enabled = true;
+        }
         else if ((arg == "-m" || arg == "--monitor") && i + 1 < argc)
         {
             config.capture.monitor_index = std::stoi(argv[++i]);
         }
+        else if (arg == "--capture-cores" && i + 1 < argc)
+        {
+            config.threads.capture_cores = argv[++i];
+        }
+        else if (arg == "--encode-cores" && i + 1 < argc)
+        {
+            config.threads.encode_cores = argv[++i];
+        }
+        else if (arg == "--network-cores" && i + 1 < argc)
+        {
+            config.threads.network_cores = argv[++i];
+        }
+        else if (arg == "--background-cores" && i + 1 < argc)
+        {
+            config.threads.background_cores = argv[++i];
+        }
+        else if (arg == "--avoid-smt")
+        {
+            config.threads.avoid_smt = true;
+        }
+        else if (arg == "--realtime")
+        {
+            config.threads.realtime = true;
+        }
+        else if (arg == "--no-huge-pages")
+        {
+            config.capture.huge_pages = false;
+        }
+        else if (arg == "--lock-frames")
+        {
+            config.capture.lock_frames = true;
+        }
+        else if ((arg == "-j" || arg == "--jpeg-threads") && i + 1 < argc)
+        {
+            config.encoder.jpeg_threads = static_cast<u32>(std::clamp(std::stoi(argv[++i]), 0, 64));
+        }
+        else if (arg == "--encode-workers" && i + 1 < argc)
+        {
+            config.encoder.encode_workers = static_cast<u32>(std::clamp(std::stoi(argv[++i]), 0, 16));
+        }
+        else if (arg == "--frame-budget" && i + 1 < argc)
+        {
+            std::string budget = argv[++i];
+            config.encoder.frame_budget_auto = (budget == "auto");
+            if (!config.encoder.frame_budget_auto)
+            {
+                config.encoder.frame_budget_bytes = static_cast<u32>(std::max(0, std::stoi(budget))) * 1024;
+            }
+        }
+        else if (arg == "--huffman-interval" && i + 1 < argc)
+        {
+            config.encoder.huffman_interval_ms = static_cast<u32>(std::max(0, std::stoi(argv[++i])));
+        }
+        else if (arg == "--encoder" && i + 1 < argc)
+        {
+            std::string name = argv[++i];
+            if (name == "builtin")
+                config.encoder.method = EncoderConfig::Method::JPEG;
+            else if (name == "turbojpeg")
+                config.encoder.method = EncoderConfig::Method::TURBOJPEG;
+            else if (name == "raw")
+                config.encoder.method = EncoderConfig::Method::RAW;
+            else if (name == "h264")
+                config.encoder.method = EncoderConfig::Method::H264;
+        }
         else if (arg == "--hwnd" && i + 1 < argc)
         {
             // Parse window handle as unsigned integer
@@ -133,6 +272,22 @@ int main(int argc, char *argv[])
             else if (preset == "maximum_quality")
                 config.apply_preset(QualityPreset::MAXIMUM_QUALITY);
         }
+        else if (arg == "--output" && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            if (mode == "sbs")
+                config.encoder.output_mode = EncoderConfig::OutputMode::SBS;
+            else if (mode == "dual_eye")
+                config.encoder.output_mode = EncoderConfig::OutputMode::DUAL_EYE;
+            else if (mode == "tiles")
+                config.encoder.output_mode = EncoderConfig::OutputMode::TILES;
+            else if (mode == "single_view")
+                config.encoder.output_mode = EncoderConfig::OutputMode::SINGLE_VIEW;
+        }
+        else if (arg == "--tile-size" && i + 1 < argc)
+        {
+            config.encoder.tile_size = static_cast<u32>(std::clamp(std::stoi(argv[++i]), 16, 512));
+        }
         else if (arg == "--no-vr")
         {
             config.encoder.vr_enabled = false;
@@ -218,6 +373,9 @@ int main(int argc, char *argv[])
     app.set_on_client_disconnect([](const ClientInfo &client)
                                  { std::cout << "\n[-] Client disconnected: " << client.address << std::endl; });
 
+    // Saved edits to the config file apply while streaming
+    app.watch_config(config_path);
+
     // Start streaming
     if (!app.start())
     {
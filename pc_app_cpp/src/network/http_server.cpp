@@ -3,6 +3,7 @@
  */
 
 #include "network/http_server.hpp"
+#include "core/thread_placement.hpp"
 #include <fstream>
 
 namespace vrs
@@ -64,6 +65,7 @@ namespace vrs
 
             io_thread_ = std::thread([this]
                                      {
+            ThreadPlacement::apply(ThreadRole::NETWORK, "http-io");
             while (running_.load()) {
                 try {
                     io_context_.run();
@@ -111,7 +113,9 @@ namespace vrs
                 {
                     // Handle request in a detached thread to avoid blocking
                     std::thread([this, s = std::move(socket)]() mutable
-                                { handle_request(std::move(s)); })
+                                {
+                        ThreadPlacement::apply(ThreadRole::NETWORK, "http-request", false);
+                        handle_request(std::move(s)); })
                         .detach();
                 }
 
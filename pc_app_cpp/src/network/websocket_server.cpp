@@ -4,6 +4,7 @@
  */
 
 #include "network/websocket_server.hpp"
+#include "core/thread_placement.hpp"
 #include <boost/asio/strand.hpp>
 
 #ifdef _WIN32
@@ -106,27 +107,51 @@ namespace vrs
         }
 
         // Handle message (ping/pong are handled automatically by Beast)
-        // Could parse JSON messages here for quality requests, etc.
+        const std::string_view message(static_cast<const char *>(read_buffer_.data().data()), bytes);
+        if (message.find("\"keyframe_request\"") != std::string_view::npos)
+        {
+            // The client's video decoder restarted and needs an IDR
+            server_.request_keyframe();
+        }
 
         // Clear buffer and continue reading
         read_buffer_.consume(bytes);
         do_read();
     }
 
-    void WebSocketSession::send_frame(std::shared_ptr<std::vector<u8>> data)
+    void WebSocketSession::send_frame(CompressedFramePtr frame)
     {
         if (closing_.load() || !is_open())
         {
             return;
         }
 
+        // A patch is useless without the frames before it
+        if (frame->delta && awaiting_keyframe_)
+        {
+            return;
+        }
+
+        const bool delta = frame->delta;
+
         // Try to queue the frame
-        if (!write_queue_.try_push(std::move(data)))
+        if (!write_queue_.try_push(std::move(frame)))
         {
-            // Queue full - drop frame
+            // Queue full - drop frame; later patches would apply to a stale canvas
+            server_.add_frame_dropped();
+            if (delta && !awaiting_keyframe_)
+            {
+                awaiting_keyframe_ = true;
+                server_.request_keyframe();
+            }
             return;
         }
 
+        if (!delta)
+        {
+            awaiting_keyframe_ = false;
+        }
+
         // If not currently writing, start writing
         bool expected = false;
         if (writing_.compare_exchange_strong(expected, true))
@@ -151,7 +176,7 @@ namespace vrs
         }
 
         ws_.async_write(
-            asio::buffer(*current_write_),
+            asio::buffer(current_write_->ptr(), current_write_->size()),
             beast::bind_front_handler(&WebSocketSession::on_write, shared_from_this()));
     }
 
@@ -229,7 +254,7 @@ namespace vrs
         : config_(config), io_context_(static_cast<int>(std::thread::hardware_concurrency())), acceptor_(io_context_)
     {
 
-        stats_.start_time = Clock::now();
+        start_time_ = Clock::now();
         server_ip_ = get_local_ip();
     }
 
@@ -275,8 +300,10 @@ namespace vrs
 
             for (size_t i = 0; i < num_threads; ++i)
             {
-                io_threads_.emplace_back([this]
-                                         { run_io_context(); });
+                io_threads_.emplace_back([this, i]
+                                         {
+                    ThreadPlacement::apply(ThreadRole::NETWORK, std::format("ws-io-{}", i));
+                    run_io_context(); });
             }
 
             VRS_LOG_INFO(std::format("WebSocket server started on ws://{}:{}",
@@ -385,20 +412,30 @@ namespace vrs
 
     void StreamingServer::push_frame(const u8 *data, size_t size)
     {
-        // Create shared buffer
-        auto buffer = std::make_shared<std::vector<u8>>(data, data + size);
-        push_frame(std::move(buffer));
+        // Pooled buffer, grown only by the largest frame so far
+        auto frame = copy_pool_.acquire();
+        if (!frame)
+        {
+            // Sessions hold every copy: drop rather than allocate more
+            add_frame_dropped();
+            return;
+        }
+        frame->reserve(size);
+        std::memcpy(frame->ptr(), data, size);
+        frame->length = size;
+        push_frame(std::move(frame));
     }
 
-    void StreamingServer::push_frame(std::shared_ptr<std::vector<u8>> data)
+    void StreamingServer::push_frame(CompressedFramePtr frame)
     {
         fps_counter_.tick();
+        current_fps_.store(fps_counter_.fps(), std::memory_order_relaxed);
 
         // Broadcast to all clients
         std::shared_lock lock(sessions_mutex_);
         for (auto &[id, session] : sessions_)
         {
-            session->send_frame(data);
+            session->send_frame(frame);
         }
     }
 
@@ -406,22 +443,21 @@ namespace vrs
     {
         std::unique_lock lock(sessions_mutex_);
         sessions_[session->info().id] = std::move(session);
-
-        std::lock_guard stats_lock(stats_mutex_);
-        stats_.connected_clients = static_cast<u32>(sessions_.size());
+        connected_clients_.store(static_cast<u32>(sessions_.size()), std::memory_order_relaxed);
     }
 
     void StreamingServer::unregister_session(const std::string &id)
     {
         std::unique_lock lock(sessions_mutex_);
         sessions_.erase(id);
-
-        std::lock_guard stats_lock(stats_mutex_);
-        stats_.connected_clients = static_cast<u32>(sessions_.size());
+        connected_clients_.store(static_cast<u32>(sessions_.size()), std::memory_order_relaxed);
     }
 
     void StreamingServer::on_client_connected(const ClientInfo &info)
     {
+        // New clients need a full frame before any patches
+        request_keyframe();
+
         if (on_connect_)
         {
             on_connect_(info);
@@ -436,23 +472,24 @@ namespace vrs
         }
     }
 
-    void StreamingServer::add_bytes_sent(u64 bytes)
+    void StreamingServer::request_keyframe()
     {
-        std::lock_guard lock(stats_mutex_);
-        stats_.total_bytes_sent += bytes;
-    }
-
-    void StreamingServer::add_frame_sent()
-    {
-        std::lock_guard lock(stats_mutex_);
-        stats_.total_frames_sent++;
-        stats_.current_fps = fps_counter_.fps();
+        if (on_keyframe_request_)
+        {
+            on_keyframe_request_();
+        }
     }
 
     ServerStats StreamingServer::stats() const
     {
-        std::lock_guard lock(stats_mutex_);
-        return stats_;
+        ServerStats stats;
+        stats.total_frames_sent = frames_sent_.load();
+        stats.total_bytes_sent = bytes_sent_.load();
+        stats.total_frames_dropped = frames_dropped_.load();
+        stats.connected_clients = connected_clients_.load(std::memory_order_relaxed);
+        stats.current_fps = current_fps_.load(std::memory_order_relaxed);
+        stats.start_time = start_time_;
+        return stats;
     }
 
     u32 StreamingServer::client_count() const
@@ -0,0 +1,130 @@
+/**
+ * VR Streamer - Allocation Test
+ * Streams synthetic 1080p BGRA captures through the encode worker pool in
+ * each output mode and fails if any heap allocation happens once warm.
+ * Built with VRS_COUNT_ALLOCATIONS whatever ENABLE_ALLOC_COUNTER says.
+ */
+
+#include "bench.hpp"
+#include "core/allocation_counter.hpp"
+#include "encoder/encode_workers.hpp"
+#include <iostream>
+
+using namespace vrs;
+
+namespace
+{
+    constexpr u32 WIDTH = 1920;
+    constexpr u32 HEIGHT = 1080;
+    constexpr u32 PITCH = WIDTH * 4;
+    constexpr u32 WARMUP = 100;
+    constexpr u32 FRAMES = 1000;
+    constexpr auto DRAIN_TIMEOUT = std::chrono::seconds(10);
+
+    struct Case
+    {
+        const char *label;
+        EncoderConfig::OutputMode mode;
+        EncoderConfig::Method method;
+    };
+
+    /**
+     * Allocations while FRAMES frames stream after WARMUP, or UINT64_MAX if
+     * the pool stopped delivering.
+     */
+    u64 count_allocations(const EncoderConfig &config, std::vector<u8> &source)
+    {
+        const size_t frame_size = source.size();
+        const u32 workers = EncodeWorkerPool::worker_count_for(config);
+        FrameBufferPool frames(frame_size, workers * 2 + 2);
+        CompressedFramePool compressed(1024 * 1024, workers * 2 + 2);
+        std::atomic<u64> delivered{0};
+
+        EncodeWorkerPool pool(config, compressed, [&](CompressedFramePtr)
+                              { delivered.fetch_add(1, std::memory_order_relaxed); });
+
+        // Every frame is encoded: wait for a buffer and a worker rather than drop
+        auto drain = [&](u64 frames_out)
+        {
+            const auto deadline = Clock::now() + DRAIN_TIMEOUT;
+            while (delivered.load() + pool.frames_superseded() < frames_out)
+            {
+                if (Clock::now() > deadline)
+                    return false;
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            return true;
+        };
+
+        u64 start = 0;
+        for (u32 i = 0; i < WARMUP + FRAMES; ++i)
+        {
+            if (i == WARMUP)
+            {
+                if (!drain(WARMUP))
+                    return UINT64_MAX;
+                start = allocation_count();
+            }
+
+            // Move a block every frame so TILES always has a change to send
+            for (u32 y = 0; y < 64; ++y)
+            {
+                const size_t row = static_cast<size_t>((i * 37) % (HEIGHT - 64) + y) * PITCH;
+                std::memset(source.data() + row + (i * 53) % (WIDTH - 64) * 4, static_cast<int>(i), 64 * 4);
+            }
+
+            FrameBufferPool::BufferPtr buffer;
+            while (!(buffer = bench::capture(frames, source, WIDTH, HEIGHT, i)))
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            while (!pool.submit(buffer))
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+
+        if (!drain(WARMUP + FRAMES))
+            return UINT64_MAX;
+        return allocation_count() - start;
+    }
+} // namespace
+
+int main()
+{
+    static_assert(allocation_counting(), "build with VRS_COUNT_ALLOCATIONS");
+
+    const EncoderConfig base;
+    const Case cases[] = {{"SBS        ", EncoderConfig::OutputMode::SBS, base.method},
+                          {"Dual eye   ", EncoderConfig::OutputMode::DUAL_EYE, base.method},
+                          {"Single view", EncoderConfig::OutputMode::SINGLE_VIEW, base.method},
+                          {"Tiles      ", EncoderConfig::OutputMode::TILES, base.method},
+                          {"RAW        ", EncoderConfig::OutputMode::SBS, EncoderConfig::Method::RAW}};
+
+    std::vector<u8> source = bench::gradient_frame(WIDTH, HEIGHT, 4);
+
+    std::cout << "Heap allocations (" << WIDTH << "x" << HEIGHT << " BGRA, " << FRAMES << " frames after "
+              << WARMUP << " warm-up)\n";
+
+    bool passed = true;
+    for (const auto &c : cases)
+    {
+        EncoderConfig config = base;
+        config.output_mode = c.mode;
+        config.method = c.method;
+
+        const u64 allocations = count_allocations(config, source);
+        if (allocations == UINT64_MAX)
+        {
+            std::cout << "  " << c.label << ": FAILED, frames stopped coming out\n";
+            passed = false;
+        }
+        else
+        {
+            std::cout << "  " << c.label << ": " << allocations << (allocations > 0 ? "  FAILED" : "") << "\n";
+            passed = passed && allocations == 0;
+        }
+    }
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+/**
+ * VR Streamer - Method Switch Test
+ * Switches one encoder between TurboJPEG and the built-in JPEG encoder with
+ * update_config() and fails unless every frame matches what a fresh encoder
+ * for the new method sends.
+ */
+
+#include "bench.hpp"
+#include "encoder/stereo_processor.hpp"
+#include <iostream>
+
+using namespace vrs;
+
+namespace
+{
+    constexpr u32 WIDTH = 1280;
+    constexpr u32 HEIGHT = 720;
+
+    std::vector<u8> encode(VRFrameEncoder &encoder, const std::vector<u8> &source)
+    {
+        CompressedFrame output;
+        const size_t size = encoder.encode(source.data(), WIDTH, HEIGHT, WIDTH * 4, 4, output);
+        return std::vector<u8>(output.ptr(), output.ptr() + size);
+    }
+} // namespace
+
+int main()
+{
+    // Annex K tables only, so the same frame always encodes to the same bytes
+    EncoderConfig config;
+    config.huffman_interval_ms = 0;
+
+    const std::vector<u8> source = bench::gradient_frame(WIDTH, HEIGHT, 4);
+    const EncoderConfig::Method methods[] = {EncoderConfig::Method::TURBOJPEG, EncoderConfig::Method::JPEG,
+                                             EncoderConfig::Method::TURBOJPEG};
+
+    config.method = methods[0];
+    VRFrameEncoder switched(config);
+    encode(switched, source);
+
+    bool passed = true;
+    for (const auto method : methods)
+    {
+        config.method = method;
+        switched.update_config(config);
+        VRFrameEncoder fresh(config);
+
+        const std::vector<u8> expected = encode(fresh, source);
+        const std::vector<u8> actual = encode(switched, source);
+        const bool match = !expected.empty() && actual == expected;
+        std::cout << (method == EncoderConfig::Method::JPEG ? "  built-in  : " : "  TurboJPEG : ")
+                  << actual.size() << " bytes, fresh encoder " << expected.size() << " bytes"
+                  << (match ? "" : "  FAILED") << "\n";
+        passed = passed && match;
+    }
+
+    return passed ? 0 : 1;
+}